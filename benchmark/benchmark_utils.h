@@ -0,0 +1,45 @@
+#ifndef gamgee_benchmark_utils__guard
+#define gamgee_benchmark_utils__guard
+
+#include <chrono>
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <algorithm>
+
+/**
+ * @brief runs a function repeatedly and prints the best time per run and the throughput
+ *
+ * The function is run a few times to warm up caches and then timed over several runs. The minimum
+ * is reported as it is the least affected by noise from the rest of the system.
+ *
+ * @param name the name of the benchmark (printed)
+ * @param items number of items (bases, records, ...) processed by each run (used to compute the throughput)
+ * @param function the code to benchmark
+ * @param runs number of timed runs
+ * @return the best time per run in seconds
+ */
+template <class FUNCTION>
+double run_benchmark(const std::string& name, const double items, FUNCTION&& function, const unsigned runs = 10) {
+  for (auto i = 0u; i != 2; ++i)
+    function();
+  auto best = std::chrono::duration<double>::max();
+  for (auto i = 0u; i != runs; ++i) {
+    const auto start = std::chrono::steady_clock::now();
+    function();
+    best = std::min<std::chrono::duration<double>>(best, std::chrono::steady_clock::now() - start);
+  }
+  std::cout << std::left << std::setw(50) << name << std::right << std::setw(12) << std::fixed << std::setprecision(3)
+            << best.count() * 1e3 << " ms" << std::setw(12) << std::setprecision(1) << items / best.count() / 1e6 << " M/s" << std::endl;
+  return best.count();
+}
+
+/**
+ * @brief prevents the compiler from optimizing away a result that is otherwise unused
+ */
+template <class T>
+inline void do_not_optimize(const T& value) {
+  asm volatile("" : : "g"(&value) : "memory");
+}
+
+#endif // gamgee_benchmark_utils__guard
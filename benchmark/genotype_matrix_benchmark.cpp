@@ -0,0 +1,71 @@
+#include "benchmark_utils.h"
+
+#include "variant/variant_reader.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace std;
+using namespace gamgee;
+
+const auto N_RECORDS = 2000u;
+const auto N_SAMPLES = 1000u;
+
+/**
+ * @brief writes a diploid VCF of random biallelic genotypes, a few of them missing
+ */
+void write_vcf(const string& filename) {
+  auto generator = mt19937{42};
+  auto genotype = discrete_distribution<uint32_t>{80, 12, 6, 2};
+  const auto genotypes = vector<string>{"0/0", "0/1", "1/1", "./."};
+  auto file = ofstream{filename};
+  file << "##fileformat=VCFv4.1\n"
+       << "##contig=<ID=1,length=" << N_RECORDS * 10 << ">\n"
+       << "##FORMAT=<ID=GT,Number=1,Type=String,Description=\"Genotype\">\n"
+       << "#CHROM\tPOS\tID\tREF\tALT\tQUAL\tFILTER\tINFO\tFORMAT";
+  for (auto sample = 0u; sample != N_SAMPLES; ++sample)
+    file << "\tSAMPLE" << sample;
+  file << "\n";
+  for (auto record = 0u; record != N_RECORDS; ++record) {
+    file << "1\t" << (record + 1) * 10 << "\t.\tA\tG\t50\t.\t.\tGT";
+    for (auto sample = 0u; sample != N_SAMPLES; ++sample)
+      file << "\t" << genotypes[genotype(generator)];
+    file << "\n";
+  }
+}
+
+int main() {
+  const auto filename = string{"/tmp/gamgee_genotype_matrix_benchmark.vcf"};
+  write_vcf(filename);
+  auto records = vector<Variant>{};
+  for (const auto& record : SingleVariantReader{filename})
+    records.push_back(record);
+  const auto genotypes = double(N_RECORDS) * N_SAMPLES;
+
+  run_benchmark("alt allele count (Genotype objects)", genotypes, [&]{
+    auto alt_alleles = 0u;
+    for (const auto& record : records) {
+      for (const auto& genotype : record.genotypes()) {
+        for (const auto allele : genotype.allele_keys())
+          alt_alleles += allele > 0;
+      }
+    }
+    do_not_optimize(alt_alleles);
+  }, 3);
+
+  auto matrix = vector<int8_t>(N_RECORDS * N_SAMPLES * 2);
+  run_benchmark("alt allele count (genotype matrix)", genotypes, [&]{
+    Variant::decode_genotypes(records, 2, matrix.data());
+    auto alt_alleles = 0u;
+    for (const auto allele : matrix)
+      alt_alleles += allele > 0;
+    do_not_optimize(alt_alleles);
+  }, 3);
+
+  remove(filename.c_str());
+  return 0;
+}
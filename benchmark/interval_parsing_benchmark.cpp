@@ -0,0 +1,85 @@
+#include "benchmark_utils.h"
+
+#include "interval.h"
+
+#include <boost/lexical_cast.hpp>
+#include <boost/tokenizer.hpp>
+
+#include <string>
+#include <vector>
+#include <sstream>
+#include <fstream>
+#include <cstdio>
+#include <random>
+
+using namespace std;
+using namespace gamgee;
+
+const auto N_RECORDS = 1000000u;
+
+/**
+ * @brief the tokenizer based parser that read_intervals used before (for comparison)
+ */
+vector<Interval> tokenizer_read_intervals(istream& input) {
+  const auto separators = boost::char_separator<char>{" \t:-"};
+  auto result = vector<Interval>{};
+  auto line = string{};
+  while (input.peek() == '@')
+    getline(input, line);
+  while (getline(input, line)) {
+    auto tokens = boost::tokenizer<boost::char_separator<char>>{line, separators};
+    auto it = tokens.begin();
+    const auto chr = *it;
+    auto start = 0u;
+    auto stop = -1;
+    if (++it != tokens.end())
+      start = boost::lexical_cast<uint32_t>(*it);
+    if (++it != tokens.end())
+      stop = boost::lexical_cast<int32_t>(*it);
+    result.emplace_back(chr, start, stop == -1 ? start : static_cast<uint32_t>(stop));
+  }
+  return result;
+}
+
+string random_intervals_file(const Interval::IntervalType type) {
+  auto generator = mt19937{42};
+  auto pick_length = uniform_int_distribution<uint32_t>{1, 500};
+  auto out = ostringstream{};
+  if (type == Interval::IntervalType::PICARD)
+    out << "@HD\tVN:1.0\tSO:coordinate\n@SQ\tSN:chr1\tLN:249250621\n";
+  auto start = 1u;
+  for (auto i = 0u; i != N_RECORDS; ++i) {
+    const auto chr = "chr" + to_string(1 + i * 22 / N_RECORDS);
+    const auto stop = start + pick_length(generator);
+    switch (type) {
+      case Interval::IntervalType::GATK:
+        out << chr << ":" << start << "-" << stop << "\n";
+        break;
+      case Interval::IntervalType::PICARD:
+        out << chr << "\t" << start << "\t" << stop << "\t+\ttarget_" << i << "\n";
+        break;
+      case Interval::IntervalType::BED:
+        out << chr << "\t" << start << "\t" << stop << "\n";
+        break;
+    }
+    start = stop + 100;
+  }
+  return out.str();
+}
+
+int main() {
+  const auto filename = string{"interval_parsing_benchmark.tmp"};
+  const auto types = vector<pair<string, Interval::IntervalType>>{{"gatk", Interval::IntervalType::GATK}, {"picard", Interval::IntervalType::PICARD}, {"bed", Interval::IntervalType::BED}};
+  for (const auto& type : types) {
+    ofstream{filename} << random_intervals_file(type.second);
+    run_benchmark("read_intervals " + type.first + " (tokenizer)", N_RECORDS, [&] {
+      auto input = ifstream{filename};
+      do_not_optimize(tokenizer_read_intervals(input));
+    }, 3);
+    run_benchmark("read_intervals " + type.first, N_RECORDS, [&] {
+      do_not_optimize(read_intervals(filename));
+    }, 3);
+  }
+  remove(filename.c_str());
+  return 0;
+}
@@ -0,0 +1,101 @@
+#include "benchmark_utils.h"
+
+#include "utils/loser_tree.h"
+
+#include <memory>
+#include <queue>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace std;
+using namespace gamgee::utils;
+
+const auto TOTAL_RECORDS = 4u * 1024u * 1024u;
+
+/**
+ * @brief stands for an input file: sorted (chromosome << 32 | start) keys and a cursor
+ *
+ * Inputs of a joint calling cohort mostly share positions: each input has a record at a position of
+ * the cohort with probability density.
+ */
+struct Input {
+  const vector<uint64_t>* keys;
+  size_t next;
+  uint64_t key() const { return (*keys)[next]; }
+  bool advance() { return ++next != keys->size(); }
+};
+
+vector<vector<uint64_t>> make_inputs(const uint32_t n_inputs) {
+  auto generator = mt19937{42};
+  auto coin = uniform_real_distribution<double>{0, 1};
+  const auto density = 0.5;
+  const auto n_positions = static_cast<uint32_t>(TOTAL_RECORDS / n_inputs / density);
+  auto result = vector<vector<uint64_t>>(n_inputs);
+  for (auto position = 0u; position != n_positions; ++position) {
+    const auto key = (uint64_t{position / 1000000} << 32) | (position % 1000000 + 1);
+    for (auto& input : result) {
+      if (coin(generator) < density)
+        input.push_back(key);
+    }
+  }
+  return result;
+}
+
+// the previous merge: a binary heap of pointers to the inputs, which are dereferenced by every comparison
+uint64_t heap_merge(const vector<vector<uint64_t>>& keys) {
+  using InputIndexPair = pair<shared_ptr<Input>, uint32_t>;
+  const auto later = [](const InputIndexPair& left, const InputIndexPair& right) { return left.first->key() > right.first->key(); };
+  auto queue = priority_queue<InputIndexPair, vector<InputIndexPair>, decltype(later)>{later};
+  for (auto i = 0u; i != keys.size(); ++i) {
+    if (!keys[i].empty())
+      queue.push(InputIndexPair{make_shared<Input>(Input{&keys[i], 0}), i});
+  }
+  auto checksum = uint64_t{0};
+  while (!queue.empty()) {
+    const auto position = queue.top().first->key();
+    while (!queue.empty() && queue.top().first->key() == position) {
+      auto top = queue.top();
+      queue.pop();
+      checksum += top.second;
+      if (top.first->advance())
+        queue.push(move(top));
+    }
+  }
+  return checksum;
+}
+
+// the loser tree merge of MultipleVariantIterator: cached keys, batched pop of a position
+uint64_t tree_merge(const vector<vector<uint64_t>>& keys) {
+  auto inputs = vector<Input>{};
+  auto first_keys = vector<uint64_t>{};
+  for (const auto& input_keys : keys) {
+    inputs.push_back(Input{&input_keys, 0});
+    first_keys.push_back(input_keys.empty() ? LoserTree::EXHAUSTED : input_keys[0]);
+  }
+  auto tree = LoserTree{move(first_keys)};
+  auto checksum = uint64_t{0};
+  while (!tree.empty()) {
+    const auto position = tree.winner_key();
+    while (tree.winner_key() == position) {
+      const auto winner = tree.winner();
+      auto& input = inputs[winner];
+      checksum += winner;
+      tree.replace_winner(input.advance() ? input.key() : LoserTree::EXHAUSTED);
+    }
+  }
+  return checksum;
+}
+
+int main() {
+  for (const auto n_inputs : {10u, 100u, 1000u, 10000u}) {
+    const auto inputs = make_inputs(n_inputs);
+    auto records = 0.0;
+    for (const auto& input : inputs)
+      records += input.size();
+    const auto suffix = " (" + to_string(n_inputs) + " inputs)";
+    run_benchmark("priority_queue merge" + suffix, records, [&]{ do_not_optimize(heap_merge(inputs)); }, 3);
+    run_benchmark("LoserTree merge" + suffix, records, [&]{ do_not_optimize(tree_merge(inputs)); }, 3);
+  }
+  return 0;
+}
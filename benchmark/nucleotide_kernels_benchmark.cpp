@@ -0,0 +1,62 @@
+#include "benchmark_utils.h"
+
+#include "utils/nucleotide_kernels.h"
+#include "utils/utils.h"
+
+#include <string>
+#include <vector>
+#include <random>
+
+using namespace std;
+using namespace gamgee::utils;
+
+const auto SEQUENCE_SIZE = 64u * 1024u * 1024u;
+
+string random_sequence(const size_t size) {
+  auto generator = mt19937{42};
+  const auto bases = string{"ACGTacgtN"};
+  auto pick_base = uniform_int_distribution<size_t>{0, bases.size() - 1};
+  auto result = string(size, 'A');
+  for (auto& base : result)
+    base = bases[pick_base(generator)];
+  return result;
+}
+
+string level_name(const NucleotideKernelLevel level) {
+  switch (level) {
+    case NucleotideKernelLevel::AVX2:
+      return "avx2";
+    case NucleotideKernelLevel::SSE4:
+      return "sse4";
+    default:
+      return "scalar";
+  }
+}
+
+int main() {
+  const auto sequence = random_sequence(SEQUENCE_SIZE);
+  auto out = string(SEQUENCE_SIZE, ' ');
+  auto packed = vector<uint8_t>(SEQUENCE_SIZE / 2);
+  auto work = sequence;
+
+  // baseline: the string-returning utils::reverse_complement running on the scalar kernel, which the per-level results below compare against
+  set_nucleotide_kernel_level(NucleotideKernelLevel::SCALAR);
+  run_benchmark("utils::reverse_complement (string, scalar)", SEQUENCE_SIZE, [&]{ do_not_optimize(reverse_complement(sequence)); });
+
+  for (const auto level : {NucleotideKernelLevel::SCALAR, NucleotideKernelLevel::SSE4, NucleotideKernelLevel::AVX2}) {
+    if (!nucleotide_kernel_level_supported(level))
+      continue;
+    set_nucleotide_kernel_level(level);
+    const auto suffix = " (" + level_name(level) + ")";
+    run_benchmark("complement_bases" + suffix, SEQUENCE_SIZE, [&]{ complement_bases(sequence.data(), &out[0], SEQUENCE_SIZE); do_not_optimize(out); });
+    run_benchmark("reverse_complement_bases" + suffix, SEQUENCE_SIZE, [&]{ reverse_complement_bases(sequence.data(), &out[0], SEQUENCE_SIZE); do_not_optimize(out); });
+    run_benchmark("reverse_complement_bases in place" + suffix, SEQUENCE_SIZE, [&]{ reverse_complement_bases(&work[0], SEQUENCE_SIZE); do_not_optimize(work); });
+    run_benchmark("pack_bases_4bit" + suffix, SEQUENCE_SIZE, [&]{ pack_bases_4bit(sequence.data(), SEQUENCE_SIZE, packed.data()); do_not_optimize(packed); });
+    run_benchmark("unpack_bases_4bit" + suffix, SEQUENCE_SIZE, [&]{ unpack_bases_4bit(packed.data(), SEQUENCE_SIZE, &out[0]); do_not_optimize(out); });
+    run_benchmark("pack_bases_2bit" + suffix, SEQUENCE_SIZE, [&]{ pack_bases_2bit(sequence.data(), SEQUENCE_SIZE, packed.data()); do_not_optimize(packed); });
+    run_benchmark("unpack_bases_2bit" + suffix, SEQUENCE_SIZE, [&]{ unpack_bases_2bit(packed.data(), SEQUENCE_SIZE, &out[0]); do_not_optimize(out); });
+    run_benchmark("to_upper_bases" + suffix, SEQUENCE_SIZE, [&]{ work = sequence; to_upper_bases(&work[0], SEQUENCE_SIZE); do_not_optimize(work); });
+    run_benchmark("count_n_bases" + suffix, SEQUENCE_SIZE, [&]{ do_not_optimize(count_n_bases(sequence.data(), SEQUENCE_SIZE)); });
+  }
+  return 0;
+}
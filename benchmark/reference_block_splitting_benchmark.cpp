@@ -0,0 +1,75 @@
+#include "benchmark_utils.h"
+
+#include "variant/multiple_variant_reader.h"
+#include "variant/reference_block_splitting_variant_iterator.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+
+using namespace std;
+using namespace gamgee;
+
+const auto CHROMOSOME_LENGTH = 200000u;
+const auto MAX_BLOCK_LENGTH = 100u;
+const auto VARIANT_FRACTION = 0.05;
+
+/**
+ * @brief writes a single sample gVCF covering the chromosome with reference blocks of random lengths and a few SNPs
+ *
+ * Blocks of different samples end at different positions, so the merge splits most blocks several times.
+ */
+void write_gvcf(const string& filename, const uint32_t sample, mt19937& generator) {
+  auto block_length = uniform_int_distribution<uint32_t>{1, MAX_BLOCK_LENGTH};
+  auto coin = uniform_real_distribution<double>{0, 1};
+  auto file = ofstream{filename};
+  file << "##fileformat=VCFv4.1\n"
+       << "##contig=<ID=1,length=" << CHROMOSOME_LENGTH << ">\n"
+       << "##ALT=<ID=NON_REF,Description=\"Represents any possible alternative allele at this location\">\n"
+       << "##INFO=<ID=END,Number=1,Type=Integer,Description=\"Stop position of the interval\">\n"
+       << "##FORMAT=<ID=GT,Number=1,Type=String,Description=\"Genotype\">\n"
+       << "##FORMAT=<ID=DP,Number=1,Type=Integer,Description=\"Read depth\">\n"
+       << "##FORMAT=<ID=GQ,Number=1,Type=Integer,Description=\"Genotype quality\">\n"
+       << "#CHROM\tPOS\tID\tREF\tALT\tQUAL\tFILTER\tINFO\tFORMAT\tSAMPLE" << sample << "\n";
+  for (auto start = 1u; start <= CHROMOSOME_LENGTH; ) {
+    if (coin(generator) < VARIANT_FRACTION) {
+      file << "1\t" << start << "\t.\tA\tG,<NON_REF>\t50\t.\t.\tGT:DP:GQ\t0/1:30:50\n";
+      ++start;
+      continue;
+    }
+    const auto stop = min(CHROMOSOME_LENGTH, start + block_length(generator) - 1);
+    file << "1\t" << start << "\t.\tA\t<NON_REF>\t.\t.\tEND=" << stop << "\tGT:DP:GQ\t0/0:30:99\n";
+    start = stop + 1;
+  }
+}
+
+int main() {
+  auto directory_template = string{"/tmp/gamgee_benchmark_XXXXXX"};
+  if (mkdtemp(&directory_template[0]) == nullptr)
+    return 1;
+  auto generator = mt19937{42};
+  for (const auto n_inputs : {10u, 100u}) {
+    auto filenames = vector<string>{};
+    for (auto i = 0u; i != n_inputs; ++i) {
+      filenames.push_back(directory_template + "/sample" + to_string(i) + ".vcf");
+      write_gvcf(filenames.back(), i, generator);
+    }
+    auto records = 0.0;
+    for (const auto& vec : MultipleVariantReader<ReferenceBlockSplittingVariantIterator>{filenames, false})
+      records += vec.size();
+    const auto suffix = " (" + to_string(n_inputs) + " inputs)";
+    run_benchmark("reference block splitting" + suffix, records, [&]{
+      for (const auto& vec : MultipleVariantReader<ReferenceBlockSplittingVariantIterator>{filenames, false})
+        do_not_optimize(vec.size());
+    }, 3);
+    for (const auto& filename : filenames)
+      remove(filename.c_str());
+  }
+  rmdir(directory_template.c_str());
+  return 0;
+}
@@ -0,0 +1,63 @@
+#include "contig_interval.h"
+#include "exceptions.h"
+
+using namespace std;
+
+namespace gamgee {
+
+ContigDictionary::ContigDictionary(const std::vector<std::string>& contigs) :
+  m_names {},
+  m_ids {}
+{
+  for (const auto& contig : contigs)
+    add(contig);
+}
+
+ContigDictionary::ContigDictionary(const SamHeader& header) :
+  m_names {},
+  m_ids {}
+{
+  for (auto i = 0u; i != header.n_sequences(); ++i)
+    add(header.sequence_name(i));
+}
+
+ContigDictionary::ContigDictionary(const VariantHeader& header) :
+  ContigDictionary {header.chromosomes()}
+{}
+
+uint32_t ContigDictionary::id(const std::string& name) const {
+  const auto contig = m_ids.find(name);
+  if (contig == m_ids.end())
+    throw ChromosomeNotFoundException{name};
+  return contig->second;
+}
+
+vector<ContigInterval> ContigDictionary::to_contig_intervals(const std::vector<Interval>& intervals) const {
+  auto result = vector<ContigInterval>{};
+  result.reserve(intervals.size());
+  auto previous_chr = string{};
+  auto previous_id = 0u;
+  for (const auto& interval : intervals) {
+    if (result.empty() || interval.chr() != previous_chr) {  // interval lists come in runs of the same contig: skip the hash lookup
+      previous_chr = interval.chr();
+      previous_id = id(previous_chr);
+    }
+    result.push_back(ContigInterval{previous_id, interval.start(), interval.stop()});
+  }
+  return result;
+}
+
+vector<Interval> ContigDictionary::to_intervals(const std::vector<ContigInterval>& intervals, const Interval::IntervalType output_type) const {
+  auto result = vector<Interval>{};
+  result.reserve(intervals.size());
+  for (const auto& interval : intervals)
+    result.emplace_back(m_names[interval.contig], interval.start, interval.stop, output_type);
+  return result;
+}
+
+void ContigDictionary::add(const std::string& name) {
+  if (m_ids.emplace(name, m_names.size()).second)
+    m_names.push_back(name);
+}
+
+}  // end of namespace
@@ -0,0 +1,116 @@
+#ifndef gamgee__contig_interval__guard
+#define gamgee__contig_interval__guard
+
+#include "interval.h"
+#include "sam/sam_header.h"
+#include "variant/variant_header.h"
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <cstdint>
+
+namespace gamgee {
+
+/**
+ * @brief Compact genomic interval: a contig id (into a ContigDictionary), a start and a stop.
+ *
+ * At 12 bytes with no heap allocation, a vector of ContigIntervals is a single contiguous block and
+ * comparisons are integer comparisons, unlike Interval which carries its contig name as a string.
+ * Coordinates follow Interval: 1-based, start and stop inclusive.
+ *
+ * Convert to and from Interval with a ContigDictionary:
+ *
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ * const auto dictionary = ContigDictionary{SingleSamReader{"reads.bam"}.header()};
+ * const auto targets = dictionary.to_contig_intervals(read_intervals("targets.interval_list"));
+ * for (const auto& record : IndexedSingleSamReader{"reads.bam", targets, dictionary})
+ *   ...
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ */
+struct ContigInterval {
+  uint32_t contig;  ///< id of the contig in its ContigDictionary
+  uint32_t start;   ///< first genomic location (inclusive)
+  uint32_t stop;    ///< last genomic location (inclusive)
+
+  uint32_t size() const { return stop - start + 1; } ///< @brief number of loci in the interval
+
+  bool operator==(const ContigInterval& rhs) const { return contig == rhs.contig && start == rhs.start && stop == rhs.stop; }
+  bool operator!=(const ContigInterval& rhs) const { return !(*this == rhs); }
+
+  /**
+   * @brief orders by contig id (i.e. dictionary order), then start, then stop
+   */
+  bool operator<(const ContigInterval& rhs) const {
+    if (contig != rhs.contig) return contig < rhs.contig;
+    if (start != rhs.start) return start < rhs.start;
+    return stop < rhs.stop;
+  }
+};
+
+static_assert(sizeof(ContigInterval) == 12, "ContigInterval is meant to be three packed 32 bit integers");
+
+/**
+ * @brief Ordered list of contig names assigning the ids used by ContigInterval.
+ *
+ * Usually built from the sequence dictionary of a SamHeader or the contigs of a VariantHeader, in which
+ * case ids follow the header order. Names appearing more than once keep their first id.
+ */
+class ContigDictionary {
+ public:
+  ContigDictionary() = default;                                   ///< @brief an empty dictionary
+  explicit ContigDictionary(const std::vector<std::string>& contigs); ///< @brief a dictionary with the given contigs, numbered in order
+  explicit ContigDictionary(const SamHeader& header);             ///< @brief the sequence dictionary (\@SQ lines) of a SAM/BAM/CRAM header
+  explicit ContigDictionary(const VariantHeader& header);         ///< @brief the contigs declared in a VCF/BCF header
+
+  ContigDictionary(const ContigDictionary&) = default;
+  ContigDictionary(ContigDictionary&&) = default;
+  ContigDictionary& operator=(const ContigDictionary&) = default;
+  ContigDictionary& operator=(ContigDictionary&&) = default;
+
+  uint32_t size() const { return m_names.size(); }                              ///< @brief number of contigs
+  bool empty() const { return m_names.empty(); }                                ///< @brief whether there are no contigs
+  const std::vector<std::string>& names() const { return m_names; }             ///< @brief all contig names, indexed by id
+  const std::string& name(const uint32_t id) const { return m_names[id]; }      ///< @brief the name of the contig with this id
+  bool contains(const std::string& name) const { return m_ids.find(name) != m_ids.end(); } ///< @brief whether the contig is in the dictionary
+
+  /**
+   * @brief the id of a contig
+   * @exception ChromosomeNotFoundException if the contig is not in the dictionary
+   */
+  uint32_t id(const std::string& name) const;
+
+  /**
+   * @brief converts an Interval to the compact representation
+   * @exception ChromosomeNotFoundException if the contig of the interval is not in the dictionary
+   */
+  ContigInterval to_contig_interval(const Interval& interval) const { return ContigInterval{id(interval.chr()), interval.start(), interval.stop()}; }
+
+  /**
+   * @brief converts a compact interval back to an Interval
+   */
+  Interval to_interval(const ContigInterval& interval, const Interval::IntervalType output_type = Interval::IntervalType::GATK) const {
+    return Interval{m_names[interval.contig], interval.start, interval.stop, output_type};
+  }
+
+  /**
+   * @brief converts a list of Intervals, keeping their order
+   * @exception ChromosomeNotFoundException if the contig of any interval is not in the dictionary
+   */
+  std::vector<ContigInterval> to_contig_intervals(const std::vector<Interval>& intervals) const;
+
+  /**
+   * @brief converts a list of compact intervals back to Intervals, keeping their order
+   */
+  std::vector<Interval> to_intervals(const std::vector<ContigInterval>& intervals, const Interval::IntervalType output_type = Interval::IntervalType::GATK) const;
+
+ private:
+  std::vector<std::string> m_names;                  ///< contig names, indexed by id
+  std::unordered_map<std::string, uint32_t> m_ids;   ///< contig name -> id
+
+  void add(const std::string& name);
+};
+
+}  // end of namespace
+
+#endif /* gamgee__contig_interval__guard */
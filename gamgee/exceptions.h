@@ -17,6 +17,24 @@ class FileOpenException : public std::runtime_error {
     std::runtime_error{std::string{"Could not open file "} + filename} {}
 };
 
+/**
+ * @brief Exception for the case where a file cannot be read past its current position (e.g. it is truncated)
+ */
+class FileReadException : public std::runtime_error {
+ public:
+  FileReadException(const std::string& filename) :
+    std::runtime_error{std::string{"Could not read from file "} + filename} {}
+};
+
+/**
+ * @brief Exception for the case where writing to a file fails (e.g. the disk is full)
+ */
+class FileWriteException : public std::runtime_error {
+ public:
+  FileWriteException(const std::string& filename) :
+    std::runtime_error{std::string{"Could not write to file "} + filename} {}
+};
+
 /**
  * @brief Exception for the case where an index file cannot be opened for a particular file (eg., bam/vcf/bcf)
  */
@@ -80,6 +98,24 @@ class ChromosomeSizeException : public std::runtime_error {
     std::runtime_error{(boost::format("Error: chromosome %s is of size %d but location %d was requested") % chrom_name % chrom_size % desired_location).str()} { }
 };
 
+/**
+ * @brief an exception class for the case where the position of a file can't be reported or changed
+ */
+class FileSeekException : public std::runtime_error {
+ public:
+  FileSeekException(const std::string& reason) :
+    std::runtime_error{(boost::format("Error: cannot reposition the file: %s") % reason).str()} { }
+};
+
+/**
+ * @brief an exception class for the case where a filter or field is not declared in a variant header
+ */
+class HeaderFieldNotFoundException : public std::runtime_error {
+ public:
+  HeaderFieldNotFoundException(const std::string& field_name) :
+    std::runtime_error{(boost::format("Error: field %s is not declared in the header") % field_name).str()} { }
+};
+
 } // end of namespace gamgee
 
 #endif // end of gamgee__exceptions__guard
@@ -1,5 +1,5 @@
 #include "fastq.h"
-#include "utils/utils.h"
+#include "utils/nucleotide_kernels.h"
 
 #include <iostream>
 
@@ -18,7 +18,7 @@ void Fastq::chop(const int nBases) {
 }
 
 void Fastq::reverse_complement() {
-  m_sequence = utils::reverse_complement(m_sequence);
+  utils::reverse_complement_bases(&m_sequence[0], m_sequence.size());
 }
 
 }  // end of namespace
@@ -75,6 +75,7 @@ class Fastq {
   std::string m_sequence; ///< sequence bases
   std::string m_quals;    ///< optional quality scores
 
+  friend class FastqWriter; ///< allows the writer to format the fields without copying them
 };
 
 }  // end of namespace
@@ -0,0 +1,122 @@
+#include "fastq_writer.h"
+
+#include "exceptions.h"
+#include "utils/file_utils.h"
+#include "utils/hts_memory.h"
+
+#include "htslib/bgzf.h"
+
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <stdexcept>
+
+using namespace std;
+
+namespace gamgee {
+
+constexpr uint32_t FastqWriter::DEFAULT_BUFFER_SIZE;
+
+constexpr auto BGZF_SUB_BLOCKS_PER_THREAD = 256; ///< number of BGZF blocks each compression thread works on at a time
+
+FastqWriter::FastqWriter(const std::string& output_fname, const bool compressed, const uint32_t compression_threads, const uint32_t buffer_size) :
+  m_bgzf_file {compressed ? open_bgzf_file(output_fname, compression_threads) : nullptr},
+  m_text_file {compressed ? nullptr : open_text_file(output_fname)},
+  m_buffer {},
+  m_buffer_size {buffer_size}
+{
+  m_buffer.reserve(m_buffer_size);
+}
+
+FastqWriter::~FastqWriter() {
+  close();
+}
+
+FastqWriter& FastqWriter::operator=(FastqWriter&& other) {
+  if (this != &other) {
+    close();
+    m_bgzf_file = move(other.m_bgzf_file);
+    m_text_file = move(other.m_text_file);
+    m_buffer = move(other.m_buffer);
+    m_buffer_size = other.m_buffer_size;
+  }
+  return *this;
+}
+
+void FastqWriter::add_record(const Fastq& record) {
+  append_record(record);
+  if (m_buffer.size() >= m_buffer_size)
+    flush();
+}
+
+void FastqWriter::add_records(const std::vector<Fastq>& records) {
+  auto batch_size = m_buffer.size();
+  for (const auto& record : records)
+    batch_size += record.m_name.size() + record.m_comment.size() + record.m_sequence.size() + record.m_quals.size() + 7;  // 7 = delimiters and new lines of a fastq record
+  if (batch_size > m_buffer.capacity())
+    m_buffer.reserve(batch_size);
+  for (const auto& record : records)
+    append_record(record);
+  if (m_buffer.size() >= m_buffer_size)
+    flush();
+}
+
+void FastqWriter::flush() {
+  if (!write_buffer())
+    throw runtime_error{"Error: failed to write fastq records to the output"};
+}
+
+void FastqWriter::append_record(const Fastq& record) {
+  const auto fastq = record.is_fastq();
+  m_buffer.push_back(fastq ? '@' : '>');
+  m_buffer.append(record.m_name);
+  m_buffer.push_back(' ');
+  m_buffer.append(record.m_comment);
+  m_buffer.push_back('\n');
+  m_buffer.append(record.m_sequence);
+  if (fastq) {
+    m_buffer.append("\n+\n", 3);
+    m_buffer.append(record.m_quals);
+  }
+  m_buffer.push_back('\n');
+}
+
+bool FastqWriter::write_buffer() {
+  if (m_buffer.empty())
+    return true;
+  auto success = false;
+  if (m_bgzf_file)
+    success = bgzf_write(m_bgzf_file.get(), m_buffer.data(), m_buffer.size()) == static_cast<ssize_t>(m_buffer.size());
+  else if (m_text_file)
+    success = fwrite(m_buffer.data(), 1, m_buffer.size(), m_text_file.get()) == m_buffer.size();
+  m_buffer.clear();
+  return success;
+}
+
+/**
+ * @brief writes out any pending records and closes the output. Errors are ignored here since this is
+ * called from the destructor (use flush() to get errors reported).
+ */
+void FastqWriter::close() {
+  write_buffer();
+  m_bgzf_file.reset();
+  m_text_file.reset();
+}
+
+BGZF* FastqWriter::open_bgzf_file(const std::string& output_fname, const uint32_t compression_threads) {
+  auto file = (output_fname.empty() || output_fname == "-") ? bgzf_dopen(fileno(stdout), "w") : bgzf_open(output_fname.c_str(), "w");
+  if (file == nullptr)
+    throw FileOpenException{output_fname};
+  if (compression_threads > 1)
+    bgzf_mt(file, compression_threads, BGZF_SUB_BLOCKS_PER_THREAD);
+  return file;
+}
+
+std::FILE* FastqWriter::open_text_file(const std::string& output_fname) {
+  auto file = (output_fname.empty() || output_fname == "-") ? stdout : fopen(output_fname.c_str(), "w");
+  if (file == nullptr)
+    throw FileOpenException{output_fname};
+  return file;
+}
+
+}  // end of namespace
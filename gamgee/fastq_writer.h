@@ -0,0 +1,97 @@
+#ifndef gamgee__fastq_writer__guard
+#define gamgee__fastq_writer__guard
+
+#include "fastq.h"
+
+#include "utils/file_utils.h"
+#include "utils/hts_memory.h"
+
+#include "htslib/bgzf.h"
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <cstdio>
+
+namespace gamgee {
+
+/**
+ * @brief utility class to write out many Fastq records to a FastA/FastQ file (plain or compressed)
+ *
+ * Records are formatted directly into a large output buffer (no per-field stream calls) and the
+ * buffer is handed to the output in big chunks. When compression is requested, the output is written
+ * in BGZF format (which is gzip compatible) and the compression can be spread over multiple threads.
+ *
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ * auto writer = FastqWriter{"out.fq.gz", true, 4};
+ * for (const auto& record : FastqReader{filename})
+ *   writer.add_record(record);
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ *
+ * The output format of each record follows the output stream operator of the Fastq class.
+ */
+class FastqWriter {
+ public:
+
+  static constexpr uint32_t DEFAULT_BUFFER_SIZE = 4*1024*1024; ///< @brief default size of the output buffer (in bytes)
+
+  /**
+   * @brief Creates a new FastqWriter using the specified output file name
+   * @param output_fname file to write to. The default is stdout
+   * @param compressed whether the output should be BGZF compressed (true) or plain text (false)
+   * @param compression_threads number of threads used to compress the output (only used if compressed is true)
+   * @param buffer_size the size of the output buffer in bytes. The buffer is flushed to the output whenever it is full.
+   */
+  explicit FastqWriter(const std::string& output_fname = "-", const bool compressed = false, const uint32_t compression_threads = 1, const uint32_t buffer_size = DEFAULT_BUFFER_SIZE);
+
+  /**
+   * @brief flushes all pending records and closes the output
+   */
+  ~FastqWriter();
+
+  /**
+   * @brief a FastqWriter cannot be copied safely, as it is writing to a stream.
+   */
+  FastqWriter(const FastqWriter& other) = delete;
+  FastqWriter& operator=(const FastqWriter& other) = delete;
+
+  /**
+   * @brief a FastqWriter can be moved
+   */
+  FastqWriter(FastqWriter&& other) = default;
+  FastqWriter& operator=(FastqWriter&& other);
+
+  /**
+   * @brief Adds a record to the output buffer
+   * @param record the record
+   */
+  void add_record(const Fastq& record);
+
+  /**
+   * @brief Adds a batch of records to the output buffer
+   * @param records the records (in output order)
+   * @note the buffer is grown only once to fit the entire batch
+   */
+  void add_records(const std::vector<Fastq>& records);
+
+  /**
+   * @brief writes all buffered records to the output
+   */
+  void flush();
+
+ private:
+  std::unique_ptr<BGZF, utils::BgzfDeleter> m_bgzf_file;       ///< the compressed output (nullptr if writing plain text)
+  std::unique_ptr<std::FILE, utils::FileDeleter> m_text_file;  ///< the plain text output (nullptr if writing compressed)
+  std::string m_buffer;                                        ///< formatted records waiting to be written out
+  uint32_t m_buffer_size;                                      ///< flush threshold of the output buffer
+
+  void append_record(const Fastq& record);
+  bool write_buffer();
+  void close();
+  static BGZF* open_bgzf_file(const std::string& output_fname, const uint32_t compression_threads);
+  static std::FILE* open_text_file(const std::string& output_fname);
+};
+
+}  // end of namespace
+
+#endif // gamgee__fastq_writer__guard
@@ -1,12 +1,21 @@
 #ifndef gamgee__gamgee__guard
 #define gamgee__gamgee__guard
 
+#include "contig_interval.h"
 #include "exceptions.h"
 #include "fastq.h"
 #include "fastq_iterator.h"
 #include "fastq_reader.h"
+#include "fastq_writer.h"
+#include "index_partitioner.h"
+#include "indexed_reference_map.h"
 #include "interval.h"
+#include "interval_algebra.h"
+#include "interval_index.h"
+#include "iterator_checkpoint.h"
+#include "kmer_index.h"
 #include "missing.h"
+#include "packed_reference.h"
 #include "reference_iterator.h"
 #include "reference_map.h"
 #include "zip.h"
@@ -14,7 +23,9 @@
 #include "utils/file_utils.h"
 #include "utils/genotype_utils.h"
 #include "utils/hts_memory.h"
+#include "utils/loser_tree.h"
 #include "utils/merged_vcf_lut.h"
+#include "utils/nucleotide_kernels.h"
 #include "utils/short_value_optimized_storage.h"
 #include "utils/utils.h"
 #include "utils/variant_field_type.h"
@@ -36,17 +47,20 @@
 #include "sam/sam_writer.h"
 
 #include "variant/genotype.h"
+#include "variant/hierarchical_variant_merge.h"
 #include "variant/indexed_variant_iterator.h"
 #include "variant/indexed_variant_reader.h"
 #include "variant/individual_field.h"
 #include "variant/individual_field_iterator.h"
 #include "variant/individual_field_value.h"
 #include "variant/individual_field_value_iterator.h"
+#include "variant/merged_variant_stream.h"
 #include "variant/multiple_variant_iterator.h"
 #include "variant/multiple_variant_reader.h"
 #include "variant/reference_block_splitting_variant_iterator.h"
 #include "variant/shared_field.h"
 #include "variant/shared_field_iterator.h"
+#include "variant/site_filtering_variant_iterator.h"
 #include "variant/synced_variant_iterator.h"
 #include "variant/synced_variant_reader.h"
 #include "variant/variant.h"
@@ -55,12 +69,16 @@
 #include "variant/variant_builder_individual_region.h"
 #include "variant/variant_builder_multi_sample_vector.h"
 #include "variant/variant_builder_shared_region.h"
+#include "variant/variant_field_handle.h"
 #include "variant/variant_filters.h"
 #include "variant/variant_filters_iterator.h"
 #include "variant/variant_header.h"
 #include "variant/variant_header_builder.h"
 #include "variant/variant_iterator.h"
+#include "variant/variant_prefetcher.h"
 #include "variant/variant_reader.h"
+#include "variant/variant_site_predicate.h"
+#include "variant/variant_unpack_level.h"
 #include "variant/variant_writer.h"
 #include "variant/variant_header_merger.h"
 
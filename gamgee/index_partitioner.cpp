@@ -0,0 +1,223 @@
+#include "index_partitioner.h"
+#include "exceptions.h"
+#include "sam/sam_header.h"
+#include "variant/variant_header.h"
+#include "utils/hts_memory.h"
+
+#include "htslib/hts.h"
+#include "htslib/sam.h"
+#include "htslib/vcf.h"
+#include "htslib/tbx.h"
+
+#include <algorithm>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+
+using namespace std;
+
+namespace gamgee {
+
+constexpr auto MIN_TILE_SIZE = 1u << 14;          ///< the resolution of the BAI/TBI linear index: finer tiles wouldn't add information
+constexpr auto TILES_PER_PARTITION = 256u;        ///< tiles per shard on average, i.e. how finely shard boundaries can be placed
+constexpr auto BLOCK_ALIGNMENT_WINDOW = 16u;      ///< how many tiles a boundary may move to start at a BGZF block boundary
+constexpr auto MAX_INDEXED_LENGTH = 1u << 29;     ///< largest contig a BAI/TBI index can address, used when a VCF contig has no length
+constexpr auto NO_DATA = numeric_limits<uint64_t>::max();
+
+namespace {
+
+/**
+ * @brief a contig of the header and its id in the index (negative if the index has no data for it)
+ */
+struct IndexedContig {
+  string name;
+  int index_id;
+  uint32_t length;
+};
+
+/**
+ * @brief a piece of a contig and the virtual file offset where its records start
+ */
+struct Tile {
+  uint32_t contig;
+  uint32_t start;
+  uint32_t stop;
+  uint64_t offset;
+};
+
+/**
+ * @brief cuts the contigs into tiles and asks the index where the records of each tile start
+ *
+ * hts_itr_query only consults the bins and the linear index (nothing is read from the file), and the
+ * first chunk it returns is where an iteration over the tile would start reading.
+ */
+vector<Tile> index_tiles(const hts_idx_t* index, const vector<IndexedContig>& contigs, const uint32_t tile_size, uint64_t& end_offset) {
+  auto tiles = vector<Tile>{};
+  end_offset = 0;
+  for (auto contig = 0u; contig != contigs.size(); ++contig) {
+    const auto length = contigs[contig].length;
+    for (auto start = uint64_t{1}; start <= length; start += tile_size) {
+      const auto stop = static_cast<uint32_t>(min<uint64_t>(start + tile_size - 1, length));
+      auto offset = NO_DATA;
+      if (index != nullptr && contigs[contig].index_id >= 0) {
+        const auto iterator = utils::make_unique_hts_itr(hts_itr_query(index, contigs[contig].index_id, static_cast<int>(start - 1), static_cast<int>(stop), nullptr));
+        if (iterator && iterator->n_off > 0) {
+          offset = iterator->off[0].u;
+          for (auto i = 0; i != iterator->n_off; ++i)
+            end_offset = max(end_offset, iterator->off[i].v);
+        }
+      }
+      tiles.push_back(Tile{contig, static_cast<uint32_t>(start), stop, offset});
+    }
+  }
+  // tiles without data start where the next tile with data does, and offsets never go backwards in a sorted file
+  auto next_offset = end_offset;
+  for (auto tile = tiles.rbegin(); tile != tiles.rend(); ++tile) {
+    if (tile->offset == NO_DATA)
+      tile->offset = next_offset;
+    else
+      next_offset = tile->offset;
+  }
+  for (auto i = 1u; i < tiles.size(); ++i)
+    tiles[i].offset = max(tiles[i].offset, tiles[i - 1].offset);
+  return tiles;
+}
+
+/**
+ * @brief among the boundaries close to the ideal one, picks the one where the next shard starts closest to a BGZF block start
+ *
+ * Candidates are at most BLOCK_ALIGNMENT_WINDOW tiles away and change the weight of the shards by at most
+ * tolerance, so that alignment never unbalances the shards noticeably.
+ */
+uint32_t align_boundary(const vector<Tile>& tiles, const vector<uint64_t>& cumulative, const uint32_t boundary, const uint32_t previous_boundary, const uint64_t tolerance) {
+  const auto first = max(previous_boundary + 1, boundary > BLOCK_ALIGNMENT_WINDOW ? boundary - BLOCK_ALIGNMENT_WINDOW : 0u);
+  const auto last = min<uint32_t>(tiles.size() - 1, boundary + BLOCK_ALIGNMENT_WINDOW);
+  const auto distance = [&](const uint32_t candidate) { return candidate > boundary ? candidate - boundary : boundary - candidate; };
+  auto best = boundary;
+  auto best_block_offset = tiles[boundary].offset & 0xffff;  // low 16 bits of a virtual offset: position within the uncompressed block
+  for (auto candidate = first; candidate <= last; ++candidate) {
+    const auto weight_change = cumulative[candidate] > cumulative[boundary] ? cumulative[candidate] - cumulative[boundary] : cumulative[boundary] - cumulative[candidate];
+    if (weight_change > tolerance)
+      continue;
+    const auto block_offset = tiles[candidate].offset & 0xffff;
+    if (block_offset < best_block_offset || (block_offset == best_block_offset && distance(candidate) < distance(best))) {
+      best = candidate;
+      best_block_offset = block_offset;
+    }
+  }
+  return best;
+}
+
+/**
+ * @brief turns a run of tiles into intervals, one per contig
+ */
+vector<Interval> tiles_to_intervals(const vector<Tile>& tiles, const uint32_t first, const uint32_t last, const vector<IndexedContig>& contigs) {
+  auto result = vector<Interval>{};
+  for (auto i = first; i != last; ++i) {
+    if (result.empty() || tiles[i].contig != tiles[i - 1].contig)
+      result.emplace_back(contigs[tiles[i].contig].name, tiles[i].start, tiles[i].stop);
+    else
+      result.back().set_stop(tiles[i].stop);
+  }
+  return result;
+}
+
+vector<vector<Interval>> partition_index(const hts_idx_t* index, const vector<IndexedContig>& contigs, const uint32_t n_partitions, const bool align_to_blocks) {
+  if (n_partitions == 0)
+    throw invalid_argument{"a file cannot be split into 0 partitions"};
+  auto total_length = uint64_t{0};
+  for (const auto& contig : contigs)
+    total_length += contig.length;
+  const auto tile_size = static_cast<uint32_t>(max<uint64_t>(MIN_TILE_SIZE, total_length / (uint64_t{n_partitions} * TILES_PER_PARTITION) + 1));
+  auto end_offset = uint64_t{0};
+  const auto tiles = index_tiles(index, contigs, tile_size, end_offset);
+  if (tiles.empty())
+    return {};
+
+  // cumulative[i] is the weight of the tiles before tile i: compressed bytes, or bases if the index has no data
+  auto cumulative = vector<uint64_t>(tiles.size() + 1, 0);
+  for (auto i = 0u; i != tiles.size(); ++i) {
+    const auto next_offset = i + 1 == tiles.size() ? max(end_offset, tiles[i].offset) : tiles[i + 1].offset;
+    cumulative[i + 1] = cumulative[i] + ((next_offset >> 16) - (tiles[i].offset >> 16));
+  }
+  if (cumulative.back() == 0) {
+    for (auto i = 0u; i != tiles.size(); ++i)
+      cumulative[i + 1] = cumulative[i] + tiles[i].stop - tiles[i].start + 1;
+  }
+
+  // boundary i is where the cumulative weight is closest to i / n_partitions of the total
+  auto boundaries = vector<uint32_t>{0};
+  for (auto partition = 1u; partition < n_partitions; ++partition) {
+    const auto target = cumulative.back() * partition / n_partitions;
+    auto boundary = static_cast<uint32_t>(lower_bound(cumulative.begin(), cumulative.end(), target) - cumulative.begin());
+    if (boundary > 0 && target - cumulative[boundary - 1] < cumulative[boundary] - target)
+      --boundary;
+    boundary = max(boundary, boundaries.back() + 1);
+    if (boundary >= tiles.size())
+      break;
+    if (align_to_blocks)
+      boundary = align_boundary(tiles, cumulative, boundary, boundaries.back(), cumulative.back() / n_partitions / 32);
+    boundaries.push_back(boundary);
+  }
+  boundaries.push_back(tiles.size());
+
+  auto result = vector<vector<Interval>>{};
+  result.reserve(boundaries.size() - 1);
+  for (auto i = 1u; i != boundaries.size(); ++i)
+    result.push_back(tiles_to_intervals(tiles, boundaries[i - 1], boundaries[i], contigs));
+  return result;
+}
+
+}  // end of anonymous namespace
+
+vector<vector<Interval>> partition_sam_file(const std::string& filename, const uint32_t n_partitions, const bool align_to_blocks) {
+  const auto file = utils::make_unique_hts_file(sam_open(filename.c_str(), "r"));
+  if (!file)
+    throw FileOpenException{filename};
+  auto* index_ptr = sam_index_load(file.get(), filename.c_str());
+  if (index_ptr == nullptr)
+    throw IndexLoadException{filename};
+  const auto index = utils::make_shared_hts_index(index_ptr);
+  auto* header_ptr = sam_hdr_read(file.get());
+  if (header_ptr == nullptr)
+    throw HeaderReadException{filename};
+  const auto header = SamHeader{utils::make_shared_sam_header(header_ptr)};
+
+  auto contigs = vector<IndexedContig>{};
+  for (auto i = 0u; i != header.n_sequences(); ++i)
+    contigs.push_back(IndexedContig{header.sequence_name(i), static_cast<int>(i), header.sequence_length(i)});
+  // CRAM indices can't be queried for chunks: CRAM files are split by length
+  return partition_index(file->is_cram ? nullptr : index.get(), contigs, n_partitions, align_to_blocks);
+}
+
+vector<vector<Interval>> partition_variant_file(const std::string& filename, const uint32_t n_partitions, const bool align_to_blocks) {
+  const auto file = utils::make_unique_hts_file(bcf_open(filename.c_str(), "r"));
+  if (!file)
+    throw FileOpenException{filename};
+  auto* header_ptr = bcf_hdr_read(file.get());
+  if (header_ptr == nullptr)
+    throw HeaderReadException{filename};
+  const auto header = VariantHeader{utils::make_shared_variant_header(header_ptr)};
+
+  // BCF and CSI indexed VCF number contigs as the header does, TBI has its own contig names
+  auto index = shared_ptr<hts_idx_t>{};
+  auto tabix = unique_ptr<tbx_t, utils::TabixDeleter>{};
+  auto* index_ptr = bcf_index_load(filename.c_str());
+  if (index_ptr != nullptr)
+    index = utils::make_shared_hts_index(index_ptr);
+  else {
+    tabix.reset(tbx_index_load(filename.c_str()));
+    if (!tabix)
+      throw IndexLoadException{filename};
+  }
+
+  auto contigs = vector<IndexedContig>{};
+  for (const auto& chromosome : header.chromosomes()) {
+    const auto length = header.chromosome_length(chromosome);
+    const auto index_id = tabix ? tbx_name2id(tabix.get(), chromosome.c_str()) : bcf_hdr_name2id(header_ptr, chromosome.c_str());
+    contigs.push_back(IndexedContig{chromosome, index_id, length == 0 ? MAX_INDEXED_LENGTH : length});
+  }
+  return partition_index(tabix ? tabix->idx : index.get(), contigs, n_partitions, align_to_blocks);
+}
+
+}  // end of namespace
@@ -0,0 +1,65 @@
+#ifndef gamgee__index_partitioner__guard
+#define gamgee__index_partitioner__guard
+
+#include "interval.h"
+
+#include <string>
+#include <vector>
+
+namespace gamgee {
+
+/**
+ * @file
+ * @brief Splits indexed files into shards holding about the same amount of data, for parallel whole-file scans.
+ *
+ * Splitting the genome into equal-length intervals gives badly unbalanced shards: centromeres hold no
+ * data and high coverage regions hold a lot. These functions use the file index (BAI/CSI for BAM and
+ * BCF, CSI/TBI for bgzipped VCF) to find the file offset where the records of every small tile of each
+ * contig start, and weigh each tile by the compressed bytes between consecutive tiles. The tiles are
+ * then grouped into consecutive shards of about total / n_partitions bytes each.
+ *
+ * Each shard is a list of intervals in file order (a shard may span several contigs). Together the
+ * shards cover every contig of the header exactly once. Files with no indexed data (and CRAM files, whose
+ * index holds no chunk offsets) are split by length.
+ *
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ * const auto shards = partition_sam_file("reads.bam", n_threads);
+ * // in worker i
+ * auto regions = vector<string>{};
+ * for (const auto& interval : shards[i])
+ *   regions.push_back(interval.str());
+ * for (const auto& record : IndexedSingleSamReader{"reads.bam", regions})
+ *   ...
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ *
+ * @warning indexed readers return every record overlapping an interval, so a record crossing a shard
+ * boundary is seen by both shards. Callers that must process each record once should skip records
+ * starting before the first interval of the contig in their shard. Unmapped reads without a position are
+ * not part of any shard.
+ */
+
+/**
+ * @brief splits an indexed BAM/CRAM file into at most n_partitions shards with balanced data volume
+ *
+ * @param filename the bam/cram file (its index is found the same way IndexedSamReader does)
+ * @param n_partitions the number of shards wanted. Fewer are returned when the file can't be split that finely.
+ * @param align_to_blocks move each shard boundary (by a few tiles at most) to where the next shard starts
+ * closest to the beginning of a BGZF block, so that adjacent shards decompress as little shared data as possible
+ * @exception FileOpenException, HeaderReadException or IndexLoadException if the file can't be read
+ * @exception std::invalid_argument if n_partitions is 0
+ */
+std::vector<std::vector<Interval>> partition_sam_file(const std::string& filename, const uint32_t n_partitions, const bool align_to_blocks = false);
+
+/**
+ * @brief splits an indexed BCF or bgzipped VCF file (CSI or TBI index) into at most n_partitions shards with balanced data volume
+ *
+ * Contigs declared in the header without a length are taken to be as long as a BAI/TBI index can
+ * address (2^29 bases).
+ *
+ * @copydetails partition_sam_file
+ */
+std::vector<std::vector<Interval>> partition_variant_file(const std::string& filename, const uint32_t n_partitions, const bool align_to_blocks = false);
+
+}  // end of namespace
+
+#endif /* gamgee__index_partitioner__guard */
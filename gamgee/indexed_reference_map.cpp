@@ -0,0 +1,145 @@
+#include "indexed_reference_map.h"
+
+#include "exceptions.h"
+#include "interval.h"
+#include "utils/hts_memory.h"
+#include "utils/nucleotide_kernels.h"
+
+#include "htslib/faidx.h"
+
+#include <string>
+#include <vector>
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <cstdlib>
+
+using namespace std;
+
+namespace gamgee {
+
+constexpr uint32_t IndexedReferenceMap::DEFAULT_WINDOW_SIZE;
+constexpr uint32_t IndexedReferenceMap::DEFAULT_MAX_CACHED_WINDOWS;
+
+IndexedReferenceMap::IndexedReferenceMap(const std::string& filename, const uint32_t window_size, const uint32_t max_cached_windows) :
+  m_filename {filename},
+  m_index {load_index(filename)},
+  m_contigs {read_contigs(filename + ".fai")},
+  m_contig_index {},
+  m_window_size {max(window_size, 1u)},
+  m_max_cached_windows {max(max_cached_windows, 1u)},
+  m_windows {},
+  m_window_lookup {}
+{
+  for (auto i = 0u; i != m_contigs.size(); ++i)
+    m_contig_index.emplace(m_contigs[i].name, i);
+}
+
+string IndexedReferenceMap::get_sequence(const Interval& interval, const bool reverse_strand) const {
+  const auto contig = contig_id(interval.chr());
+  const auto length = m_contigs[contig].length;
+  if (interval.start() < 1 || interval.start() > length + 1)
+    throw ChromosomeSizeException{interval.chr(), length, static_cast<int>(interval.start())};
+  const auto stop = min(interval.stop(), length);  // zero-based, exclusive
+  auto result = string{};
+  if (stop >= interval.start())
+    result.reserve(stop - interval.start() + 1);
+  for (auto position = interval.start() - 1; position < stop; ) {
+    const auto window_number = position / m_window_size;
+    const auto& bases = window(contig, window_number);
+    const auto offset = position - window_number * m_window_size;
+    const auto count = min<uint32_t>(bases.size() - offset, stop - position);
+    result.append(bases, offset, count);
+    position += count;
+  }
+  if (reverse_strand)
+    utils::complement_bases(result.data(), &result[0], result.size());
+  return result;
+}
+
+char IndexedReferenceMap::ref_base(const std::string& chromosome, const uint32_t one_based_location) const {
+  const auto contig = contig_id(chromosome);
+  if (one_based_location < 1 || one_based_location > m_contigs[contig].length)
+    throw ChromosomeSizeException{chromosome, m_contigs[contig].length, static_cast<int>(one_based_location)};
+  const auto window_number = (one_based_location - 1) / m_window_size;
+  return window(contig, window_number)[one_based_location - 1 - window_number * m_window_size];
+}
+
+uint32_t IndexedReferenceMap::contig_length(const std::string& chromosome) const {
+  return m_contigs[contig_id(chromosome)].length;
+}
+
+vector<string> IndexedReferenceMap::contigs() const {
+  auto result = vector<string>{};
+  result.reserve(m_contigs.size());
+  for (const auto& contig : m_contigs)
+    result.push_back(contig.name);
+  return result;
+}
+
+uint32_t IndexedReferenceMap::contig_id(const std::string& chromosome) const {
+  const auto it = m_contig_index.find(chromosome);
+  if (it == m_contig_index.end())
+    throw ChromosomeNotFoundException{chromosome};
+  return it->second;
+}
+
+/**
+ * @brief returns a window of the reference from the cache, reading it from disk if necessary
+ * @warning the reference is only valid until the next call (the window may be evicted)
+ */
+const string& IndexedReferenceMap::window(const uint32_t contig, const uint32_t window_number) const {
+  const auto key = (uint64_t{contig} << 32) | window_number;
+  const auto cached = m_window_lookup.find(key);
+  if (cached != m_window_lookup.end()) {
+    m_windows.splice(m_windows.begin(), m_windows, cached->second);  // mark as most recently used
+    return cached->second->bases;
+  }
+  const auto& name = m_contigs[contig].name;
+  const auto start = window_number * m_window_size;
+  const auto stop = min(start + m_window_size, m_contigs[contig].length) - 1;
+  auto length = 0;
+  auto fetched = faidx_fetch_seq(m_index.get(), name.c_str(), start, stop, &length);
+  // the contig is in the index, so a failed or short fetch means the file cannot be read (e.g. it was truncated)
+  if (fetched == nullptr || length != static_cast<int>(stop - start + 1)) {
+    free(fetched);
+    throw FileReadException{m_filename};
+  }
+  m_windows.push_front(CachedWindow{key, string{fetched, static_cast<size_t>(length)}});
+  free(fetched);
+  m_window_lookup[key] = m_windows.begin();
+  if (m_windows.size() > m_max_cached_windows) {
+    m_window_lookup.erase(m_windows.back().key);
+    m_windows.pop_back();
+  }
+  return m_windows.front().bases;
+}
+
+faidx_t* IndexedReferenceMap::load_index(const std::string& filename) {
+  if (!ifstream{filename + ".fai"}.good() && fai_build(filename.c_str()) != 0)
+    throw IndexLoadException{filename};
+  auto index = fai_load(filename.c_str());
+  if (index == nullptr)
+    throw IndexLoadException{filename};
+  return index;
+}
+
+/**
+ * @brief parses the contig table (name and length columns) of a .fai index file
+ */
+vector<IndexedReferenceMap::Contig> IndexedReferenceMap::read_contigs(const std::string& index_filename) {
+  ifstream index_file {index_filename};
+  if (!index_file.good())
+    throw IndexLoadException{index_filename};
+  auto result = vector<Contig>{};
+  auto line = string{};
+  while (getline(index_file, line)) {
+    istringstream fields {line};
+    auto contig = Contig{};
+    if (getline(fields, contig.name, '\t') && fields >> contig.length)
+      result.push_back(move(contig));
+  }
+  return result;
+}
+
+}  // namespace gamgee
@@ -0,0 +1,117 @@
+#ifndef gamgee__indexed_reference_map__guard
+#define gamgee__indexed_reference_map__guard
+
+#include "interval.h"
+
+#include "utils/hts_memory.h"
+
+#include "htslib/faidx.h"
+
+#include <string>
+#include <vector>
+#include <list>
+#include <memory>
+#include <unordered_map>
+
+namespace gamgee {
+
+/**
+ * @brief Utility class to access an indexed (.fai) FastA reference genome at random.
+ *
+ * Unlike the ReferenceMap, which loads the entire reference in memory at construction, this class
+ * only reads the (tiny) .fai index up front. Every request seeks directly to the requested location
+ * in the FastA file. The sequence is read in fixed size windows that are kept in a least recently used
+ * cache, so memory usage depends only on the window size and the number of cached windows, never on
+ * the size of the reference.
+ *
+ * If the .fai index does not exist it is built (and written next to the FastA file) at construction.
+ *
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ * const auto reference = IndexedReferenceMap{"hg38.fa"};
+ * for (const auto& interval : read_intervals(intervals_file))
+ *   do_something(reference.get_sequence(interval));
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ *
+ * @note the window cache is not thread safe. Use one IndexedReferenceMap per thread.
+ */
+class IndexedReferenceMap {
+ public:
+
+  static constexpr uint32_t DEFAULT_WINDOW_SIZE = 64*1024;      ///< @brief default number of bases fetched from disk at a time
+  static constexpr uint32_t DEFAULT_MAX_CACHED_WINDOWS = 64;    ///< @brief default maximum number of windows kept in memory
+
+  /**
+   * @brief opens an indexed FastA reference file (building the .fai index if necessary)
+   *
+   * @param filename reference genome FastA file (plain or bgzipped)
+   * @param window_size number of bases read from disk at a time
+   * @param max_cached_windows maximum number of windows kept in memory (least recently used are dropped first)
+   * @exception throws IndexLoadException if the index cannot be built or loaded
+   */
+  explicit IndexedReferenceMap(const std::string& filename, const uint32_t window_size = DEFAULT_WINDOW_SIZE, const uint32_t max_cached_windows = DEFAULT_MAX_CACHED_WINDOWS);
+
+  IndexedReferenceMap(IndexedReferenceMap&&) = default;
+  IndexedReferenceMap& operator=(IndexedReferenceMap&&) = default;
+  IndexedReferenceMap(const IndexedReferenceMap&) = delete;
+  IndexedReferenceMap& operator=(const IndexedReferenceMap&) = delete;
+
+  /**
+    * @brief locates the DNA sequence for a given Interval
+    *
+    * Intervals extending beyond the end of the contig are truncated at the end of the contig (same
+    * behavior as ReferenceMap::get_sequence).
+    *
+    * @exception throws ChromosomeNotFoundException if the contig is not in the reference
+    * @exception throws ChromosomeSizeException if the interval starts outside of the contig
+    * @exception throws FileReadException if the sequence cannot be read from the file
+    * @return DNA sequence for the requested Interval
+    */
+  std::string get_sequence(const Interval& interval,         ///< location in the genome
+                           const bool reverse_strand = false ///< which strand, releative to the reference genome, to produce the sequence for
+      ) const;
+
+  /**
+   * @brief return the reference base character at the desired location
+   * @param chromosome the chromosome of the desired base
+   * @param one_based_location the one-based genomic location of the base
+   * @exception throws ChromosomeNotFoundException, ChromosomeSizeException or FileReadException as get_sequence()
+   */
+  char ref_base(const std::string& chromosome, const uint32_t one_based_location) const;
+
+  bool has_contig(const std::string& chromosome) const { return m_contig_index.count(chromosome) > 0; } ///< @brief whether the reference has a contig with this name
+  uint32_t contig_length(const std::string& chromosome) const;                                          ///< @brief length of a contig (throws ChromosomeNotFoundException if not in the reference)
+  uint32_t n_contigs() const { return m_contigs.size(); }                                                ///< @brief number of contigs in the reference
+  std::vector<std::string> contigs() const;                                                              ///< @brief names of all contigs in the order of the FastA file
+  uint32_t n_cached_windows() const { return m_windows.size(); }                                         ///< @brief number of windows currently held in memory
+
+ private:
+  /** @brief an entry of the .fai index */
+  struct Contig {
+    std::string name;
+    uint32_t length;
+  };
+
+  /** @brief a window of sequence held in the cache */
+  struct CachedWindow {
+    uint64_t key;
+    std::string bases;
+  };
+
+  std::string m_filename;                                                                  ///< the FastA file (for error messages)
+  std::unique_ptr<faidx_t, utils::FaidxDeleter> m_index;                                   ///< htslib's handle to the indexed FastA
+  std::vector<Contig> m_contigs;                                                           ///< all contigs in the order of the index
+  std::unordered_map<std::string, uint32_t> m_contig_index;                                ///< contig name -> position in m_contigs
+  uint32_t m_window_size;                                                                  ///< number of bases in each cached window
+  uint32_t m_max_cached_windows;                                                           ///< maximum number of windows held in memory
+  mutable std::list<CachedWindow> m_windows;                                               ///< cached windows, most recently used first
+  mutable std::unordered_map<uint64_t, std::list<CachedWindow>::iterator> m_window_lookup; ///< window key -> position in m_windows
+
+  uint32_t contig_id(const std::string& chromosome) const;
+  const std::string& window(const uint32_t contig, const uint32_t window_number) const;
+  static faidx_t* load_index(const std::string& filename);
+  static std::vector<Contig> read_contigs(const std::string& index_filename);
+};
+
+}  // namespace gamgee
+
+#endif /* gamgee__indexed_reference_map__guard */
@@ -1,52 +1,139 @@
 #include "interval.h"
+#include "utils/file_utils.h"
 
-#include<boost/lexical_cast.hpp>
-#include <boost/tokenizer.hpp>
+#include <boost/lexical_cast.hpp>
 
 #include <sstream>
 #include <fstream>
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <array>
 
 using namespace std;
-using namespace boost;
 
 namespace gamgee {
 
 const auto PICARD_HEADER_TAG = '@';
-const auto sep = char_separator<char>{" \t:-"};
+const auto READ_CHUNK_SIZE = 1u << 20;
+
+/**
+ * @brief which characters separate the fields of an interval record (GATK chr:start-stop, Picard and BED are all covered)
+ */
+static const auto SEPARATORS = [] {
+  auto result = array<bool, 256>{};
+  for (const auto c : {' ', '\t', ':', '-', '\r'})
+    result[static_cast<uint8_t>(c)] = true;
+  return result;
+}();
+
+static inline bool is_separator(const char c) {
+  return SEPARATORS[static_cast<uint8_t>(c)];
+}
 
-void skip_picard_header(istream& infile) {
-  auto line = string{};
-  while(infile.peek() == PICARD_HEADER_TAG)
-    getline(infile, line);
+/**
+ * @brief skips separators, stopping at the end of the line
+ */
+static inline const char* skip_separators(const char* c, const char* end) {
+  while (c != end && *c != '\n' && is_separator(*c))
+    ++c;
+  return c;
 }
 
-Interval parse_interval_record(const string& line) {
-  auto tokens = tokenizer<char_separator<char>>{line, sep};
+/**
+ * @brief parses a genomic position, advancing c past it
+ * @exception throws boost::bad_lexical_cast if the field is not a valid position
+ */
+static inline uint32_t parse_position(const char*& c, const char* end) {
+  const auto begin = c;
+  auto result = uint64_t{0};
+  for (; c != end && static_cast<uint32_t>(*c - '0') <= 9; ++c) {
+    result = result * 10 + static_cast<uint32_t>(*c - '0');
+    if (result > numeric_limits<uint32_t>::max())
+      throw boost::bad_lexical_cast{};
+  }
+  if (c == begin || (c != end && *c != '\n' && !is_separator(*c)))
+    throw boost::bad_lexical_cast{};
+  return static_cast<uint32_t>(result);
+}
+
+/**
+ * @brief estimates the number of lines in a buffer from the length of the lines at its beginning (cheaper than counting them all)
+ */
+static size_t estimate_lines(const char* data, const size_t size) {
+  const auto sample_size = min<size_t>(size, 64 * 1024);
+  const auto sample_lines = static_cast<size_t>(count(data, data + sample_size, '\n')) + 1;
+  return sample_size == size ? sample_lines : sample_lines * (size / sample_size) + sample_lines;
+}
+
+/**
+ * @brief parses all the interval records in a buffer (one per line, with an optional Picard header at the top)
+ *
+ * Each line is scanned exactly once: fields are split and positions are converted in the same pass,
+ * and whatever follows the stop (e.g. Picard strand and name) is skipped with memchr. The output is
+ * reserved up front and the contig name is only rebuilt when it changes from the previous record, which
+ * is rare in the (sorted) intervals files we read.
+ */
+static void parse_interval_records(const char* data, const size_t size, vector<Interval>& result) {
+  auto c = data;
+  const auto end = data + size;
+  while (c != end && *c == PICARD_HEADER_TAG) {
+    const auto newline = static_cast<const char*>(memchr(c, '\n', end - c));
+    c = newline == nullptr ? end : newline + 1;
+  }
+  result.reserve(result.size() + estimate_lines(c, end - c));
   auto chr = string{};
-  auto start = 0u;
-  auto stop = -1;
-  auto it = tokens.begin();
-  chr = *it;
-  if( ++it !=  tokens.end()) 
-    start = lexical_cast<uint32_t>(*it);
-  if( ++it != tokens.end()) 
-    stop = lexical_cast<int32_t>(*it); // has to be int so we can check for failures
-  if (stop == -1) 
-    stop = start;  // interval may not have a stop (meaning one base interval). This makes sure stop is unsigned
-  return Interval {chr, start, static_cast<uint32_t>(stop)};  // stop is guaranteed to be unsigned by this point
+  while (c != end) {
+    c = skip_separators(c, end);
+    if (c != end && *c != '\n') {  // not a blank line
+      const auto chr_start = c;
+      while (c != end && *c != '\n' && !is_separator(*c))
+        ++c;
+      const auto chr_size = static_cast<size_t>(c - chr_start);
+      if (chr.size() != chr_size || chr.compare(0, chr_size, chr_start, chr_size) != 0)
+        chr.assign(chr_start, chr_size);
+      auto start = 0u;
+      c = skip_separators(c, end);
+      if (c != end && *c != '\n')
+        start = parse_position(c, end);
+      auto stop = start;  // interval may not have a stop (meaning one base interval)
+      c = skip_separators(c, end);
+      if (c != end && *c != '\n')
+        stop = parse_position(c, end);
+      result.emplace_back(chr, start, stop);
+    }
+    if (c != end && *c != '\n') {  // extra fields
+      const auto newline = static_cast<const char*>(memchr(c, '\n', end - c));
+      c = newline == nullptr ? end : newline;
+    }
+    if (c != end)
+      ++c;
+  }
 }
 
 vector<Interval> read_intervals(const string& intervals_file) {
-  ifstream infile {intervals_file};
-  return read_intervals(infile);
+  ifstream infile {intervals_file, ios::binary};
+  if (!infile.good())
+    return vector<Interval>{};
+  auto size = uint64_t{0};
+  const auto mapping = utils::memory_map_file(intervals_file, size);
+  if (size == 0)  // empty or not a regular file (e.g. a named pipe)
+    return read_intervals(infile);
+  auto result = vector<Interval>{};
+  parse_interval_records(reinterpret_cast<const char*>(mapping.get()), size, result);
+  return result;
 }
 
 vector<Interval> read_intervals(istream& input) {
+  auto buffer = string{};
+  while (input.good()) {
+    const auto filled = buffer.size();
+    buffer.resize(filled + READ_CHUNK_SIZE);
+    input.read(&buffer[filled], READ_CHUNK_SIZE);
+    buffer.resize(filled + input.gcount());
+  }
   auto result = vector<Interval>{};
-  skip_picard_header(input);
-  auto line = string{};
-  while(getline(input, line)) 
-    result.emplace_back(parse_interval_record(line));
+  parse_interval_records(buffer.data(), buffer.size(), result);
   return result;
 }
 
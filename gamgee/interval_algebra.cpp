@@ -0,0 +1,241 @@
+#include "interval_algebra.h"
+
+#include <algorithm>
+#include <numeric>
+#include <unordered_map>
+#include <stdexcept>
+#include <limits>
+
+using namespace std;
+
+namespace gamgee {
+
+namespace {
+
+/**
+ * @brief an interval with its contig replaced by a number (see ContigNumbering)
+ */
+struct Span {
+  uint32_t contig;
+  uint32_t start;
+  uint32_t stop;
+};
+
+/**
+ * @brief numbers the contigs so that sorting by number follows the requested contig order (and then lexicographical order)
+ */
+class ContigNumbering {
+ public:
+  ContigNumbering(const vector<string>& contig_order, const vector<const vector<Interval>*>& inputs) :
+    m_names {},
+    m_numbers {}
+  {
+    for (const auto& contig : contig_order)
+      add(contig);
+    auto others = vector<string>{};
+    for (const auto input : inputs) {
+      for (const auto& interval : *input) {
+        if (m_numbers.find(interval.chr()) == m_numbers.end()) {
+          others.push_back(interval.chr());
+          m_numbers.emplace(interval.chr(), 0);  // placeholder, numbered after sorting
+        }
+      }
+    }
+    sort(others.begin(), others.end());
+    for (const auto& contig : others) {
+      m_numbers.erase(contig);
+      add(contig);
+    }
+  }
+
+  uint32_t number(const string& contig) const { return m_numbers.at(contig); }
+  const string& name(const uint32_t number) const { return m_names[number]; }
+
+ private:
+  vector<string> m_names;
+  unordered_map<string, uint32_t> m_numbers;
+
+  void add(const string& contig) {
+    if (m_numbers.emplace(contig, m_names.size()).second)
+      m_names.push_back(contig);
+  }
+};
+
+bool operator<(const Span& lhs, const Span& rhs) {
+  if (lhs.contig != rhs.contig)
+    return lhs.contig < rhs.contig;
+  if (lhs.start != rhs.start)
+    return lhs.start < rhs.start;
+  return lhs.stop < rhs.stop;
+}
+
+}  // end of anonymous namespace
+
+/**
+ * @brief converts to spans sorted by contig, start and stop (empty intervals, with stop before start, are dropped)
+ */
+static vector<Span> sorted_spans(const vector<Interval>& intervals, const ContigNumbering& contigs) {
+  auto result = vector<Span>{};
+  result.reserve(intervals.size());
+  auto previous_chr = string{};
+  auto previous_contig = 0u;
+  for (const auto& interval : intervals) {
+    if (interval.stop() < interval.start())
+      continue;
+    if (result.empty() || interval.chr() != previous_chr) {  // avoid the hash lookup within runs of the same contig
+      previous_chr = interval.chr();
+      previous_contig = contigs.number(previous_chr);
+    }
+    result.push_back(Span{previous_contig, interval.start(), interval.stop()});
+  }
+  sort(result.begin(), result.end());
+  return result;
+}
+
+/**
+ * @brief merges overlapping and abutting spans in one pass over sorted spans
+ */
+static vector<Span> merged_spans(const vector<Span>& spans, const uint32_t padding) {
+  auto result = vector<Span>{};
+  for (const auto& span : spans) {
+    const auto start = span.start > padding ? span.start - padding : 1u;
+    const auto stop = static_cast<uint32_t>(min<uint64_t>(uint64_t{span.stop} + padding, numeric_limits<uint32_t>::max()));
+    if (!result.empty() && result.back().contig == span.contig && uint64_t{result.back().stop} + 1 >= start)
+      result.back().stop = max(result.back().stop, stop);
+    else
+      result.push_back(Span{span.contig, start, stop});
+  }
+  return result;
+}
+
+static vector<Interval> to_intervals(const vector<Span>& spans, const ContigNumbering& contigs) {
+  auto result = vector<Interval>{};
+  result.reserve(spans.size());
+  for (const auto& span : spans)
+    result.emplace_back(contigs.name(span.contig), span.start, span.stop);
+  return result;
+}
+
+vector<string> contig_order(const SamHeader& header) {
+  auto result = vector<string>{};
+  result.reserve(header.n_sequences());
+  for (auto i = 0u; i != header.n_sequences(); ++i)
+    result.push_back(header.sequence_name(i));
+  return result;
+}
+
+vector<string> contig_order(const VariantHeader& header) {
+  return header.chromosomes();
+}
+
+vector<Interval> sort_intervals(const vector<Interval>& intervals, const vector<string>& contig_order) {
+  const auto contigs = ContigNumbering{contig_order, {&intervals}};
+  auto keys = vector<pair<Span, uint32_t>>{};  // the original intervals are kept as is (e.g. output type)
+  keys.reserve(intervals.size());
+  for (auto i = 0u; i != intervals.size(); ++i)
+    keys.emplace_back(Span{contigs.number(intervals[i].chr()), intervals[i].start(), intervals[i].stop()}, i);
+  sort(keys.begin(), keys.end(), [](const pair<Span, uint32_t>& lhs, const pair<Span, uint32_t>& rhs) { return lhs.first < rhs.first; });
+  auto result = vector<Interval>{};
+  result.reserve(intervals.size());
+  for (const auto& key : keys)
+    result.push_back(intervals[key.second]);
+  return result;
+}
+
+vector<Interval> merge_intervals(const vector<Interval>& intervals, const uint32_t padding, const vector<string>& contig_order) {
+  const auto contigs = ContigNumbering{contig_order, {&intervals}};
+  return to_intervals(merged_spans(sorted_spans(intervals, contigs), padding), contigs);
+}
+
+vector<Interval> intersect_intervals(const vector<Interval>& lhs, const vector<Interval>& rhs, const vector<string>& contig_order) {
+  const auto contigs = ContigNumbering{contig_order, {&lhs, &rhs}};
+  const auto left = merged_spans(sorted_spans(lhs, contigs), 0);
+  const auto right = merged_spans(sorted_spans(rhs, contigs), 0);
+  auto result = vector<Span>{};
+  for (auto l = left.begin(), r = right.begin(); l != left.end() && r != right.end(); ) {
+    if (l->contig != r->contig) {
+      l->contig < r->contig ? ++l : ++r;
+      continue;
+    }
+    const auto start = max(l->start, r->start);
+    const auto stop = min(l->stop, r->stop);
+    if (start <= stop)
+      result.push_back(Span{l->contig, start, stop});
+    l->stop < r->stop ? ++l : ++r;  // the one that ends first can't overlap anything else
+  }
+  return to_intervals(result, contigs);
+}
+
+vector<Interval> subtract_intervals(const vector<Interval>& lhs, const vector<Interval>& rhs, const vector<string>& contig_order) {
+  const auto contigs = ContigNumbering{contig_order, {&lhs, &rhs}};
+  const auto left = merged_spans(sorted_spans(lhs, contigs), 0);
+  const auto right = merged_spans(sorted_spans(rhs, contigs), 0);
+  auto result = vector<Span>{};
+  auto first_right = right.begin();
+  for (const auto& span : left) {
+    while (first_right != right.end() && (first_right->contig < span.contig || (first_right->contig == span.contig && first_right->stop < span.start)))
+      ++first_right;
+    auto start = uint64_t{span.start};
+    for (auto r = first_right; r != right.end() && r->contig == span.contig && r->start <= span.stop; ++r) {
+      if (r->start > start)
+        result.push_back(Span{span.contig, static_cast<uint32_t>(start), r->start - 1});
+      start = max(start, uint64_t{r->stop} + 1);
+    }
+    if (start <= span.stop)
+      result.push_back(Span{span.contig, static_cast<uint32_t>(start), span.stop});
+  }
+  return to_intervals(result, contigs);
+}
+
+/**
+ * @brief complement of the intervals against a dictionary of contig names and lengths
+ */
+static vector<Interval> complement_intervals(const vector<Interval>& intervals, const vector<pair<string, uint32_t>>& dictionary) {
+  auto dictionary_order = vector<string>{};
+  for (const auto& contig : dictionary)
+    dictionary_order.push_back(contig.first);
+  const auto contigs = ContigNumbering{dictionary_order, {&intervals}};
+  const auto spans = merged_spans(sorted_spans(intervals, contigs), 0);
+  auto result = vector<Span>{};
+  auto span = spans.begin();
+  for (auto contig = 0u; contig != dictionary.size(); ++contig) {
+    const auto length = uint64_t{dictionary[contig].second};
+    auto start = uint64_t{1};
+    for (; span != spans.end() && span->contig == contig; ++span) {
+      if (span->start > start && start <= length)
+        result.push_back(Span{contig, static_cast<uint32_t>(start), static_cast<uint32_t>(min<uint64_t>(span->start - 1, length))});
+      start = max(start, uint64_t{span->stop} + 1);
+    }
+    if (start <= length)
+      result.push_back(Span{contig, static_cast<uint32_t>(start), static_cast<uint32_t>(length)});
+  }
+  return to_intervals(result, contigs);
+}
+
+vector<Interval> complement_intervals(const vector<Interval>& intervals, const SamHeader& header) {
+  auto dictionary = vector<pair<string, uint32_t>>{};
+  for (auto i = 0u; i != header.n_sequences(); ++i)
+    dictionary.emplace_back(header.sequence_name(i), header.sequence_length(i));
+  return complement_intervals(intervals, dictionary);
+}
+
+vector<Interval> complement_intervals(const vector<Interval>& intervals, const VariantHeader& header) {
+  auto dictionary = vector<pair<string, uint32_t>>{};
+  for (const auto& chromosome : header.chromosomes())
+    dictionary.emplace_back(chromosome, header.chromosome_length(chromosome));
+  return complement_intervals(intervals, dictionary);
+}
+
+vector<Interval> split_intervals(const vector<Interval>& intervals, const uint32_t max_size) {
+  if (max_size == 0)
+    throw invalid_argument{"intervals cannot be split into pieces of size 0"};
+  auto result = vector<Interval>{};
+  result.reserve(intervals.size());
+  for (const auto& interval : intervals) {
+    for (auto start = uint64_t{interval.start()}; start <= interval.stop(); start += max_size)
+      result.emplace_back(interval.chr(), static_cast<uint32_t>(start), static_cast<uint32_t>(min<uint64_t>(start + max_size - 1, interval.stop())), interval.output_type());
+  }
+  return result;
+}
+
+}  // end of namespace
@@ -0,0 +1,74 @@
+#ifndef gamgee__interval_algebra__guard
+#define gamgee__interval_algebra__guard
+
+#include "interval.h"
+#include "sam/sam_header.h"
+#include "variant/variant_header.h"
+
+#include <vector>
+#include <string>
+
+namespace gamgee {
+
+/**
+ * @file
+ * @brief Set operations on lists of Intervals.
+ *
+ * Every operation sorts its inputs once (by contig, then start) and then makes a single linear pass
+ * over them, so the cost is O(n log n) for the sort and O(n + m) for the operation itself. Results are
+ * sorted and, except for sort_intervals and split_intervals, merged (no two output intervals overlap or
+ * abut).
+ *
+ * Contigs are ordered by the optional contig_order (e.g. the sequence dictionary of a SamHeader or
+ * VariantHeader, see contig_order()). Contigs missing from it (or all contigs, if it's empty) come
+ * after, in lexicographical order.
+ *
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ * const auto header = SingleSamReader{"reads.bam"}.header();
+ * const auto targets = merge_intervals(read_intervals("targets.interval_list"), 100, contig_order(header));
+ * const auto callable = subtract_intervals(targets, read_intervals("blacklist.bed"), contig_order(header));
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ */
+
+std::vector<std::string> contig_order(const SamHeader& header);      ///< @brief the contigs of the sequence dictionary of a SAM/BAM/CRAM header, in order
+std::vector<std::string> contig_order(const VariantHeader& header);  ///< @brief the contigs declared in a VCF/BCF header, in order
+
+/**
+ * @brief sorts intervals by contig, start and stop (overlapping intervals are kept)
+ */
+std::vector<Interval> sort_intervals(const std::vector<Interval>& intervals, const std::vector<std::string>& contig_order = {});
+
+/**
+ * @brief merges overlapping and abutting intervals, after padding each of them on both sides
+ * @param padding number of bases added before the start (never going below 1) and after the stop of every interval
+ */
+std::vector<Interval> merge_intervals(const std::vector<Interval>& intervals, const uint32_t padding = 0, const std::vector<std::string>& contig_order = {});
+
+/**
+ * @brief the loci covered by both lists of intervals
+ */
+std::vector<Interval> intersect_intervals(const std::vector<Interval>& lhs, const std::vector<Interval>& rhs, const std::vector<std::string>& contig_order = {});
+
+/**
+ * @brief the loci covered by lhs but not by rhs
+ */
+std::vector<Interval> subtract_intervals(const std::vector<Interval>& lhs, const std::vector<Interval>& rhs, const std::vector<std::string>& contig_order = {});
+
+/**
+ * @brief the loci of the sequence dictionary not covered by any interval, in dictionary order
+ *
+ * Intervals on contigs that are not in the dictionary are ignored. Contigs with no declared length
+ * (possible in VCF headers) are skipped.
+ */
+std::vector<Interval> complement_intervals(const std::vector<Interval>& intervals, const SamHeader& header);
+std::vector<Interval> complement_intervals(const std::vector<Interval>& intervals, const VariantHeader& header); ///< @brief the loci of the VCF/BCF contigs not covered by any interval, in header order
+
+/**
+ * @brief splits every interval into consecutive pieces of at most max_size bases (input order is kept)
+ * @exception throws std::invalid_argument if max_size is 0
+ */
+std::vector<Interval> split_intervals(const std::vector<Interval>& intervals, const uint32_t max_size);
+
+}  // end of namespace
+
+#endif /* gamgee__interval_algebra__guard */
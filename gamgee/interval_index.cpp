@@ -0,0 +1,160 @@
+#include "interval_index.h"
+
+#include <algorithm>
+#include <numeric>
+
+using namespace std;
+
+namespace gamgee {
+
+IntervalIndex::IntervalIndex(const std::vector<Interval>& intervals) :
+  m_intervals {intervals},
+  m_starts {},
+  m_stops {},
+  m_max_stops {},
+  m_ids {},
+  m_contigs {}
+{
+  // group by contig (in order of first appearance) then sort by start within each contig
+  auto contig_numbers = unordered_map<string, uint32_t>{};
+  auto interval_contigs = vector<uint32_t>{};
+  interval_contigs.reserve(intervals.size());
+  for (const auto& interval : intervals)
+    interval_contigs.push_back(contig_numbers.emplace(interval.chr(), contig_numbers.size()).first->second);
+  auto order = vector<uint32_t>(intervals.size());
+  iota(order.begin(), order.end(), 0);
+  sort(order.begin(), order.end(), [&](const uint32_t lhs, const uint32_t rhs) {
+    if (interval_contigs[lhs] != interval_contigs[rhs])
+      return interval_contigs[lhs] < interval_contigs[rhs];
+    if (intervals[lhs].start() != intervals[rhs].start())
+      return intervals[lhs].start() < intervals[rhs].start();
+    return lhs < rhs;
+  });
+
+  m_starts.reserve(order.size());
+  m_stops.reserve(order.size());
+  m_ids = order;
+  for (auto i = 0u; i != order.size(); ++i) {
+    const auto& interval = intervals[order[i]];
+    if (i == 0 || interval_contigs[order[i]] != interval_contigs[order[i - 1]])
+      m_contigs[interval.chr()] = ContigRange{i, i, 0};
+    ++m_contigs[interval.chr()].last;
+    m_starts.push_back(interval.start());
+    m_stops.push_back(interval.stop());
+  }
+  m_max_stops = m_stops;
+  for (auto& contig : m_contigs)
+    build_tree(contig.second);
+}
+
+/**
+ * @brief fills in the largest stop of every subtree of the implicit tree of a contig, level by level (as in cgranges)
+ *
+ * Leaves (even positions) keep their own stop. A node at level k sits at position i, with children at
+ * i - 2^(k-1) and i + 2^(k-1). The right children past the end of the contig don't exist, so the largest
+ * stop of the last subtree of each level (last) stands in for them.
+ */
+void IntervalIndex::build_tree(ContigRange& contig) {
+  const auto n = static_cast<int64_t>(contig.last - contig.first);
+  auto* max_stops = m_max_stops.data() + contig.first;
+  const auto* stops = m_stops.data() + contig.first;
+  auto last_position = int64_t{0};
+  auto last = uint32_t{0};
+  for (auto i = int64_t{0}; i < n; i += 2) {
+    last_position = i;
+    last = max_stops[i];
+  }
+  auto level = 1;
+  for (; (int64_t{1} << level) <= n; ++level) {
+    const auto half = int64_t{1} << (level - 1);
+    for (auto i = (half << 1) - 1; i < n; i += half << 2) {
+      const auto left = max_stops[i - half];
+      const auto right = i + half < n ? max_stops[i + half] : last;
+      max_stops[i] = max(stops[i], max(left, right));
+    }
+    last_position = (last_position >> level & 1) ? last_position - half : last_position + half;
+    if (last_position < n && max_stops[last_position] > last)
+      last = max_stops[last_position];
+  }
+  contig.max_level = level - 1;
+}
+
+vector<uint32_t> IntervalIndex::find_overlaps(const std::string& chromosome, const uint32_t start, const uint32_t stop) const {
+  auto result = vector<uint32_t>{};
+  for_each_overlap(chromosome, start, stop, [&result](const uint32_t id) { result.push_back(id); });
+  return result;
+}
+
+bool IntervalIndex::overlaps(const std::string& chromosome, const uint32_t start, const uint32_t stop) const {
+  const auto contig = m_contigs.find(chromosome);
+  if (contig == m_contigs.end())
+    return false;
+  auto found = false;
+  visit_overlaps(contig->second, start, stop, [&found](const uint32_t) { found = true; return false; });
+  return found;
+}
+
+IntervalIndex::Cursor::Cursor(const IntervalIndex& index) :
+  m_index {&index},
+  m_chromosome {},
+  m_contig {nullptr},
+  m_next {0},
+  m_active {},
+  m_previous_start {0}
+{}
+
+vector<uint32_t> IntervalIndex::Cursor::find_overlaps(const std::string& chromosome, const uint32_t start, const uint32_t stop) {
+  auto result = vector<uint32_t>{};
+  for_each_overlap(chromosome, start, stop, [&result](const uint32_t id) { result.push_back(id); });
+  return result;
+}
+
+bool IntervalIndex::Cursor::overlaps(const std::string& chromosome, const uint32_t start, const uint32_t stop) {
+  advance(chromosome, start, stop);
+  const auto& starts = m_index->m_starts;
+  return any_of(m_active.begin(), m_active.end(), [&starts, stop](const uint32_t position) { return starts[position] <= stop; });
+}
+
+/**
+ * @brief moves the sweep to the new probe
+ *
+ * For sorted probes, the intervals that end before the probe (and therefore before every later probe) leave
+ * the active list and the ones that start before the end of the probe join it, so each interval is examined
+ * a bounded number of times plus once per probe it is active for. Active intervals that start after the end
+ * of a probe shorter than the previous ones are filtered when reporting. A probe that goes backwards
+ * rebuilds the active list from a tree query.
+ *
+ * @return the number of intervals examined
+ */
+uint32_t IntervalIndex::Cursor::advance(const std::string& chromosome, const uint32_t start, const uint32_t stop) {
+  if (chromosome != m_chromosome) {
+    const auto contig = m_index->m_contigs.find(chromosome);
+    m_contig = contig == m_index->m_contigs.end() ? nullptr : &contig->second;
+    m_next = m_contig == nullptr ? 0 : m_contig->first;
+    m_active.clear();
+    m_chromosome = chromosome;
+    m_previous_start = 0;
+  }
+  if (m_contig == nullptr)
+    return 0;
+  const auto& starts = m_index->m_starts;
+  const auto& stops = m_index->m_stops;
+  auto examined = 0u;
+  if (start < m_previous_start) {
+    m_active.clear();
+    examined = m_index->visit_overlaps(*m_contig, start, stop, [this](const uint32_t position) { m_active.push_back(position); return true; });
+    m_next = static_cast<uint32_t>(upper_bound(starts.begin() + m_contig->first, starts.begin() + m_contig->last, stop) - starts.begin());
+  }
+  else {
+    examined = m_active.size();
+    m_active.erase(remove_if(m_active.begin(), m_active.end(), [&stops, start](const uint32_t position) { return stops[position] < start; }), m_active.end());
+    for (; m_next < m_contig->last && starts[m_next] <= stop; ++m_next, ++examined) {
+      if (stops[m_next] >= start)
+        m_active.push_back(m_next);
+    }
+  }
+  m_previous_start = start;
+  return examined;
+}
+
+}  // end of namespace
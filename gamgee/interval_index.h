@@ -0,0 +1,194 @@
+#ifndef gamgee__interval_index__guard
+#define gamgee__interval_index__guard
+
+#include "interval.h"
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <algorithm>
+
+namespace gamgee {
+
+/**
+ * @brief Index of a set of Intervals (e.g. the targets returned by read_intervals) for fast overlap queries.
+ *
+ * The intervals of each contig are kept in flat arrays sorted by start, laid out as an implicit balanced
+ * binary tree (the cgranges layout: the node at position i has level equal to the number of trailing 1 bits
+ * of i) augmented with the largest stop of each subtree. An overlap query skips every subtree that ends
+ * before the query, so it costs O(log n + number of overlaps) however long the indexed intervals are
+ * (e.g. a whole chromosome target among exome baits), with sequential memory access near the leaves.
+ *
+ * Hits are reported as ids: the position of the interval in the vector given to the constructor.
+ *
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ * const auto targets = IntervalIndex{read_intervals("targets.interval_list")};
+ * for (const auto& record : SingleSamReader{"reads.bam"})
+ *   if (targets.overlaps(record.chromosome_name(), record.alignment_start(), record.alignment_stop()))
+ *     ...
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ *
+ * For coordinate sorted probes use a Cursor, which avoids the contig lookup and the tree descent.
+ */
+class IntervalIndex {
+ public:
+
+  /**
+   * @brief indexes a set of intervals (in any order, overlapping or not)
+   */
+  explicit IntervalIndex(const std::vector<Interval>& intervals);
+
+  IntervalIndex(const IntervalIndex&) = default;
+  IntervalIndex(IntervalIndex&&) = default;
+  IntervalIndex& operator=(const IntervalIndex&) = default;
+  IntervalIndex& operator=(IntervalIndex&&) = default;
+
+  /**
+   * @brief calls function(id) for every interval overlapping [start, stop] on chromosome, in order of interval start
+   * @return the number of intervals examined to answer the query (the cost of the query, at least the number of overlaps)
+   */
+  template <class FUNCTION>
+  uint32_t for_each_overlap(const std::string& chromosome, const uint32_t start, const uint32_t stop, FUNCTION&& function) const {
+    const auto contig = m_contigs.find(chromosome);
+    if (contig == m_contigs.end())
+      return 0;
+    return visit_overlaps(contig->second, start, stop, [this, &function](const uint32_t position) { function(m_ids[position]); return true; });
+  }
+
+  /**
+   * @brief ids of all the intervals overlapping [start, stop] on chromosome, sorted by interval start
+   */
+  std::vector<uint32_t> find_overlaps(const std::string& chromosome, const uint32_t start, const uint32_t stop) const;
+  std::vector<uint32_t> find_overlaps(const Interval& interval) const { return find_overlaps(interval.chr(), interval.start(), interval.stop()); } ///< @brief ids of all the intervals overlapping interval
+
+  /**
+   * @brief whether any interval overlaps [start, stop] on chromosome
+   */
+  bool overlaps(const std::string& chromosome, const uint32_t start, const uint32_t stop) const;
+  bool overlaps(const Interval& interval) const { return overlaps(interval.chr(), interval.start(), interval.stop()); }      ///< @brief whether any interval overlaps interval
+  bool contains(const std::string& chromosome, const uint32_t position) const { return overlaps(chromosome, position, position); } ///< @brief whether any interval contains a genomic position
+
+  uint32_t size() const { return m_intervals.size(); }                    ///< @brief number of indexed intervals
+  bool empty() const { return m_intervals.empty(); }                      ///< @brief whether there are no indexed intervals
+  const Interval& interval(const uint32_t id) const { return m_intervals[id]; } ///< @brief the interval with this id (its position in the constructor input)
+
+ private:
+  /**
+   * @brief the intervals of a contig: positions [first, last) of the index arrays, a tree whose root has level max_level
+   */
+  struct ContigRange {
+    uint32_t first;
+    uint32_t last;
+    int32_t max_level;
+  };
+
+ public:
+  /**
+   * @brief Streaming overlap queries for probes sorted by coordinate.
+   *
+   * The cursor sweeps the intervals of the contig along with the probes, keeping the intervals that started
+   * before the previous probe ended and that do not end before it, so a stream of probes sorted by contig and
+   * start (e.g. the records of a coordinate sorted BAM or VCF) is annotated in amortized time proportional to
+   * the overlaps. A probe that goes backwards is answered by the tree and restarts the sweep from there.
+   *
+   * @warning the cursor holds a pointer to the index, which must outlive it
+   */
+  class Cursor {
+   public:
+    explicit Cursor(const IntervalIndex& index);
+
+    /**
+     * @brief calls function(id) for every interval overlapping [start, stop] on chromosome, in order of interval start
+     * @return the number of intervals examined to answer the query
+     */
+    template <class FUNCTION>
+    uint32_t for_each_overlap(const std::string& chromosome, const uint32_t start, const uint32_t stop, FUNCTION&& function) {
+      const auto examined = advance(chromosome, start, stop);
+      for (const auto position : m_active) {
+        if (m_index->m_starts[position] <= stop)
+          function(m_index->m_ids[position]);
+      }
+      return examined;
+    }
+
+    std::vector<uint32_t> find_overlaps(const std::string& chromosome, const uint32_t start, const uint32_t stop); ///< @brief ids of all the intervals overlapping [start, stop], sorted by interval start
+    bool overlaps(const std::string& chromosome, const uint32_t start, const uint32_t stop);                       ///< @brief whether any interval overlaps [start, stop]
+    bool overlaps(const Interval& interval) { return overlaps(interval.chr(), interval.start(), interval.stop()); }///< @brief whether any interval overlaps interval
+
+   private:
+    const IntervalIndex* m_index;   ///< the index being queried
+    std::string m_chromosome;       ///< chromosome of the previous probe
+    const ContigRange* m_contig;    ///< its intervals in the index (nullptr if it has none)
+    uint32_t m_next;                ///< every interval from this position on starts after the end of the previous probes
+    std::vector<uint32_t> m_active; ///< positions before m_next of the intervals that don't end before the previous probe, sorted
+    uint32_t m_previous_start;      ///< start of the previous probe
+
+    uint32_t advance(const std::string& chromosome, const uint32_t start, const uint32_t stop);
+  };
+
+  Cursor cursor() const { return Cursor{*this}; } ///< @brief a streaming cursor for coordinate sorted probes
+
+ private:
+  std::vector<Interval> m_intervals;                          ///< the indexed intervals, in input order
+  std::vector<uint32_t> m_starts;                             ///< interval starts, sorted within each contig
+  std::vector<uint32_t> m_stops;                              ///< interval stops, in the same order as m_starts
+  std::vector<uint32_t> m_max_stops;                          ///< m_max_stops[i] is the largest stop in the subtree rooted at position i of its contig's tree
+  std::vector<uint32_t> m_ids;                                ///< interval ids, in the same order as m_starts
+  std::unordered_map<std::string, ContigRange> m_contigs;     ///< contig -> its intervals in the arrays
+
+  static constexpr int32_t SCAN_LEVEL = 3;  ///< subtrees this low (at most 15 intervals) are scanned rather than descended
+
+  void build_tree(ContigRange& contig);
+
+  /**
+   * @brief calls function(position) for the intervals of contig overlapping [start, stop], in order of position, while it returns true
+   *
+   * Walks the implicit tree of the contig in order with an explicit stack, skipping the subtrees that end
+   * before start and everything that begins after stop.
+   *
+   * @return the number of intervals examined
+   */
+  template <class FUNCTION>
+  uint32_t visit_overlaps(const ContigRange& contig, const uint32_t start, const uint32_t stop, FUNCTION&& function) const {
+    struct Node { int64_t position; int32_t level; bool left_done; };
+    Node stack[64];
+    auto top = 0;
+    auto examined = 0u;
+    const auto n = static_cast<int64_t>(contig.last - contig.first);
+    const auto* starts = m_starts.data() + contig.first;
+    const auto* stops = m_stops.data() + contig.first;
+    const auto* max_stops = m_max_stops.data() + contig.first;
+    stack[top++] = Node{(int64_t{1} << contig.max_level) - 1, contig.max_level, false};
+    while (top != 0) {
+      const auto node = stack[--top];
+      if (!node.left_done && node.position < n && max_stops[node.position] < start)  // the whole subtree ends before the query
+        continue;
+      if (node.level <= SCAN_LEVEL) {
+        const auto subtree_first = node.position >> node.level << node.level;
+        const auto subtree_last = std::min(n, subtree_first + (int64_t{1} << (node.level + 1)) - 1);
+        for (auto i = subtree_first; i < subtree_last && starts[i] <= stop; ++i) {
+          ++examined;
+          if (stops[i] >= start && !function(contig.first + static_cast<uint32_t>(i)))
+            return examined;
+        }
+      }
+      else if (!node.left_done) {
+        const auto left = node.position - (int64_t{1} << (node.level - 1));
+        stack[top++] = Node{node.position, node.level, true};
+        if (left >= n || max_stops[left] >= start)
+          stack[top++] = Node{left, node.level - 1, false};
+      }
+      else if (node.position < n && starts[node.position] <= stop) {
+        ++examined;
+        if (stops[node.position] >= start && !function(contig.first + static_cast<uint32_t>(node.position)))
+          return examined;
+        stack[top++] = Node{node.position + (int64_t{1} << (node.level - 1)), node.level - 1, false};
+      }
+    }
+    return examined;
+  }
+};
+
+}  // end of namespace
+
+#endif /* gamgee__interval_index__guard */
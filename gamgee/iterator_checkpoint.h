@@ -0,0 +1,70 @@
+#ifndef gamgee__iterator_checkpoint__guard
+#define gamgee__iterator_checkpoint__guard
+
+#include <string>
+#include <stdexcept>
+#include <cstdint>
+
+namespace gamgee {
+
+/**
+ * @brief Position of an iterator that can be saved and later used to resume the iteration.
+ *
+ * Taken from an iterator with checkpoint() and restored with resume() on an iterator over the same file
+ * (and, for the indexed iterators, the same interval list), which then continues with the record that
+ * followed the current record when the checkpoint was taken. Resuming seeks straight to the saved
+ * position, so it costs the same no matter how far into the file the checkpoint is.
+ *
+ * Checkpoints are plain values: store the two fields or the str() representation and rebuild them with
+ * the constructors. Only binary BGZF files (BAM and BCF) can be checkpointed.
+ *
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ * auto reader = SingleSamReader{"reads.bam"};
+ * auto iterator = reader.begin();
+ * if (!saved.empty())
+ *   iterator.resume(IteratorCheckpoint{saved});
+ * for (; iterator != reader.end(); ++iterator) {
+ *   process(*iterator);
+ *   if (time_to_save())
+ *     save(iterator.checkpoint().str());
+ * }
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ */
+struct IteratorCheckpoint {
+  uint64_t offset;    ///< BGZF virtual offset (compressed block offset << 16 | offset within the block) right after the current record
+  uint32_t interval;  ///< position of the interval being iterated in the interval list (always 0 for non-indexed iterators)
+
+  IteratorCheckpoint() : offset {0}, interval {0} {}
+  IteratorCheckpoint(const uint64_t virtual_offset, const uint32_t interval_number) : offset {virtual_offset}, interval {interval_number} {}
+
+  /**
+   * @brief parses a checkpoint from its str() representation
+   * @exception std::invalid_argument if the string is not exactly two decimal numbers separated by one ':'
+   * or if either number does not fit its field
+   */
+  explicit IteratorCheckpoint(const std::string& checkpoint) : offset {0}, interval {0} {
+    const auto separator = checkpoint.find(':');
+    if (separator == std::string::npos || separator == 0 || separator + 1 == checkpoint.size() ||
+        checkpoint.find_first_not_of("0123456789") != separator || checkpoint.find_first_not_of("0123456789", separator + 1) != std::string::npos)
+      throw std::invalid_argument{"invalid iterator checkpoint: " + checkpoint};
+    try {
+      const auto interval_number = std::stoull(checkpoint.substr(0, separator));
+      if (interval_number > UINT32_MAX)
+        throw std::out_of_range{"interval number"};
+      interval = static_cast<uint32_t>(interval_number);
+      offset = std::stoull(checkpoint.substr(separator + 1));
+    }
+    catch (const std::out_of_range&) {
+      throw std::invalid_argument{"iterator checkpoint out of range: " + checkpoint};
+    }
+  }
+
+  std::string str() const { return std::to_string(interval) + ":" + std::to_string(offset); } ///< @brief text representation (interval:offset)
+
+  bool operator==(const IteratorCheckpoint& rhs) const { return offset == rhs.offset && interval == rhs.interval; }
+  bool operator!=(const IteratorCheckpoint& rhs) const { return !(*this == rhs); }
+};
+
+}  // end of namespace
+
+#endif /* gamgee__iterator_checkpoint__guard */
@@ -0,0 +1,389 @@
+#include "kmer_index.h"
+
+#include "exceptions.h"
+#include "utils/file_utils.h"
+#include "utils/loser_tree.h"
+
+#include <string>
+#include <vector>
+#include <fstream>
+#include <algorithm>
+#include <numeric>
+#include <array>
+#include <stdexcept>
+#include <thread>
+#include <atomic>
+#include <exception>
+#include <cstring>
+
+using namespace std;
+
+namespace gamgee {
+
+/******************************************************************************
+ * File layout (all offsets are in bytes from the start of the file, all sections are 8-byte aligned)
+ *
+ *   FileHeader
+ *   prefix table (2^prefix_bits + 1 uint64_t)
+ *   contig starts (n_contigs + 1 uint64_t)
+ *   packed sequence (sequence_words uint64_t)
+ *   entries (n_entries uint32_t, sorted by canonical k-mer, then position)
+ *   contig names (null terminated, in contig order)
+ ******************************************************************************/
+
+const char KMER_INDEX_MAGIC[8] = {'G', 'A', 'M', 'G', 'E', 'E', 'K', 'I'};
+const uint32_t KMER_INDEX_VERSION = 2;
+const uint32_t MAX_PREFIX_BITS = 28;
+const uint32_t ENTRIES_PER_BUCKET = 16;    ///< average size of the range searched by a lookup (the prefix table costs 8 / ENTRIES_PER_BUCKET bytes per entry)
+const uint32_t BASES_PER_WORD = 32;
+
+constexpr uint32_t KmerIndex::MAX_K;
+
+struct KmerIndex::FileHeader {
+  char magic[8];                 ///< always KMER_INDEX_MAGIC
+  uint32_t version;              ///< format version
+  uint32_t k;                    ///< k-mer size
+  uint32_t prefix_bits;          ///< number of bits of the prefix table
+  uint32_t n_contigs;            ///< number of contig names
+  uint64_t n_entries;            ///< number of entries
+  uint64_t sequence_words;       ///< number of words of the packed sequence
+  uint64_t buckets_offset;       ///< offset of the prefix table
+  uint64_t contig_starts_offset; ///< offset of the contig starts
+  uint64_t sequence_offset;      ///< offset of the packed sequence
+  uint64_t entries_offset;       ///< offset of the entries
+  uint64_t names_offset;         ///< offset of the contig names
+  uint64_t names_size;           ///< size of the contig names section
+  uint64_t file_size;            ///< total size of the file (detects truncated files)
+};
+
+/**
+ * @brief the arrays of an index built in memory
+ */
+struct KmerIndex::Storage {
+  vector<uint32_t> entries;
+  vector<uint64_t> buckets;
+  vector<uint64_t> sequence;
+  vector<uint64_t> contig_starts;
+};
+
+/**
+ * @brief 2-bit code of each base (A=0, C=1, G=2, T=3, any other character=4)
+ */
+static const array<uint8_t, 256> BASE_CODES = [] {
+  auto codes = array<uint8_t, 256>{};
+  codes.fill(4);
+  codes['A'] = codes['a'] = 0;
+  codes['C'] = codes['c'] = 1;
+  codes['G'] = codes['g'] = 2;
+  codes['T'] = codes['t'] = 3;
+  return codes;
+}();
+
+static uint64_t kmer_mask(const uint32_t k) {
+  return k == 32 ? ~uint64_t{0} : (uint64_t{1} << (2 * k)) - 1;
+}
+
+/**
+ * @brief reverse complement of a k-mer: complements the bases and reverses the order of the 2-bit groups
+ */
+static uint64_t reverse_complement(uint64_t kmer, const uint32_t k) {
+  kmer = ~kmer;
+  kmer = ((kmer >> 2) & 0x3333333333333333ull) | ((kmer & 0x3333333333333333ull) << 2);
+  kmer = ((kmer >> 4) & 0x0F0F0F0F0F0F0F0Full) | ((kmer & 0x0F0F0F0F0F0F0F0Full) << 4);
+  return __builtin_bswap64(kmer) >> (64 - 2 * k);
+}
+
+/**
+ * @brief position of a k-mer in the prefix table
+ */
+static uint64_t prefix_of(const uint64_t kmer, const uint32_t k, const uint32_t prefix_bits) {
+  return prefix_bits == 0 ? 0 : kmer >> (2 * k - prefix_bits);
+}
+
+/**
+ * @brief rolls over a sequence calling add(forward, reverse_complement, zero-based position) for every k-mer made only of A, C, G and T
+ */
+template <class ADD>
+static void for_each_kmer(const string& sequence, const uint32_t k, ADD&& add) {
+  const auto mask = kmer_mask(k);
+  const auto reverse_shift = 2 * (k - 1);
+  auto forward = uint64_t{0};
+  auto reverse = uint64_t{0};
+  auto valid_bases = 0u;
+  for (auto i = 0u; i != sequence.size(); ++i) {
+    const auto code = BASE_CODES[static_cast<uint8_t>(sequence[i])];
+    if (code > 3) {
+      valid_bases = 0;
+      continue;
+    }
+    forward = ((forward << 2) | code) & mask;
+    reverse = (reverse >> 2) | (uint64_t{3u - code} << reverse_shift);
+    if (++valid_bases >= k)
+      add(forward, reverse, i + 1 - k);
+  }
+}
+
+/**
+ * @brief packs a contig at 2 bits per base from the start of a word (bases other than A, C, G or T are packed as A: no k-mer covers them)
+ */
+static void pack_sequence(const string& sequence, uint64_t* words) {
+  for (auto i = size_t{0}; i < sequence.size(); i += BASES_PER_WORD) {
+    auto word = uint64_t{0};
+    const auto n_bases = min<size_t>(BASES_PER_WORD, sequence.size() - i);
+    for (auto j = size_t{0}; j != n_bases; ++j)
+      word = (word << 2) | (BASE_CODES[static_cast<uint8_t>(sequence[i + j])] & 3u);
+    words[i / BASES_PER_WORD] = word << (2 * (BASES_PER_WORD - n_bases));
+  }
+}
+
+KmerIndex::KmerIndex() :
+  m_storage {},
+  m_entries {nullptr},
+  m_buckets {nullptr},
+  m_sequence {nullptr},
+  m_contig_starts {nullptr},
+  m_n_entries {0},
+  m_k {0},
+  m_prefix_bits {0},
+  m_contig_names {}
+{}
+
+KmerIndex KmerIndex::build(const ReferenceMap& reference, const uint32_t k, const uint32_t n_threads) {
+  if (k < 1 || k > MAX_K)
+    throw invalid_argument{"k-mer size must be between 1 and " + to_string(MAX_K)};
+  auto result = KmerIndex{};
+  result.m_k = k;
+  for (const auto& contig : reference)
+    result.m_contig_names.push_back(contig.first);
+  sort(result.m_contig_names.begin(), result.m_contig_names.end());
+
+  // every contig starts on a word boundary, so that the contigs can be packed in parallel
+  const auto n_contigs = result.m_contig_names.size();
+  auto storage = make_shared<Storage>();
+  auto& contig_starts = storage->contig_starts;
+  contig_starts.push_back(0);
+  for (const auto& name : result.m_contig_names) {
+    const auto size = uint64_t{reference.at(name).size()};
+    contig_starts.push_back(contig_starts.back() + (size + BASES_PER_WORD - 1) / BASES_PER_WORD * BASES_PER_WORD);
+  }
+  if (contig_starts.back() > (uint64_t{1} << 32))
+    throw invalid_argument{"the reference is too large for a k-mer index (at most 2^32 bases)"};
+  storage->sequence.assign(contig_starts.back() / BASES_PER_WORD + 1, 0);
+  result.m_sequence = storage->sequence.data();
+
+  // each contig is packed, indexed and sorted independently, in parallel (errors are rethrown here once all threads are done)
+  auto per_contig = vector<vector<uint32_t>>(n_contigs);
+  auto errors = vector<exception_ptr>(n_contigs);
+  atomic<size_t> next_contig {0};
+  const auto index_contigs = [&] {
+    auto kmers = vector<pair<uint64_t, uint32_t>>{};
+    for (auto contig = next_contig++; contig < n_contigs; contig = next_contig++) {
+      try {
+        const auto& sequence = reference.at(result.m_contig_names[contig]);
+        const auto start = contig_starts[contig];
+        pack_sequence(sequence, storage->sequence.data() + start / BASES_PER_WORD);
+        kmers.clear();
+        kmers.reserve(sequence.size() >= k ? sequence.size() - k + 1 : 0);
+        for_each_kmer(sequence, k, [&](const uint64_t forward, const uint64_t reverse, const uint32_t position) {
+          kmers.emplace_back(min(forward, reverse), static_cast<uint32_t>(start + position));
+        });
+        sort(kmers.begin(), kmers.end());
+        auto& entries = per_contig[contig];
+        entries.reserve(kmers.size());
+        for (const auto& kmer : kmers)
+          entries.push_back(kmer.second);
+      }
+      catch (...) {
+        errors[contig] = current_exception();
+      }
+    }
+  };
+  auto threads = vector<thread>{};
+  for (auto i = 1u; i < min<size_t>(max(n_threads, 1u), n_contigs); ++i)
+    threads.emplace_back(index_contigs);
+  index_contigs();
+  for (auto& thread : threads)
+    thread.join();
+  for (const auto& error : errors) {
+    if (error)
+      rethrow_exception(error);
+  }
+
+  // merge the sorted contigs, reading the k-mers back from the packed sequence (ties go to the first contig, so equal
+  // k-mers stay ordered by position)
+  auto& entries = storage->entries;
+  auto total = size_t{0};
+  for (const auto& contig_entries : per_contig)
+    total += contig_entries.size();
+  entries.reserve(total);
+  auto next_entries = vector<size_t>(n_contigs, 0);
+  auto first_keys = vector<uint64_t>{};
+  for (const auto& contig_entries : per_contig)
+    first_keys.push_back(contig_entries.empty() ? utils::LoserTree::EXHAUSTED : result.canonical_at(contig_entries.front()));  // a canonical k-mer is never all ones
+  auto tree = utils::LoserTree{move(first_keys)};
+  while (!tree.empty()) {
+    const auto contig = tree.winner();
+    const auto& contig_entries = per_contig[contig];
+    entries.push_back(contig_entries[next_entries[contig]]);
+    const auto next = ++next_entries[contig];
+    tree.replace_winner(next == contig_entries.size() ? utils::LoserTree::EXHAUSTED : result.canonical_at(contig_entries[next]));
+  }
+  vector<vector<uint32_t>>{}.swap(per_contig);
+
+  // prefix table: about ENTRIES_PER_BUCKET entries per bucket, so that lookups search only a handful of entries
+  auto prefix_bits = 0u;
+  while (prefix_bits < min(2 * k, MAX_PREFIX_BITS) && (uint64_t{1} << (prefix_bits + 1)) * ENTRIES_PER_BUCKET <= entries.size())
+    ++prefix_bits;
+  auto& buckets = storage->buckets;
+  buckets.assign((size_t{1} << prefix_bits) + 1, 0);
+  for (const auto entry : entries)
+    ++buckets[prefix_of(result.canonical_at(entry), k, prefix_bits) + 1];
+  partial_sum(buckets.begin(), buckets.end(), buckets.begin());
+
+  result.m_prefix_bits = prefix_bits;
+  result.m_n_entries = entries.size();
+  result.m_entries = entries.data();
+  result.m_buckets = buckets.data();
+  result.m_contig_starts = contig_starts.data();
+  result.m_storage = storage;
+  return result;
+}
+
+KmerIndex::KmerIndex(const std::string& filename) :
+  KmerIndex{}
+{
+  auto file_size = uint64_t{0};
+  const auto mapping = utils::memory_map_file(filename, file_size);
+  if (file_size < sizeof(FileHeader))
+    throw HeaderReadException{filename};
+  const auto header = reinterpret_cast<const FileHeader*>(mapping.get());
+  if (memcmp(header->magic, KMER_INDEX_MAGIC, sizeof(header->magic)) != 0 || header->version != KMER_INDEX_VERSION ||
+      header->file_size != file_size || header->k < 1 || header->k > MAX_K || header->prefix_bits > min(2 * header->k, MAX_PREFIX_BITS) ||
+      header->buckets_offset + ((uint64_t{1} << header->prefix_bits) + 1) * sizeof(uint64_t) > file_size ||
+      header->contig_starts_offset + (uint64_t{header->n_contigs} + 1) * sizeof(uint64_t) > file_size ||
+      header->sequence_words == 0 || header->sequence_offset + header->sequence_words * sizeof(uint64_t) > file_size ||
+      header->entries_offset + header->n_entries * sizeof(uint32_t) > file_size || header->names_offset + header->names_size > file_size)
+    throw HeaderReadException{filename};
+  m_storage = mapping;
+  m_entries = reinterpret_cast<const uint32_t*>(mapping.get() + header->entries_offset);
+  m_buckets = reinterpret_cast<const uint64_t*>(mapping.get() + header->buckets_offset);
+  m_sequence = reinterpret_cast<const uint64_t*>(mapping.get() + header->sequence_offset);
+  m_contig_starts = reinterpret_cast<const uint64_t*>(mapping.get() + header->contig_starts_offset);
+  if (m_contig_starts[header->n_contigs] > (header->sequence_words - 1) * BASES_PER_WORD)
+    throw HeaderReadException{filename};
+  m_n_entries = header->n_entries;
+  m_k = header->k;
+  m_prefix_bits = header->prefix_bits;
+  const auto names = reinterpret_cast<const char*>(mapping.get() + header->names_offset);
+  for (auto name = names; name < names + header->names_size; name += m_contig_names.back().size() + 1)
+    m_contig_names.emplace_back(name, strnlen(name, names + header->names_size - name));
+  if (m_contig_names.size() != header->n_contigs)
+    throw HeaderReadException{filename};
+}
+
+/**
+ * @brief writes a block of data and pads the output to the next 8-byte boundary
+ * @return the offset where the data was written
+ */
+static uint64_t write_aligned(ofstream& output, const void* data, const uint64_t size) {
+  const auto offset = static_cast<uint64_t>(output.tellp());
+  output.write(static_cast<const char*>(data), size);
+  const char padding[8] = {};
+  output.write(padding, (8 - size % 8) % 8);
+  return offset;
+}
+
+void KmerIndex::save(const std::string& filename) const {
+  ofstream output {filename, ios::binary | ios::trunc};
+  if (!output.good())
+    throw FileOpenException{filename};
+  auto header = FileHeader{};
+  write_aligned(output, &header, sizeof(header));  // placeholder, rewritten at the end
+  auto names = string{};
+  for (const auto& name : m_contig_names)
+    names.append(name).push_back('\0');
+  memcpy(header.magic, KMER_INDEX_MAGIC, sizeof(header.magic));
+  header.version = KMER_INDEX_VERSION;
+  header.k = m_k;
+  header.prefix_bits = m_prefix_bits;
+  header.n_contigs = m_contig_names.size();
+  header.n_entries = m_n_entries;
+  header.sequence_words = m_contig_starts[m_contig_names.size()] / BASES_PER_WORD + 1;
+  header.buckets_offset = write_aligned(output, m_buckets, ((uint64_t{1} << m_prefix_bits) + 1) * sizeof(uint64_t));
+  header.contig_starts_offset = write_aligned(output, m_contig_starts, (m_contig_names.size() + 1) * sizeof(uint64_t));
+  header.sequence_offset = write_aligned(output, m_sequence, header.sequence_words * sizeof(uint64_t));
+  header.entries_offset = write_aligned(output, m_entries, m_n_entries * sizeof(uint32_t));
+  header.names_offset = write_aligned(output, names.data(), names.size());
+  header.names_size = names.size();
+  header.file_size = output.tellp();
+  output.seekp(0);
+  output.write(reinterpret_cast<const char*>(&header), sizeof(header));
+  if (!output.good())
+    throw FileOpenException{filename};
+}
+
+vector<KmerHit> KmerIndex::lookup(const std::string& kmer) const {
+  auto result = vector<KmerHit>{};
+  if (kmer.size() != m_k)
+    return result;
+  auto found = false;
+  for_each_kmer(kmer, m_k, [&](const uint64_t forward, const uint64_t reverse, const uint32_t) {
+    found = true;
+    const auto range = find(min(forward, reverse));
+    result.reserve((range.second - range.first) * (forward == reverse ? 2 : 1));
+    for (auto entry = range.first; entry != range.second; ++entry) {
+      const auto contig = contig_of(*entry);
+      const auto position = static_cast<uint32_t>(*entry - m_contig_starts[contig] + 1);
+      result.push_back(KmerHit{contig, position, kmer_at(*entry) != forward});
+      if (forward == reverse)  // palindromes match both strands
+        result.push_back(KmerHit{contig, position, true});
+    }
+  });
+  return found ? result : vector<KmerHit>{};
+}
+
+uint32_t KmerIndex::count(const std::string& kmer) const {
+  auto result = 0u;
+  if (kmer.size() == m_k) {
+    for_each_kmer(kmer, m_k, [&](const uint64_t forward, const uint64_t reverse, const uint32_t) {
+      const auto range = find(min(forward, reverse));
+      result = (range.second - range.first) * (forward == reverse ? 2 : 1);
+    });
+  }
+  return result;
+}
+
+/**
+ * @brief the k-mer starting at a position of the packed sequence, on the forward strand
+ */
+uint64_t KmerIndex::kmer_at(const uint32_t position) const {
+  const auto word = position / BASES_PER_WORD;
+  const auto offset = 2 * (position % BASES_PER_WORD);
+  const auto bases = offset == 0 ? m_sequence[word] : (m_sequence[word] << offset) | (m_sequence[word + 1] >> (64 - offset));
+  return bases >> (64 - 2 * m_k);
+}
+
+uint64_t KmerIndex::canonical_at(const uint32_t position) const {
+  const auto forward = kmer_at(position);
+  return min(forward, reverse_complement(forward, m_k));
+}
+
+uint32_t KmerIndex::contig_of(const uint32_t position) const {
+  return static_cast<uint32_t>(upper_bound(m_contig_starts, m_contig_starts + m_contig_names.size(), uint64_t{position}) - m_contig_starts - 1);
+}
+
+/**
+ * @brief all the entries of a canonical k-mer
+ */
+pair<const uint32_t*, const uint32_t*> KmerIndex::find(const uint64_t canonical) const {
+  if (m_n_entries == 0)
+    return make_pair(m_entries, m_entries);
+  const auto bucket = prefix_of(canonical, m_k, m_prefix_bits);
+  const auto first = m_entries + m_buckets[bucket];
+  const auto last = m_entries + m_buckets[bucket + 1];
+  const auto lower = lower_bound(first, last, canonical, [this](const uint32_t entry, const uint64_t value) { return canonical_at(entry) < value; });
+  const auto upper = upper_bound(lower, last, canonical, [this](const uint64_t value, const uint32_t entry) { return value < canonical_at(entry); });
+  return make_pair(lower, upper);
+}
+
+}  // namespace gamgee
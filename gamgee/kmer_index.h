@@ -0,0 +1,126 @@
+#ifndef gamgee__kmer_index__guard
+#define gamgee__kmer_index__guard
+
+#include "reference_map.h"
+
+#include <string>
+#include <vector>
+#include <memory>
+
+namespace gamgee {
+
+/**
+ * @brief a location where a k-mer occurs in the reference
+ */
+struct KmerHit {
+  uint32_t contig;       ///< index of the contig (see KmerIndex::contig_name)
+  uint32_t position;     ///< one-based position of the first base of the k-mer on the forward strand
+  bool reverse_strand;   ///< whether the k-mer matches the reverse complement of the reference at this position
+
+  bool operator==(const KmerHit& other) const { return contig == other.contig && position == other.position && reverse_strand == other.reverse_strand; }
+  bool operator!=(const KmerHit& other) const { return !(*this == other); }
+};
+
+/**
+ * @brief Index of every k-mer (k <= 32) of a reference genome, for fast seed and probe uniqueness lookups.
+ *
+ * K-mers are stored in canonical form (the smaller of the k-mer and its reverse complement), so a
+ * single lookup finds the occurrences on both strands. K-mers with bases other than A, C, G or T are
+ * not indexed. Lookups are case insensitive.
+ *
+ * The index is an array of 32-bit positions in the concatenated contigs, sorted by the k-mer found
+ * there, with a small prefix table to narrow the search. The k-mers and their strands are not stored
+ * but read back from a copy of the reference packed at 2 bits per base, and the contig of a position
+ * from a table of contig offsets. This takes a little under 5 bytes per base of reference (4 per
+ * indexed k-mer, 1/4 for the packed sequence and at most 1/2 for the prefix table), about 14GB for
+ * GRCh38. The arrays can be written to disk as is and memory mapped back (read-only, shared across
+ * processes through the page cache) without any parsing.
+ *
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ * KmerIndex::build(ReferenceMap{"hg38.fa"}, 24, 16).save("hg38.k24.gki");  // one time
+ * ...
+ * const auto index = KmerIndex{"hg38.k24.gki"};
+ * for (const auto& hit : index.lookup(probe.substr(0, index.k())))
+ *   cout << index.contig_name(hit.contig) << ":" << hit.position << (hit.reverse_strand ? "-" : "+") << endl;
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ *
+ * @note the file is written in the byte order of the machine that creates it (little endian on x86)
+ * @note positions are 32-bit, so the reference can have at most 2^32 bases (each contig padded to a multiple of 32)
+ */
+class KmerIndex {
+ public:
+  static constexpr uint32_t MAX_K = 32;  ///< @brief largest supported k-mer size (2 bits per base in 64 bits)
+
+  /**
+   * @brief indexes all k-mers of a reference
+   * @param reference the reference genome (contigs are numbered in lexicographical order of their names)
+   * @param k the size of the k-mers (1 to MAX_K)
+   * @param n_threads number of threads used to index the contigs in parallel
+   * @exception throws std::invalid_argument if k is out of range or the reference is too large
+   * @exception an exception raised while indexing a contig (e.g. std::bad_alloc) is rethrown in the calling thread once all threads are done
+   * @note each thread sorts the k-mers of one contig at a time, taking 16 bytes per base of that contig
+   */
+  static KmerIndex build(const ReferenceMap& reference, const uint32_t k, const uint32_t n_threads = 1);
+
+  /**
+   * @brief memory maps an index written by KmerIndex::save
+   * @exception throws FileOpenException if the file cannot be opened or mapped
+   * @exception throws HeaderReadException if the file is not a valid k-mer index
+   */
+  explicit KmerIndex(const std::string& filename);
+
+  /**
+   * @brief copies share the same (immutable) index
+   */
+  KmerIndex(const KmerIndex&) = default;
+  KmerIndex& operator=(const KmerIndex&) = default;
+  KmerIndex(KmerIndex&&) = default;
+  KmerIndex& operator=(KmerIndex&&) = default;
+
+  /**
+   * @brief writes the index to disk so it can be memory mapped later
+   * @exception throws FileOpenException if the file cannot be written
+   */
+  void save(const std::string& filename) const;
+
+  /**
+   * @brief all the locations of a k-mer in the reference, on both strands
+   * @param kmer a sequence of exactly k() bases
+   * @return the hits sorted by contig and position (empty if the k-mer has the wrong size or bases other than A, C, G or T)
+   */
+  std::vector<KmerHit> lookup(const std::string& kmer) const;
+
+  /**
+   * @brief number of locations of a k-mer in the reference, on both strands (same as lookup(kmer).size() without building the hits)
+   */
+  uint32_t count(const std::string& kmer) const;
+
+  uint32_t k() const { return m_k; }                                                            ///< @brief size of the indexed k-mers
+  uint64_t size() const { return m_n_entries; }                                                 ///< @brief number of indexed k-mer occurrences
+  uint32_t n_contigs() const { return m_contig_names.size(); }                                  ///< @brief number of contigs in the indexed reference
+  const std::string& contig_name(const uint32_t contig) const { return m_contig_names[contig]; } ///< @brief name of a contig referenced by a KmerHit
+
+ private:
+  struct FileHeader;
+  struct Storage;
+
+  std::shared_ptr<const void> m_storage;       ///< owns the index memory (either a memory mapping or the arrays built in memory)
+  const uint32_t* m_entries;                   ///< zero-based positions of the k-mer occurrences in the packed sequence, sorted by canonical k-mer then position (inside m_storage)
+  const uint64_t* m_buckets;                   ///< m_buckets[p] is the first entry whose k-mer starts with the prefix p (inside m_storage)
+  const uint64_t* m_sequence;                  ///< the contigs at 2 bits per base, 32 bases per word from the most significant bits, followed by a padding word (inside m_storage)
+  const uint64_t* m_contig_starts;             ///< position of the first base of each contig in the packed sequence, then its end (inside m_storage)
+  uint64_t m_n_entries;                        ///< number of entries
+  uint32_t m_k;                                ///< k-mer size
+  uint32_t m_prefix_bits;                      ///< number of high bits of the k-mers used to index m_buckets
+  std::vector<std::string> m_contig_names;     ///< contig names, indexed by contig number
+
+  KmerIndex();
+  uint64_t kmer_at(const uint32_t position) const;
+  uint64_t canonical_at(const uint32_t position) const;
+  uint32_t contig_of(const uint32_t position) const;
+  std::pair<const uint32_t*, const uint32_t*> find(const uint64_t canonical) const;
+};
+
+}  // namespace gamgee
+
+#endif /* gamgee__kmer_index__guard */
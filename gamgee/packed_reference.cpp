@@ -0,0 +1,246 @@
+#include "packed_reference.h"
+
+#include "exceptions.h"
+#include "fastq_reader.h"
+#include "interval.h"
+#include "utils/file_utils.h"
+#include "utils/nucleotide_kernels.h"
+
+#include <string>
+#include <vector>
+#include <fstream>
+#include <algorithm>
+#include <cstring>
+
+using namespace std;
+
+namespace gamgee {
+
+/******************************************************************************
+ * File layout (all offsets are in bytes from the start of the file, all sections are 8-byte aligned)
+ *
+ *   FileHeader
+ *   for each contig: packed bases | BaseRun array | MaskRun array
+ *   contig names (concatenated, not null terminated)
+ *   ContigEntry array (the contig table)
+ ******************************************************************************/
+
+const char PACKED_REFERENCE_MAGIC[8] = {'G', 'A', 'M', 'G', 'E', 'E', 'P', 'R'};
+const uint32_t PACKED_REFERENCE_VERSION = 1;
+
+struct PackedReference::FileHeader {
+  char magic[8];            ///< always PACKED_REFERENCE_MAGIC
+  uint32_t version;         ///< format version
+  uint32_t n_contigs;       ///< number of entries in the contig table
+  uint64_t contigs_offset;  ///< offset of the contig table
+  uint64_t file_size;       ///< total size of the file (detects truncated files)
+};
+
+struct PackedReference::ContigEntry {
+  uint64_t name_offset;      ///< offset of the contig name
+  uint64_t bases_offset;     ///< offset of the 2-bit packed bases (see utils::pack_bases_2bit)
+  uint64_t base_runs_offset; ///< offset of the runs of bases that are not A, C, G or T
+  uint64_t mask_runs_offset; ///< offset of the runs of soft-masked (lower case) bases
+  uint32_t name_length;      ///< number of characters in the contig name
+  uint32_t length;           ///< number of bases in the contig
+  uint32_t n_base_runs;      ///< number of entries in the base runs
+  uint32_t n_mask_runs;      ///< number of entries in the mask runs
+};
+
+struct PackedReference::BaseRun {
+  uint32_t start;   ///< zero-based start of the run
+  uint32_t length;  ///< number of bases in the run
+  char base;        ///< the (upper case) base repeated throughout the run
+  char padding[3];
+};
+
+struct PackedReference::MaskRun {
+  uint32_t start;   ///< zero-based start of the run
+  uint32_t length;  ///< number of bases in the run
+};
+
+/**
+ * @brief writes a block of data and pads the output to the next 8-byte boundary
+ * @return the offset where the data was written
+ */
+static uint64_t write_aligned(ofstream& output, const void* data, const uint64_t size) {
+  const auto offset = static_cast<uint64_t>(output.tellp());
+  output.write(static_cast<const char*>(data), size);
+  const char padding[8] = {};
+  output.write(padding, (8 - size % 8) % 8);
+  return offset;
+}
+
+void PackedReference::build(const std::string& fasta_filename, const std::string& output_filename) {
+  auto reader = FastqReader{fasta_filename};
+  ofstream output {output_filename, ios::binary | ios::trunc};
+  if (!output.good())
+    throw FileOpenException{output_filename};
+  auto header = FileHeader{};
+  write_aligned(output, &header, sizeof(header));  // placeholder, rewritten at the end
+
+  auto entries = vector<ContigEntry>{};
+  auto names = string{};
+  auto packed = vector<uint8_t>{};
+  auto base_runs = vector<BaseRun>{};
+  auto mask_runs = vector<MaskRun>{};
+  for (const auto& record : reader) {
+    const auto sequence = record.sequence();
+    const auto name = record.name();
+    auto entry = ContigEntry{};
+    entry.name_offset = names.size();  // relative to the names section until it is written
+    entry.name_length = name.size();
+    entry.length = sequence.size();
+    names += name;
+
+    packed.assign((sequence.size() + 3) / 4, 0);
+    utils::pack_bases_2bit(sequence.data(), sequence.size(), packed.data());
+    base_runs.clear();
+    mask_runs.clear();
+    for (auto i = 0u; i != sequence.size(); ++i) {
+      const auto base = sequence[i];
+      const auto is_lower = base >= 'a' && base <= 'z';
+      const auto upper = is_lower ? char(base - 0x20) : base;
+      if (is_lower) {
+        if (!mask_runs.empty() && mask_runs.back().start + mask_runs.back().length == i)
+          ++mask_runs.back().length;
+        else
+          mask_runs.push_back(MaskRun{i, 1});
+      }
+      if (upper != 'A' && upper != 'C' && upper != 'G' && upper != 'T') {
+        if (!base_runs.empty() && base_runs.back().start + base_runs.back().length == i && base_runs.back().base == upper)
+          ++base_runs.back().length;
+        else
+          base_runs.push_back(BaseRun{i, 1, upper, {}});
+      }
+    }
+    entry.bases_offset = write_aligned(output, packed.data(), packed.size());
+    entry.base_runs_offset = write_aligned(output, base_runs.data(), base_runs.size() * sizeof(BaseRun));
+    entry.mask_runs_offset = write_aligned(output, mask_runs.data(), mask_runs.size() * sizeof(MaskRun));
+    entry.n_base_runs = base_runs.size();
+    entry.n_mask_runs = mask_runs.size();
+    entries.push_back(entry);
+  }
+
+  const auto names_offset = write_aligned(output, names.data(), names.size());
+  for (auto& entry : entries)
+    entry.name_offset += names_offset;
+  memcpy(header.magic, PACKED_REFERENCE_MAGIC, sizeof(header.magic));
+  header.version = PACKED_REFERENCE_VERSION;
+  header.n_contigs = entries.size();
+  header.contigs_offset = write_aligned(output, entries.data(), entries.size() * sizeof(ContigEntry));
+  header.file_size = output.tellp();
+  output.seekp(0);
+  output.write(reinterpret_cast<const char*>(&header), sizeof(header));
+  if (!output.good())
+    throw FileOpenException{output_filename};
+}
+
+PackedReference::PackedReference(const std::string& filename) :
+  m_mapping {},
+  m_contigs {nullptr},
+  m_n_contigs {0},
+  m_contig_index {}
+{
+  auto file_size = uint64_t{0};
+  m_mapping = utils::memory_map_file(filename, file_size);
+  if (file_size < sizeof(FileHeader))
+    throw HeaderReadException{filename};
+  const auto header = reinterpret_cast<const FileHeader*>(m_mapping.get());
+  if (memcmp(header->magic, PACKED_REFERENCE_MAGIC, sizeof(header->magic)) != 0 || header->version != PACKED_REFERENCE_VERSION ||
+      header->file_size != file_size || header->contigs_offset + header->n_contigs * sizeof(ContigEntry) > file_size)
+    throw HeaderReadException{filename};
+  m_contigs = reinterpret_cast<const ContigEntry*>(m_mapping.get() + header->contigs_offset);
+  m_n_contigs = header->n_contigs;
+  m_contig_index.reserve(m_n_contigs);
+  for (auto i = 0u; i != m_n_contigs; ++i)
+    m_contig_index.emplace(contig_name(m_contigs[i]), i);
+}
+
+string PackedReference::get_sequence(const Interval& interval, const bool reverse_strand) const {
+  const auto& entry = contig(interval.chr());
+  if (interval.start() < 1 || interval.start() > entry.length + 1)
+    throw ChromosomeSizeException{interval.chr(), entry.length, static_cast<int>(interval.start())};
+  const auto stop = min(interval.stop(), entry.length);
+  auto result = string(stop >= interval.start() ? stop - interval.start() + 1 : 0, 'N');
+  unpack(entry, interval.start() - 1, result.size(), &result[0]);
+  if (reverse_strand)
+    utils::complement_bases(result.data(), &result[0], result.size());
+  return result;
+}
+
+char PackedReference::ref_base(const std::string& chromosome, const uint32_t one_based_location, const bool reverse_strand) const {
+  const auto& entry = contig(chromosome);
+  if (one_based_location < 1 || one_based_location > entry.length)
+    throw ChromosomeSizeException{chromosome, entry.length, static_cast<int>(one_based_location)};
+  auto base = 'N';
+  unpack(entry, one_based_location - 1, 1, &base);
+  if (reverse_strand)
+    utils::complement_bases(&base, &base, 1);
+  return base;
+}
+
+uint32_t PackedReference::contig_length(const std::string& chromosome) const {
+  return contig(chromosome).length;
+}
+
+vector<string> PackedReference::contigs() const {
+  auto result = vector<string>{};
+  result.reserve(m_n_contigs);
+  for (auto i = 0u; i != m_n_contigs; ++i)
+    result.push_back(contig_name(m_contigs[i]));
+  return result;
+}
+
+const PackedReference::ContigEntry& PackedReference::contig(const std::string& chromosome) const {
+  const auto it = m_contig_index.find(chromosome);
+  if (it == m_contig_index.end())
+    throw ChromosomeNotFoundException{chromosome};
+  return m_contigs[it->second];
+}
+
+string PackedReference::contig_name(const ContigEntry& entry) const {
+  return string{reinterpret_cast<const char*>(m_mapping.get() + entry.name_offset), entry.name_length};
+}
+
+/**
+ * @brief decodes size bases starting at the zero-based position start directly from the mapping
+ */
+void PackedReference::unpack(const ContigEntry& entry, const uint32_t start, const uint32_t size, char* out) const {
+  const auto packed = m_mapping.get() + entry.bases_offset + start / 4;
+  const auto skip = start % 4;
+  if (skip == 0)
+    utils::unpack_bases_2bit(packed, size, out);
+  else {  // the first byte is only partially used
+    const auto head = min(4 - skip, size);
+    auto first_bases = string(4, 'A');
+    utils::unpack_bases_2bit(packed, 4, &first_bases[0]);
+    copy_n(first_bases.begin() + skip, head, out);
+    utils::unpack_bases_2bit(packed + 1, size - head, out + head);
+  }
+
+  const auto stop = start + size;
+  const auto base_runs = reinterpret_cast<const BaseRun*>(m_mapping.get() + entry.base_runs_offset);
+  auto base_run = upper_bound(base_runs, base_runs + entry.n_base_runs, start, [](const uint32_t position, const BaseRun& run) { return position < run.start; });
+  if (base_run != base_runs)
+    --base_run;
+  for (; base_run != base_runs + entry.n_base_runs && base_run->start < stop; ++base_run) {
+    const auto run_start = max(base_run->start, start);
+    const auto run_stop = min(base_run->start + base_run->length, stop);
+    if (run_start < run_stop)
+      fill(out + run_start - start, out + run_stop - start, base_run->base);
+  }
+
+  const auto mask_runs = reinterpret_cast<const MaskRun*>(m_mapping.get() + entry.mask_runs_offset);
+  auto mask_run = upper_bound(mask_runs, mask_runs + entry.n_mask_runs, start, [](const uint32_t position, const MaskRun& run) { return position < run.start; });
+  if (mask_run != mask_runs)
+    --mask_run;
+  for (; mask_run != mask_runs + entry.n_mask_runs && mask_run->start < stop; ++mask_run) {
+    const auto run_start = max(mask_run->start, start);
+    const auto run_stop = min(mask_run->start + mask_run->length, stop);
+    if (run_start < run_stop)
+      utils::to_lower_bases(out + run_start - start, run_stop - run_start);
+  }
+}
+
+}  // namespace gamgee
@@ -0,0 +1,106 @@
+#ifndef gamgee__packed_reference__guard
+#define gamgee__packed_reference__guard
+
+#include "interval.h"
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <unordered_map>
+
+namespace gamgee {
+
+/**
+ * @brief Read-only access to a reference genome stored in gamgee's packed binary reference format.
+ *
+ * The packed format is created once from a FastA file (see PackedReference::build) and holds a contig
+ * table, the bases packed in 2 bits each (4x smaller than the FastA) and two run lists per contig: one
+ * for the bases that are not A, C, G or T (N's and other IUPAC codes) and one for the soft-masked
+ * (lower case) stretches. Together they reproduce the FastA bases exactly.
+ *
+ * The file is memory mapped read-only, so opening it costs next to nothing and every process on a
+ * machine that opens the same file shares a single copy of it through the page cache. All lookups
+ * read directly from the mapping.
+ *
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ * PackedReference::build("hg38.fa", "hg38.gpr");  // one time conversion
+ * ...
+ * const auto reference = PackedReference{"hg38.gpr"};
+ * const auto bases = reference.get_sequence(Interval{"chr1", 1000000, 1000100});
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ *
+ * @note the file is written in the byte order of the machine that creates it (little endian on x86)
+ */
+class PackedReference {
+ public:
+
+  /**
+   * @brief converts a FastA (or FastQ) reference into the packed reference format
+   * @param fasta_filename the reference genome FastA file
+   * @param output_filename the packed reference file to create
+   * @exception throws FileOpenException if either file cannot be opened
+   */
+  static void build(const std::string& fasta_filename, const std::string& output_filename);
+
+  /**
+   * @brief memory maps a packed reference file
+   * @param filename a file created by PackedReference::build
+   * @exception throws FileOpenException if the file cannot be opened or mapped
+   * @exception throws HeaderReadException if the file is not a valid packed reference
+   */
+  explicit PackedReference(const std::string& filename);
+
+  /**
+   * @brief copies share the same (read-only) memory mapping
+   */
+  PackedReference(const PackedReference&) = default;
+  PackedReference& operator=(const PackedReference&) = default;
+  PackedReference(PackedReference&&) = default;
+  PackedReference& operator=(PackedReference&&) = default;
+
+  /**
+    * @brief locates the DNA sequence for a given Interval
+    *
+    * Intervals extending beyond the end of the contig are truncated at the end of the contig (same
+    * behavior as ReferenceMap::get_sequence).
+    *
+    * @exception throws ChromosomeNotFoundException if the contig is not in the reference
+    * @exception throws ChromosomeSizeException if the interval starts outside of the contig
+    * @return DNA sequence for the requested Interval
+    */
+  std::string get_sequence(const Interval& interval,         ///< location in the genome
+                           const bool reverse_strand = false ///< which strand, releative to the reference genome, to produce the sequence for
+      ) const;
+
+  /**
+   * @brief return the reference base character at the desired location
+   * @param chromosome the chromosome of the desired base
+   * @param one_based_location the one-based genomic location of the base
+   * @param reverse_strand whether to return the base on the reverse strand (the complement)
+   */
+  char ref_base(const std::string& chromosome, const uint32_t one_based_location, const bool reverse_strand = false) const;
+
+  bool has_contig(const std::string& chromosome) const { return m_contig_index.count(chromosome) > 0; } ///< @brief whether the reference has a contig with this name
+  uint32_t contig_length(const std::string& chromosome) const;                                          ///< @brief length of a contig (throws ChromosomeNotFoundException if not in the reference)
+  uint32_t n_contigs() const { return m_n_contigs; }                                                     ///< @brief number of contigs in the reference
+  std::vector<std::string> contigs() const;                                                              ///< @brief names of all contigs in the order of the original FastA file
+
+ private:
+  struct FileHeader;
+  struct ContigEntry;
+  struct BaseRun;
+  struct MaskRun;
+
+  std::shared_ptr<const uint8_t> m_mapping;                   ///< the read-only memory mapping of the whole file
+  const ContigEntry* m_contigs;                               ///< the contig table (inside the mapping)
+  uint32_t m_n_contigs;                                       ///< number of entries in the contig table
+  std::unordered_map<std::string, uint32_t> m_contig_index;   ///< contig name -> position in the contig table
+
+  const ContigEntry& contig(const std::string& chromosome) const;
+  std::string contig_name(const ContigEntry& entry) const;
+  void unpack(const ContigEntry& entry, const uint32_t start, const uint32_t size, char* out) const;
+};
+
+}  // namespace gamgee
+
+#endif /* gamgee__packed_reference__guard */
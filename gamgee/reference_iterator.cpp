@@ -3,20 +3,100 @@
 #include "exceptions.h"
 #include "fastq_iterator.h"
 
+#include <fstream>
+#include <algorithm>
+#include <cstdlib>
+
+using namespace std;
+
 namespace gamgee {
 
+constexpr uint32_t ReferenceIterator::DEFAULT_WINDOW_SIZE;
+
+ReferenceIterator::ReferenceIterator(const std::string& filename, const uint32_t window_size) :
+  m_filename {filename},
+  m_index {load_index(filename)},
+  m_window_size {max(window_size, 1u)},
+  m_window_chromosome {},
+  m_window_start {0},
+  m_window {},
+  m_iterator {}
+{
+  if (!m_index)
+    m_iterator = FastqReader{filename}.begin();
+}
+
 const char ReferenceIterator::ref_base(const std::string& chromosome, const int one_based_location) {
-  while (m_iterator != FastqIterator{} && chromosome != m_sequence.name())
-    m_sequence = ++m_iterator;
+  if (chromosome != m_window_chromosome || one_based_location <= static_cast<int>(m_window_start) ||
+      one_based_location > static_cast<int>(m_window_start + m_window.size()))
+    load_window(chromosome, one_based_location);
+  return m_window[one_based_location - 1 - m_window_start];
+}
 
-  if (m_iterator == FastqIterator{})
-    throw new ChromosomeNotFoundException{chromosome};
+/**
+ * @brief replaces the window by one that contains the requested location
+ *
+ * The new window starts a little before the requested location so that callers walking forward with
+ * small steps backward (e.g. overlapping reads) don't have to reload it.
+ */
+void ReferenceIterator::load_window(const std::string& chromosome, const int one_based_location) {
+  if (!m_index) {
+    stream_to(chromosome);
+    if (one_based_location < 1 || one_based_location > static_cast<int>(m_window.size()))
+      throw ChromosomeSizeException{chromosome, m_window.size(), one_based_location};
+    return;
+  }
+  const auto length = faidx_seq_len(m_index.get(), chromosome.c_str());
+  if (length < 0)
+    throw ChromosomeNotFoundException{chromosome};
+  if (one_based_location < 1 || one_based_location > length)
+    throw ChromosomeSizeException{chromosome, static_cast<size_t>(length), one_based_location};
+  const auto location = static_cast<uint32_t>(one_based_location - 1);
+  const auto start = location - min(location, m_window_size / 8);
+  const auto stop = min(start + m_window_size, static_cast<uint32_t>(length)) - 1;
+  auto fetched_length = 0;
+  auto fetched = faidx_fetch_seq(m_index.get(), chromosome.c_str(), start, stop, &fetched_length);
+  // the chromosome is in the index, so a failed or short fetch means the file cannot be read (e.g. it was truncated)
+  if (fetched == nullptr || fetched_length != static_cast<int>(stop - start + 1)) {
+    free(fetched);
+    throw FileReadException{m_filename};
+  }
+  m_window.assign(fetched, fetched_length);
+  free(fetched);
+  m_window_chromosome = chromosome;
+  m_window_start = start;
+}
 
-  if (one_based_location > static_cast<const int>(m_sequence.sequence().size()))
-    throw new ChromosomeSizeException{chromosome, m_sequence.sequence().size(), one_based_location};
+/**
+ * @brief streams (forward, restarting from the top of the file if necessary) to the requested chromosome and holds all of it as the window
+ */
+void ReferenceIterator::stream_to(const std::string& chromosome) {
+  if (chromosome == m_window_chromosome)
+    return;
+  auto restarted = false;
+  while (m_iterator == FastqIterator{} || (*m_iterator).name() != chromosome) {
+    if (m_iterator == FastqIterator{}) {
+      if (restarted)
+        throw ChromosomeNotFoundException{chromosome};
+      m_iterator = FastqReader{m_filename}.begin();
+      restarted = true;
+    }
+    else
+      ++m_iterator;
+  }
+  m_window = (*m_iterator).sequence();
+  m_window_chromosome = chromosome;
+  m_window_start = 0;
+}
 
-  return m_sequence.sequence()[one_based_location-1];
+/**
+ * @brief loads the .fai index of the reference, building it if necessary
+ * @return the index or nullptr if the reference cannot be indexed
+ */
+faidx_t* ReferenceIterator::load_index(const std::string& filename) {
+  if (!ifstream{filename + ".fai"}.good() && fai_build(filename.c_str()) != 0)
+    return nullptr;
+  return fai_load(filename.c_str());
 }
 
 } // namespace gamgee
-
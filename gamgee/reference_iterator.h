@@ -4,30 +4,66 @@
 #include "fastq_iterator.h"
 #include "fastq_reader.h"
 
+#include "utils/hts_memory.h"
+
+#include "htslib/faidx.h"
+
+#include <string>
+#include <memory>
+
 namespace gamgee {
 
 /**
  * @brief Utility class to access reference bases in a FastA-formatted reference genome
  *
- * @warn the chromosomes in this reference must be accessed in order, or an exception will be thrown
+ * Only a bounded window of the current chromosome is kept in memory. The window slides forward (or
+ * backward) as bases outside of it are requested, so streaming callers have a small, fixed memory
+ * footprint no matter how large the chromosomes are.
+ *
+ * The window is read through the .fai index of the reference (built next to the FastA file if it
+ * doesn't exist yet), so chromosomes can be accessed in any order without re-reading the file. If the
+ * reference cannot be indexed (e.g. lines of irregular length) the iterator falls back to streaming
+ * through the file and holding the whole current chromosome in memory. In that mode going back to an
+ * earlier chromosome restarts the stream from the beginning of the file.
  */
 class ReferenceIterator {
  public:
-  ReferenceIterator(const std::string& filename) :
-    m_iterator {FastqReader{filename}.begin()},
-    m_sequence {*m_iterator}
-  {}
+  static constexpr uint32_t DEFAULT_WINDOW_SIZE = 1024*1024; ///< @brief default number of bases held in memory
+
+  /**
+   * @brief opens a FastA reference (building its .fai index if necessary)
+   * @param filename the reference genome FastA file
+   * @param window_size number of bases of the current chromosome held in memory
+   */
+  explicit ReferenceIterator(const std::string& filename, const uint32_t window_size = DEFAULT_WINDOW_SIZE);
+
+  ReferenceIterator(ReferenceIterator&&) = default;
+  ReferenceIterator& operator=(ReferenceIterator&&) = default;
+  ReferenceIterator(const ReferenceIterator&) = delete;
+  ReferenceIterator& operator=(const ReferenceIterator&) = delete;
 
   /**
    * @brief return the reference base character at the desired location
    * @param chromosome the chromosome of the desired base
    * @param one_based_location the one-based genomic location of the base
+   * @exception throws ChromosomeNotFoundException if the chromosome is not in the reference
+   * @exception throws ChromosomeSizeException if the location is outside of the chromosome
+   * @exception throws FileReadException if the indexed file cannot be read (e.g. it was truncated after indexing)
    */
   const char ref_base(const std::string& chromosome, const int one_based_location);
 
  private:
-  FastqIterator m_iterator;     ///< @brief the current state of the iterator through the FastA input file
-  Fastq& m_sequence;            ///< @brief a reference to the iterator's current sequence
+  std::string m_filename;                                  ///< @brief the FastA input file
+  std::unique_ptr<faidx_t, utils::FaidxDeleter> m_index;   ///< @brief htslib's handle to the indexed FastA (null when streaming)
+  uint32_t m_window_size;                                  ///< @brief maximum number of bases held in the window
+  std::string m_window_chromosome;                         ///< @brief the chromosome the current window belongs to
+  uint32_t m_window_start;                                 ///< @brief zero-based start of the current window in its chromosome
+  std::string m_window;                                    ///< @brief the bases of the current window
+  FastqIterator m_iterator;                                ///< @brief the current state of the stream through the FastA input file (only used when the file is not indexed)
+
+  void load_window(const std::string& chromosome, const int one_based_location);
+  void stream_to(const std::string& chromosome);
+  static faidx_t* load_index(const std::string& filename);
 };
 
 } // namespace gamgee
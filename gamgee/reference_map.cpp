@@ -2,7 +2,7 @@
 
 #include "fastq_reader.h"
 #include "interval.h"
-#include "utils/utils.h"
+#include "utils/nucleotide_kernels.h"
 
 #include <unordered_map>
 #include <string>
@@ -25,7 +25,9 @@ void ReferenceMap::read_fastq(FastqReader& reader) {
 string ReferenceMap::get_sequence(const Interval& interval, const bool reverse_strand) const {
   const auto& seq = this->at(interval.chr());
   auto result = seq.substr(interval.start()-1, interval.size());
-  return reverse_strand ? utils::complement(result) : result;
+  if (reverse_strand)
+    utils::complement_bases(result.data(), &result[0], result.size());
+  return result;
 }
 
 }  // namespace gamgee
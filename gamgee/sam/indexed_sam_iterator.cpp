@@ -2,6 +2,10 @@
 #include "sam.h"
 
 #include "../utils/hts_memory.h"
+#include "../utils/bgzf_utils.h"
+
+#include <algorithm>
+#include <limits>
 
 using namespace std;
 
@@ -22,7 +26,24 @@ IndexedSamIterator::IndexedSamIterator(const std::shared_ptr<htsFile>& sam_file_
   m_sam_header_ptr {sam_header_ptr},
   m_interval_list {interval_list},
   m_interval_iterator {m_interval_list.begin()},
-  m_sam_itr_ptr {utils::make_unique_hts_itr(sam_itr_querys(m_sam_index_ptr.get(), m_sam_header_ptr.get(), (*m_interval_iterator).c_str()))},
+  m_contig_interval_list {},
+  m_contig_interval_iterator {},
+  m_sam_itr_ptr {utils::make_unique_hts_itr(query_interval())},
+  m_sam_record_ptr {utils::make_shared_sam(bam_init1())},
+  m_sam_record {m_sam_header_ptr, m_sam_record_ptr} {
+    fetch_next_record();
+}
+
+IndexedSamIterator::IndexedSamIterator(const std::shared_ptr<htsFile>& sam_file_ptr, const std::shared_ptr<hts_idx_t>& sam_index_ptr,
+    const std::shared_ptr<bam_hdr_t>& sam_header_ptr, const std::vector<ContigInterval>& interval_list) :
+  m_sam_file_ptr {sam_file_ptr},
+  m_sam_index_ptr {sam_index_ptr},
+  m_sam_header_ptr {sam_header_ptr},
+  m_interval_list {},
+  m_interval_iterator {},
+  m_contig_interval_list {interval_list},
+  m_contig_interval_iterator {m_contig_interval_list.begin()},
+  m_sam_itr_ptr {utils::make_unique_hts_itr(query_interval())},
   m_sam_record_ptr {utils::make_shared_sam(bam_init1())},
   m_sam_record {m_sam_header_ptr, m_sam_record_ptr} {
     fetch_next_record();
@@ -43,15 +64,66 @@ bool IndexedSamIterator::operator!=(const IndexedSamIterator& rhs) {
 
 void IndexedSamIterator::fetch_next_record() {
   while (sam_itr_next(m_sam_file_ptr.get(), m_sam_itr_ptr.get(), m_sam_record_ptr.get()) < 0) {
-    ++m_interval_iterator;
-    if (m_interval_list.end() == m_interval_iterator) {
+    if (!next_interval()) {
       m_sam_file_ptr = nullptr;
       return;
     }
-    m_sam_itr_ptr.reset(sam_itr_querys(m_sam_index_ptr.get(), m_sam_header_ptr.get(), (*m_interval_iterator).c_str()));
   }
 }
 
+hts_itr_t* IndexedSamIterator::query_interval() const {
+  if (m_contig_interval_list.empty())
+    return sam_itr_querys(m_sam_index_ptr.get(), m_sam_header_ptr.get(), (*m_interval_iterator).c_str());
+  // htslib takes 0-based half-open coordinates
+  const auto& interval = *m_contig_interval_iterator;
+  return sam_itr_queryi(m_sam_index_ptr.get(), static_cast<int>(interval.contig), static_cast<int>(interval.start) - 1,
+      static_cast<int>(min<uint32_t>(interval.stop, numeric_limits<int>::max())));
+}
+
+bool IndexedSamIterator::next_interval() {
+  if (m_contig_interval_list.empty()) {
+    if (++m_interval_iterator == m_interval_list.end())
+      return false;
+  }
+  else if (++m_contig_interval_iterator == m_contig_interval_list.cend())
+    return false;
+  m_sam_itr_ptr.reset(query_interval());
+  return true;
+}
+
+uint64_t IndexedSamIterator::tell() const {
+  return utils::bgzf_position(m_sam_file_ptr.get());
+}
+
+void IndexedSamIterator::seek(const uint64_t offset) {
+  resume(IteratorCheckpoint{offset, interval_number()});
+}
+
+IteratorCheckpoint IndexedSamIterator::checkpoint() const {
+  return IteratorCheckpoint{tell(), interval_number()};
+}
+
+void IndexedSamIterator::resume(const IteratorCheckpoint& checkpoint) {
+  utils::seekable_bgzf(m_sam_file_ptr.get());  // fail before touching the iterator
+  if (checkpoint.interval >= (m_contig_interval_list.empty() ? m_interval_list.size() : m_contig_interval_list.size())) {
+    m_sam_file_ptr = nullptr;
+    return;
+  }
+  if (m_contig_interval_list.empty())
+    m_interval_iterator = m_interval_list.begin() + checkpoint.interval;
+  else
+    m_contig_interval_iterator = m_contig_interval_list.cbegin() + checkpoint.interval;
+  m_sam_itr_ptr.reset(query_interval());
+  utils::reposition_hts_iterator(m_sam_itr_ptr.get(), m_sam_file_ptr.get(), checkpoint.offset);
+  fetch_next_record();
+}
+
+uint32_t IndexedSamIterator::interval_number() const {
+  if (m_contig_interval_list.empty())
+    return m_interval_iterator - m_interval_list.begin();
+  return m_contig_interval_iterator - m_contig_interval_list.cbegin();
+}
+
 const std::string& IndexedSamIterator::current_interval() const{
   return *m_interval_iterator;
 }
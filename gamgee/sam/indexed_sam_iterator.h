@@ -3,6 +3,8 @@
 
 #include "sam.h"
 
+#include "../contig_interval.h"
+#include "../iterator_checkpoint.h"
 #include "../utils/hts_memory.h"
 
 #include "htslib/sam.h"
@@ -34,6 +36,17 @@ class IndexedSamIterator {
     IndexedSamIterator(const std::shared_ptr<htsFile>& sam_file_ptr, const std::shared_ptr<hts_idx_t>& sam_index_ptr,
         const std::shared_ptr<bam_hdr_t>& sam_header_ptr, const std::vector<std::string>& interval_list);
 
+    /**
+     * @brief initializes a new iterator over compact intervals, queried without parsing region strings
+     *
+     * @param sam_file_ptr   pointer to a bam/cram file opened via the sam_open() macro from htslib
+     * @param sam_index_ptr  pointer to a bam/cram file opened via the sam_index_load() macro from htslib
+     * @param sam_header_ptr pointer to a bam/cram file header created with the sam_hdr_read() macro from htslib
+     * @param interval_list  non-empty vector of intervals whose contig ids are the target ids of sam_header_ptr
+     */
+    IndexedSamIterator(const std::shared_ptr<htsFile>& sam_file_ptr, const std::shared_ptr<hts_idx_t>& sam_index_ptr,
+        const std::shared_ptr<bam_hdr_t>& sam_header_ptr, const std::vector<ContigInterval>& interval_list);
+
     /**
      * @brief iterators and readers can be moved
      */
@@ -71,7 +84,22 @@ class IndexedSamIterator {
      */
     Sam& operator++();
 
-    const std::string& current_interval() const;
+    /**
+     * @brief the virtual offset right after the current record
+     * @exception FileSeekException if the file is not a BAM file or the iteration is over
+     */
+    uint64_t tell() const;
+
+    /**
+     * @brief continues the current interval from a virtual offset (e.g. one returned by tell())
+     * @exception FileSeekException if the file is not a BAM file or the offset is not in the file
+     */
+    void seek(const uint64_t offset);
+
+    IteratorCheckpoint checkpoint() const;                  ///< @brief the position of the iterator (interval and offset), to be restored with resume()
+    void resume(const IteratorCheckpoint& checkpoint);      ///< @brief continues after the record that was current when checkpoint was taken (on an iterator over the same file and intervals)
+
+    const std::string& current_interval() const; ///< @brief the interval being iterated @warning only for iterators created with string intervals
 
   private:
     std::shared_ptr<htsFile> m_sam_file_ptr;                ///< pointer to the bam file
@@ -79,11 +107,16 @@ class IndexedSamIterator {
     std::shared_ptr<bam_hdr_t> m_sam_header_ptr;            ///< pointer to the bam header
     std::vector<std::string> m_interval_list;               ///< intervals to iterate
     std::vector<std::string>::iterator m_interval_iterator; ///< temporary interval to hold between sam_itr_querys and serve fetch_next_record
+    std::vector<ContigInterval> m_contig_interval_list;     ///< compact intervals to iterate (used instead of m_interval_list when not empty)
+    std::vector<ContigInterval>::const_iterator m_contig_interval_iterator; ///< compact interval currently being iterated
     std::unique_ptr<hts_itr_t, utils::HtsIteratorDeleter> m_sam_itr_ptr; ///< temporary iterator to hold between sam_itr_querys and serve fetch_next_record
     std::shared_ptr<bam1_t> m_sam_record_ptr;               ///< pointer to the internal structure of the sam record. Useful to only allocate it once.
     Sam m_sam_record;                                       ///< temporary record to hold between fetch (operator++) and serve (operator*)
 
     void fetch_next_record();                               ///< fetches next Sam record into existing htslib memory without making a copy
+    hts_itr_t* query_interval() const;                      ///< creates the htslib iterator for the current interval
+    bool next_interval();                                   ///< moves to the next interval, returning false if there are none left
+    uint32_t interval_number() const;                       ///< position of the current interval in the interval list
 };
 
 }
@@ -3,6 +3,7 @@
 
 #include "indexed_sam_iterator.h"
 
+#include "../contig_interval.h"
 #include "../exceptions.h"
 #include "../utils/hts_memory.h"
 
@@ -33,6 +34,9 @@ namespace gamgee {
  * for (const auto& record : IndexedSingleSamReader{filename, interval_list})
  *   do_something_with_sam(record);
  * ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ *
+ * Intervals can also be given as ContigIntervals with their ContigDictionary, which skips parsing a
+ * region string for every interval.
  */
 template<class ITERATOR>
 class IndexedSamReader {
@@ -48,11 +52,31 @@ class IndexedSamReader {
       m_sam_file_ptr {},
       m_sam_index_ptr {},
       m_sam_header_ptr {},
-      m_interval_list {interval_list}
+      m_interval_list {interval_list},
+      m_contig_interval_list {}
     {
       init_reader(filename);
     }
 
+    /**
+     * @brief reads through all records in a file overlapping compact intervals
+     *
+     * @param filename the name of the bam/cram file
+     * @param interval_list intervals to look for records, in order
+     * @param dictionary the contig dictionary of interval_list (it doesn't need to match the file header:
+     * contigs are matched by name and intervals on contigs missing from the file are skipped)
+     */
+    IndexedSamReader(const std::string& filename, const std::vector<ContigInterval>& interval_list, const ContigDictionary& dictionary) :
+      m_sam_file_ptr {},
+      m_sam_index_ptr {},
+      m_sam_header_ptr {},
+      m_interval_list {},
+      m_contig_interval_list {}
+    {
+      init_reader(filename);
+      init_contig_intervals(interval_list, dictionary);
+    }
+
     /**
      * @brief iterators and readers can be moved
      */
@@ -76,6 +100,8 @@ class IndexedSamReader {
      * @return a ITERATOR ready to start parsing the file
      */
     ITERATOR begin() {
+      if (!m_contig_interval_list.empty())
+        return ITERATOR{m_sam_file_ptr, m_sam_index_ptr, m_sam_header_ptr, m_contig_interval_list};
       if (m_interval_list.empty())
         return ITERATOR{};
       else
@@ -103,6 +129,7 @@ class IndexedSamReader {
     std::shared_ptr<hts_idx_t> m_sam_index_ptr;  ///< pointer to the bam index
     std::shared_ptr<bam_hdr_t> m_sam_header_ptr; ///< pointer to the bam header
     std::vector<std::string> m_interval_list;    ///< intervals to iterate
+    std::vector<ContigInterval> m_contig_interval_list; ///< compact intervals to iterate, with contig ids translated to the target ids of the file
 
     void init_reader(const std::string& filename) {
       auto* file_ptr = sam_open(filename.c_str(), "r");
@@ -123,6 +150,19 @@ class IndexedSamReader {
       }
       m_sam_header_ptr = utils::make_shared_sam_header(header_ptr);
     }
+
+    void init_contig_intervals(const std::vector<ContigInterval>& interval_list, const ContigDictionary& dictionary) {
+      auto target_ids = std::vector<int>{};
+      target_ids.reserve(dictionary.size());
+      for (const auto& contig : dictionary.names())
+        target_ids.push_back(bam_name2id(m_sam_header_ptr.get(), contig.c_str()));
+      m_contig_interval_list.reserve(interval_list.size());
+      for (const auto& interval : interval_list) {
+        const auto target_id = target_ids[interval.contig];
+        if (target_id >= 0)
+          m_contig_interval_list.push_back(ContigInterval{static_cast<uint32_t>(target_id), interval.start, interval.stop});
+      }
+    }
 };
 
 using IndexedSingleSamReader = IndexedSamReader<IndexedSamIterator>;
@@ -1,5 +1,6 @@
 #include "sam_header.h"
 
+#include "../missing.h"
 #include "../utils/hts_memory.h"
 
 using namespace std;
@@ -13,7 +14,8 @@ namespace gamgee {
    *       shared_ptr reference counting
    */
   SamHeader::SamHeader(const std::shared_ptr<bam_hdr_t>& header) :
-    m_header { header }
+    m_header { header },
+    m_sequence_indices {}
   {}
 
   /**
@@ -22,7 +24,8 @@ namespace gamgee {
    * @note the copy will have exclusive ownership over the newly-allocated htslib memory
    */
   SamHeader::SamHeader(const SamHeader& other) :
-    m_header { utils::make_shared_sam_header(utils::sam_header_deep_copy(other.m_header.get())) }
+    m_header { utils::make_shared_sam_header(utils::sam_header_deep_copy(other.m_header.get())) },
+    m_sequence_indices { atomic_load(&other.m_sequence_indices) }
   {}
 
   /**
@@ -34,6 +37,7 @@ namespace gamgee {
     if ( &other == this )  
       return *this;
     m_header = utils::make_shared_sam_header(utils::sam_header_deep_copy(other.m_header.get())); ///< shared_ptr assignment will take care of deallocating old sam record if necessary
+    m_sequence_indices = atomic_load(&other.m_sequence_indices);
     return *this;
   }
 
@@ -42,13 +46,35 @@ namespace gamgee {
    * name is not found.
    */
   uint32_t SamHeader::sequence_length(const std::string& sequence_name) const {
-	  auto c = sequence_name.c_str();
-	  for (int i = 0; i < m_header->n_targets; i++) {
-		  if (strcmp(c,m_header->target_name[i]) == 0) {
-			  return m_header->target_len[i];
-		  }
-	  }
-	  return 0;
+    const auto index = sequence_index(sequence_name);
+    return missing(index) ? 0 : m_header->target_len[index];
+  }
+
+  int32_t SamHeader::sequence_index(const std::string& sequence_name) const {
+    const auto& indices = sequence_indices();
+    const auto found = indices.find(sequence_name);
+    return found == indices.end() ? missing_values::int32 : found->second;
+  }
+
+  /**
+   * @brief the sequence name to index table, built on the first lookup
+   *
+   * htslib's own table (bam_name2id) is built lazily without synchronization, so it can't be used by
+   * concurrent readers of a shared header. Threads racing to build this one keep the first one stored.
+   */
+  const SamHeader::SequenceIndices& SamHeader::sequence_indices() const {
+    auto indices = atomic_load(&m_sequence_indices);
+    if (indices)
+      return *indices;
+    auto built = make_shared<SequenceIndices>();
+    built->reserve(m_header->n_targets);
+    for (auto i = 0; i < m_header->n_targets; ++i)
+      built->emplace(m_header->target_name[i], i);  // keeps the first of duplicate names, as the linear scan did
+    indices = move(built);
+    auto stored = shared_ptr<const SequenceIndices>{};
+    if (!atomic_compare_exchange_strong(&m_sequence_indices, &stored, indices))
+      return *stored;
+    return *indices;
   }
 
   /**
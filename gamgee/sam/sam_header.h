@@ -6,6 +6,7 @@
 
 #include <memory>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 namespace gamgee {
@@ -23,13 +24,19 @@ class SamHeader {
   SamHeader& operator=(SamHeader&& other) = default;                ///< @brief move assignment of a SamHeader. Shared pointers maintain state to all other associated objects correctly.
   uint32_t n_sequences() const {return m_header->n_targets;}        ///< @brief Returns the number of reference sequences in the header
   uint32_t sequence_length(const std::string& sequence_name) const; ///< @brief Returns the length of the given reference sequence as stored in the \@SQ tag in the BAM header.
+  int32_t sequence_index(const std::string& sequence_name) const;   ///< @brief Returns the zero-based index of the given reference sequence, or missing_values::int32 if it is not in the header
   uint32_t sequence_length(const uint32_t sequence_index) const { return m_header->target_len[sequence_index]; }                ///< @brief Returns the length of the given reference sequence as stored in the \@SQ tag in the BAM header.
   std::string sequence_name(const uint32_t sequence_index) const { return std::string(m_header->target_name[sequence_index]); } ///< @brief Returns the sequence name for the sequence with the given zero-based index
   std::vector<ReadGroup> read_groups() const;
 
  private:
+  using SequenceIndices = std::unordered_map<std::string, int32_t>;
+
   std::string header_text() const { return std::string(m_header->text, m_header->l_text); } ///< @brief Returns the text of the SAM header for parsing as an std::string. @note htslib only parses @SQ records, so gamgee is not simply a wrapper for C code.
   std::shared_ptr<bam_hdr_t> m_header;
+  mutable std::shared_ptr<const SequenceIndices> m_sequence_indices;  ///< sequence name to index, built by the first name lookup and shared by copies
+
+  const SequenceIndices& sequence_indices() const;
 
   friend class SamWriter;
   friend class SamBuilder;
@@ -2,6 +2,7 @@
 #include "sam.h"
 
 #include "../utils/hts_memory.h"
+#include "../utils/bgzf_utils.h"
 
 using namespace std;
 
@@ -34,6 +35,23 @@ Sam& SamIterator::operator++() {
 bool SamIterator::operator!=(const SamIterator& rhs) {
   return m_sam_file_ptr != rhs.m_sam_file_ptr;
 }
+
+uint64_t SamIterator::tell() const {
+  return utils::bgzf_position(m_sam_file_ptr.get());
+}
+
+void SamIterator::seek(const uint64_t offset) {
+  utils::bgzf_reposition(m_sam_file_ptr.get(), offset);
+  fetch_next_record();
+}
+
+IteratorCheckpoint SamIterator::checkpoint() const {
+  return IteratorCheckpoint{tell(), 0};
+}
+
+void SamIterator::resume(const IteratorCheckpoint& checkpoint) {
+  seek(checkpoint.offset);
+}
 /**
  * @brief pre-fetches the next sam record
  * @warning we're reusing the existing htslib memory, so users should be aware that all objects from the previous iteration are now stale unless a deep copy has been performed
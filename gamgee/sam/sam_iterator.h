@@ -2,6 +2,7 @@
 #define gamgee__sam_iterator__guard
 
 #include "sam.h"
+#include "../iterator_checkpoint.h"
 
 #include "htslib/sam.h"
 
@@ -65,6 +66,21 @@ class SamIterator {
      */
     Sam& operator++();
 
+    /**
+     * @brief the virtual offset right after the current record, where the next record starts
+     * @exception FileSeekException if the file is not a BAM file or the iteration is over
+     */
+    uint64_t tell() const;
+
+    /**
+     * @brief moves to the record starting at a virtual offset (e.g. one returned by tell()), which becomes the current record
+     * @exception FileSeekException if the file is not a BAM file or the offset is not in the file
+     */
+    void seek(const uint64_t offset);
+
+    IteratorCheckpoint checkpoint() const;                  ///< @brief the position of the iterator, to be restored with resume()
+    void resume(const IteratorCheckpoint& checkpoint);      ///< @brief continues after the record that was current when checkpoint was taken (on an iterator over the same file)
+
   private:
     std::shared_ptr<htsFile> m_sam_file_ptr;     ///< pointer to the sam file
     std::shared_ptr<bam_hdr_t> m_sam_header_ptr; ///< pointer to the sam header
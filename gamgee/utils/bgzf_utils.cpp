@@ -0,0 +1,46 @@
+#include "bgzf_utils.h"
+#include "../exceptions.h"
+
+#include <stdio.h>
+
+using namespace std;
+
+namespace gamgee {
+namespace utils {
+
+BGZF* seekable_bgzf(const htsFile* file) {
+  if (file == nullptr)
+    throw FileSeekException{"the iteration is over"};
+  // text files are read through a buffer on top of the BGZF stream, so its offsets don't match records
+  if (!file->is_bin || file->is_cram)
+    throw FileSeekException{"only BAM and BCF files can be positioned by virtual offset"};
+  return file->fp.bgzf;
+}
+
+uint64_t bgzf_position(const htsFile* file) {
+  return bgzf_tell(seekable_bgzf(file));
+}
+
+void bgzf_reposition(htsFile* file, const uint64_t offset) {
+  if (bgzf_seek(seekable_bgzf(file), offset, SEEK_SET) < 0)
+    throw FileSeekException{"virtual offset " + to_string(offset) + " is not in the file"};
+}
+
+void reposition_hts_iterator(hts_itr_t* iterator, htsFile* file, const uint64_t offset) {
+  if (iterator->read_rest) {  // whole file queries (e.g. "."): hts_itr_next seeks to curr_off once and then reads on
+    seekable_bgzf(file);
+    iterator->curr_off = offset;
+    return;
+  }
+  auto chunk = -1;
+  while (chunk + 1 < iterator->n_off && iterator->off[chunk + 1].u <= offset)
+    ++chunk;
+  if (chunk < 0)  // before the first chunk: start from the beginning
+    return;
+  bgzf_reposition(file, offset);
+  iterator->i = chunk;
+  iterator->curr_off = offset;  // hts_itr_next moves on to the next chunk once curr_off reaches the end of this one
+}
+
+}  // end of namespace utils
+}  // end of namespace gamgee
@@ -0,0 +1,44 @@
+#ifndef gamgee__bgzf_utils__guard
+#define gamgee__bgzf_utils__guard
+
+#include "htslib/hts.h"
+#include "htslib/bgzf.h"
+
+#include <cstdint>
+
+namespace gamgee {
+namespace utils {
+
+/**
+ * @brief the BGZF stream of a binary BGZF file (BAM or BCF), whose virtual offsets address records
+ * @exception FileSeekException for any other kind of file (text SAM/VCF, bgzipped VCF or CRAM), or if the iteration is over (null file)
+ */
+BGZF* seekable_bgzf(const htsFile* file);
+
+/**
+ * @brief the virtual offset of the next record of a binary BGZF file
+ * @exception FileSeekException if the file is not a binary BGZF file
+ */
+uint64_t bgzf_position(const htsFile* file);
+
+/**
+ * @brief moves a binary BGZF file to a virtual offset (which must be the start of a record)
+ * @exception FileSeekException if the file is not a binary BGZF file or the offset is not in the file
+ */
+void bgzf_reposition(htsFile* file, const uint64_t offset);
+
+/**
+ * @brief makes a freshly created index iterator continue from a virtual offset within its chunks
+ *
+ * hts_itr_next walks the list of chunks (virtual offset ranges) of the query in order, so the iterator is
+ * moved to the chunk holding offset and the file to the offset itself. Offsets before the first chunk leave
+ * the iterator at its start and offsets after the last chunk leave it exhausted.
+ *
+ * @exception FileSeekException if the file is not a binary BGZF file or the offset is not in the file
+ */
+void reposition_hts_iterator(hts_itr_t* iterator, htsFile* file, const uint64_t offset);
+
+}  // end of namespace utils
+}  // end of namespace gamgee
+
+#endif /* gamgee__bgzf_utils__guard */
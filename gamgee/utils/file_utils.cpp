@@ -1,4 +1,10 @@
 #include "file_utils.h"
+#include "../exceptions.h"
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
 
 #include <memory>
 #include <fstream>
@@ -17,5 +23,27 @@ std::shared_ptr<std::ifstream> make_shared_ifstream(std::string filename) {
   return make_shared_ifstream(new std::ifstream{filename});
 }
 
+std::shared_ptr<const uint8_t> memory_map_file(const std::string& filename, uint64_t& size) {
+  const auto fd = open(filename.c_str(), O_RDONLY);
+  if (fd < 0)
+    throw FileOpenException{filename};
+  struct stat file_stats;
+  if (fstat(fd, &file_stats) != 0) {
+    close(fd);
+    throw FileOpenException{filename};
+  }
+  size = static_cast<uint64_t>(file_stats.st_size);
+  if (size == 0) {  // mmap refuses empty mappings
+    close(fd);
+    return shared_ptr<const uint8_t>{};
+  }
+  const auto mapping = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+  close(fd);  // the mapping stays valid after the descriptor is closed
+  if (mapping == MAP_FAILED)
+    throw FileOpenException{filename};
+  const auto mapped_size = size;
+  return shared_ptr<const uint8_t>(static_cast<const uint8_t*>(mapping), [mapped_size](const uint8_t* p) { munmap(const_cast<uint8_t*>(p), mapped_size); });
+}
+
 }
 }
@@ -4,6 +4,8 @@
 #include <memory>
 #include <fstream>
 #include <string>
+#include <cstdio>
+#include <cstdint>
 
 namespace gamgee {
 namespace utils {
@@ -20,6 +22,18 @@ struct IFStreamDeleter {
   }
 };
 
+/**
+ * @brief a functor object to close a c-style FILE (standard output is only flushed, never closed)
+ */
+struct FileDeleter {
+  void operator()(std::FILE* p) const {
+    if (p == stdout)
+      std::fflush(p);
+    else if (p != nullptr)
+      std::fclose(p);
+  }
+};
+
 /**
   * @brief wraps a pre-allocated ifstream in a shared_ptr with correct deleter
   * @param ifstream_ptr an ifstream raw file pointer
@@ -32,6 +46,14 @@ std::shared_ptr<std::ifstream> make_shared_ifstream(std::ifstream* ifstream_ptr)
   */
 std::shared_ptr<std::ifstream> make_shared_ifstream(std::string filename);
 
+/**
+  * @brief memory maps an entire file read-only (the mapping is released when the last copy of the pointer goes away)
+  * @param filename the input filename
+  * @param size set to the size of the file (in bytes)
+  * @exception throws FileOpenException if the file cannot be opened or mapped
+  */
+std::shared_ptr<const uint8_t> memory_map_file(const std::string& filename, uint64_t& size);
+
 }
 }
 
@@ -1,5 +1,7 @@
 #include "genotype_utils.h"
 
+#include <algorithm>
+
 namespace gamgee {
 
 namespace utils {
@@ -131,6 +133,86 @@ string allele_key_to_string(
   return string{body->d.allele[allele_int]};
 }
 
+/**
+ * @brief decodes n raw GT values into allele indices
+ *
+ * No branches, so that the compiler turns the loop into vector compares, shifts and blends at every width
+ * of the raw values: a raw value is ((allele + 1) << 1 | phased), so a shifted value of 0 (an htslib
+ * missing allele) or a negative one (the missing marker) comes out as -1 and the vector end as -2.
+ */
+template<class TYPE, class ALLELE_TYPE>
+static void decode_alleles(const TYPE* __restrict__ raw, const uint32_t n, ALLELE_TYPE* __restrict__ alleles, const TYPE vector_end) {
+  for (auto i = 0u; i != n; ++i) {
+    const TYPE key = raw[i] >> 1;
+    const TYPE allele = std::max<TYPE>(key - 1, GENOTYPE_MATRIX_MISSING_ALLELE);
+    alleles[i] = static_cast<ALLELE_TYPE>(raw[i] == vector_end ? TYPE{GENOTYPE_MATRIX_NO_ALLELE} : allele);
+  }
+}
+
+/**
+ * @brief a sample is phased if it has a second allele and every allele after the first one carries the phasing bit
+ */
+template<class TYPE>
+static void decode_phasing(const TYPE* raw, const uint32_t n_samples, const uint32_t n, uint8_t* phased, const TYPE vector_end) {
+  if (n < 2) {
+    fill_n(phased, n_samples, uint8_t{0});
+    return;
+  }
+  for (auto sample = 0u; sample != n_samples; ++sample, raw += n) {
+    auto sample_phased = raw[1] != vector_end && (raw[1] & 1);
+    for (auto i = 2u; i < n; ++i)
+      sample_phased &= raw[i] == vector_end || (raw[i] & 1);
+    phased[sample] = static_cast<uint8_t>(sample_phased);
+  }
+}
+
+template<class TYPE, class ALLELE_TYPE>
+static void decode_genotypes(const bcf_fmt_t* const format_ptr, const uint32_t n_samples, const uint32_t ploidy,
+    ALLELE_TYPE* alleles, uint8_t* phased, const TYPE vector_end) {
+  const auto n = static_cast<uint32_t>(format_ptr->n);
+  if (n > ploidy)
+    throw invalid_argument("GT field of ploidy " + to_string(n) + " does not fit a matrix of ploidy " + to_string(ploidy));
+  const auto raw = reinterpret_cast<const TYPE*>(format_ptr->p);
+  if (n == ploidy)  // the usual case: the whole line in one go
+    decode_alleles(raw, n_samples * n, alleles, vector_end);
+  else {
+    for (auto sample = 0u; sample != n_samples; ++sample) {
+      decode_alleles(raw + sample * n, n, alleles + sample * ploidy, vector_end);
+      fill(alleles + sample * ploidy + n, alleles + (sample + 1) * ploidy, ALLELE_TYPE{GENOTYPE_MATRIX_NO_ALLELE});
+    }
+  }
+  if (phased != nullptr)
+    decode_phasing(raw, n_samples, n, phased, vector_end);
+}
+
+template<class ALLELE_TYPE>
+static void decode_genotypes(const bcf_fmt_t* const format_ptr, const uint32_t n_samples, const uint32_t ploidy, ALLELE_TYPE* alleles, uint8_t* phased) {
+  if (format_ptr == nullptr) {
+    fill_n(alleles, n_samples * ploidy, ALLELE_TYPE{GENOTYPE_MATRIX_MISSING_ALLELE});
+    if (phased != nullptr)
+      fill_n(phased, n_samples, uint8_t{0});
+    return;
+  }
+  switch (format_ptr->type) {
+  case BCF_BT_INT8:
+    return decode_genotypes<int8_t>(format_ptr, n_samples, ploidy, alleles, phased, bcf_int8_vector_end);
+  case BCF_BT_INT16:
+    return decode_genotypes<int16_t>(format_ptr, n_samples, ploidy, alleles, phased, bcf_int16_vector_end);
+  case BCF_BT_INT32:
+    return decode_genotypes<int32_t>(format_ptr, n_samples, ploidy, alleles, phased, bcf_int32_vector_end);
+  default:
+    throw invalid_argument("unknown GT field type: " + to_string(format_ptr->type));
+  }
+}
+
+void decode_genotypes(const bcf_fmt_t* const format_ptr, const uint32_t n_samples, const uint32_t ploidy, int8_t* alleles, uint8_t* phased) {
+  decode_genotypes<int8_t>(format_ptr, n_samples, ploidy, alleles, phased);
+}
+
+void decode_genotypes(const bcf_fmt_t* const format_ptr, const uint32_t n_samples, const uint32_t ploidy, int16_t* alleles, uint8_t* phased) {
+  decode_genotypes<int16_t>(format_ptr, n_samples, ploidy, alleles, phased);
+}
+
 }
 
 }
@@ -13,6 +13,9 @@
 
 namespace gamgee {
 
+constexpr int8_t GENOTYPE_MATRIX_MISSING_ALLELE = -1;  ///< value of a missing allele (the . in 0/.) in a matrix filled by Variant::decode_genotypes()
+constexpr int8_t GENOTYPE_MATRIX_NO_ALLELE = -2;       ///< value of the alleles past the ploidy of a sample (e.g. the second allele of a haploid call) in a matrix filled by Variant::decode_genotypes()
+
 namespace utils {
 
 using namespace std;
@@ -102,6 +105,22 @@ using namespace std;
    * @warning Only int8_t GT fields have been tested.
    */
   string allele_key_to_string(const std::shared_ptr<bcf1_t>& body, const int32_t key_index);
+
+  /**
+   * @brief Decodes the GT field of all samples of a line into a dense samples x ploidy matrix.
+   * @param format_ptr The GT field from the line, or nullptr if the line has none (all alleles are then missing).
+   * @param n_samples The number of samples in the line.
+   * @param ploidy The number of alleles per sample in the matrix. Must be at least the ploidy of the GT field.
+   * @param alleles The n_samples * ploidy allele indices, sample by sample. Missing alleles are GENOTYPE_MATRIX_MISSING_ALLELE and alleles past the ploidy of a sample are GENOTYPE_MATRIX_NO_ALLELE.
+   * @param phased The n_samples phasing flags (1 if all the alleles of the sample are phased with the first one, 0 otherwise), or nullptr if not wanted.
+   * @warning the allele indices are truncated to the width of the matrix: check the number of alleles of the line first.
+   */
+  void decode_genotypes(const bcf_fmt_t* const format_ptr, const uint32_t n_samples, const uint32_t ploidy, int8_t* alleles, uint8_t* phased);
+
+  /**
+   * @brief Same as the int8_t version, for lines with more than 127 alleles.
+   */
+  void decode_genotypes(const bcf_fmt_t* const format_ptr, const uint32_t n_samples, const uint32_t ploidy, int16_t* alleles, uint8_t* phased);
 }
 
 }
@@ -112,6 +112,40 @@ bcf1_t* variant_deep_copy(bcf1_t* original) {
   return bcf_dup(original);
 }
 
+static void copy_kstring(kstring_t& destination, const kstring_t& original) {
+  destination.l = 0;
+  if (original.l != 0)
+    kputsn(original.s, original.l, &destination);
+}
+
+/**
+ * @brief copies an existing bcf1_t into another one, reusing its memory (no allocation once it has grown large enough)
+ * @param destination the htslib raw bcf pointer to copy into (its previous contents are discarded)
+ * @param original an htslib raw bcf pointer
+ * @return destination
+ */
+bcf1_t* variant_deep_copy(bcf1_t* destination, bcf1_t* original) {
+  // the encoded blocks of a modified record are stale: bcf_dup re-encodes them
+  if (original->d.shared_dirty || original->d.indiv_dirty) {
+    auto* encoded = bcf_dup(original);
+    variant_deep_copy(destination, encoded);
+    bcf_destroy(encoded);
+    return destination;
+  }
+  bcf_clear(destination);
+  destination->rid = original->rid;
+  destination->pos = original->pos;
+  destination->rlen = original->rlen;
+  destination->qual = original->qual;
+  destination->n_info = original->n_info;
+  destination->n_allele = original->n_allele;
+  destination->n_fmt = original->n_fmt;
+  destination->n_sample = original->n_sample;
+  copy_kstring(destination->shared, original->shared);
+  copy_kstring(destination->indiv, original->indiv);
+  return destination;
+}
+
 /**
   * @brief creates a deep copy of an existing bcf_hdr_t
   * @param original an htslib raw bcf header pointer
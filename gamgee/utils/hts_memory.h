@@ -1,9 +1,12 @@
 #ifndef gamgee__hts_memory__guard
 #define gamgee__hts_memory__guard
 
+#include "htslib/bgzf.h"
+#include "htslib/faidx.h"
 #include "htslib/sam.h"
 #include "htslib/vcf.h"
 #include "htslib/synced_bcf_reader.h"
+#include "htslib/tbx.h"
 #include "htslib/kstring.h"
 
 #include <memory>
@@ -34,6 +37,20 @@ struct HtsIteratorDeleter {
   void operator()(hts_itr_t* p) const { hts_itr_destroy(p); }
 };
 
+/**
+ * @brief a functor object to close a BGZF file pointer
+ */
+struct BgzfDeleter {
+  void operator()(BGZF* p) const { bgzf_close(p); }
+};
+
+/**
+ * @brief a functor object to delete a faidx_t (indexed fasta) pointer
+ */
+struct FaidxDeleter {
+  void operator()(faidx_t* p) const { fai_destroy(p); }
+};
+
 /**
  * @brief a functor object to delete a bam1_t pointer 
  * 
@@ -64,6 +81,13 @@ struct VariantBodyDeleter {
   void operator()(bcf1_t* p) const { bcf_destroy1(p); }
 };
 
+/**
+ * @brief a functor object to delete a tabix index (tbx_t) pointer
+ */
+struct TabixDeleter {
+  void operator()(tbx_t* p) const { tbx_destroy(p); }
+};
+
 /**
  * @brief a functor object to delete a bcf_srs_t pointer
  */
@@ -86,6 +110,7 @@ std::unique_ptr<hts_itr_t, HtsIteratorDeleter> make_unique_hts_itr(hts_itr_t* ht
 bam1_t* sam_deep_copy(bam1_t* original);
 bam_hdr_t* sam_header_deep_copy(bam_hdr_t* original);
 bcf1_t* variant_deep_copy(bcf1_t* original); 
+bcf1_t* variant_deep_copy(bcf1_t* destination, bcf1_t* original);
 bcf_hdr_t* variant_header_deep_copy(bcf_hdr_t* original);
 
 bam1_t* sam_shallow_copy(bam1_t* original);
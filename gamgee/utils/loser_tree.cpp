@@ -0,0 +1,46 @@
+#include "loser_tree.h"
+
+#include <utility>
+
+using namespace std;
+
+namespace gamgee {
+namespace utils {
+
+constexpr uint64_t LoserTree::EXHAUSTED;
+
+LoserTree::LoserTree(std::vector<uint64_t> keys) :
+  m_keys {move(keys)},
+  m_nodes(max<size_t>(m_keys.size(), 1), 0)
+{
+  if (!m_keys.empty())
+    m_nodes[0] = play(1);
+}
+
+/**
+ * @brief plays the matches of the subtree rooted at node, recording the losers, and returns its winner
+ * @note the nodes are laid out as a complete binary tree, so this works for any number of inputs
+ */
+uint32_t LoserTree::play(const uint32_t node) {
+  const auto n_inputs = size();
+  if (node >= n_inputs)
+    return node - n_inputs;
+  const auto left = play(2 * node);
+  const auto right = play(2 * node + 1);
+  const auto left_wins = beats(left, right);
+  m_nodes[node] = left_wins ? right : left;
+  return left_wins ? left : right;
+}
+
+void LoserTree::replace_winner(const uint64_t key) {
+  auto winner = m_nodes[0];
+  m_keys[winner] = key;
+  for (auto node = (winner + size()) / 2; node != 0; node /= 2) {
+    if (beats(m_nodes[node], winner))
+      swap(m_nodes[node], winner);
+  }
+  m_nodes[0] = winner;
+}
+
+}  // end of namespace utils
+}  // end of namespace gamgee
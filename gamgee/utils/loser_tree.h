@@ -0,0 +1,65 @@
+#ifndef gamgee__loser_tree__guard
+#define gamgee__loser_tree__guard
+
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+namespace gamgee {
+namespace utils {
+
+/**
+ * @brief Tournament (loser) tree over the current keys of k sorted inputs, for k-way merges.
+ *
+ * The keys live in a flat array and each internal node holds the input that lost the match played
+ * there, so replacing the key of the winning input replays a single leaf-to-root path: log2(k)
+ * comparisons of cached keys, against 2 log2(k) for a binary heap, and no access to the inputs
+ * themselves. Ties are broken by input number, so inputs with equal keys come out in input order.
+ *
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ * auto tree = LoserTree{first_keys};
+ * while (!tree.empty()) {
+ *   const auto input = tree.winner();
+ *   ... consume the current item of input ...
+ *   tree.replace_winner(has_next(input) ? next_key(input) : LoserTree::EXHAUSTED);
+ * }
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ */
+class LoserTree {
+ public:
+  static constexpr auto EXHAUSTED = std::numeric_limits<uint64_t>::max();  ///< key of an input that has no more items
+
+  LoserTree() = default;                                ///< @brief a tree without inputs (always empty)
+
+  /**
+   * @brief plays the initial tournament
+   * @param keys the key of the first item of each input (EXHAUSTED for empty inputs)
+   */
+  explicit LoserTree(std::vector<uint64_t> keys);
+
+  uint32_t winner() const { return m_nodes[0]; }                  ///< @brief the input with the smallest key (undefined if the tree has no inputs)
+  uint64_t winner_key() const { return m_keys.empty() ? EXHAUSTED : m_keys[m_nodes[0]]; } ///< @brief the smallest key
+  bool empty() const { return winner_key() == EXHAUSTED; }        ///< @brief whether every input is exhausted
+  uint32_t size() const { return m_keys.size(); }                  ///< @brief number of inputs
+
+  /**
+   * @brief sets the key of the winning input (e.g. after advancing it) and finds the new winner
+   * @param key the new key of winner(), EXHAUSTED if it has no more items
+   */
+  void replace_winner(const uint64_t key);
+
+ private:
+  std::vector<uint64_t> m_keys;    ///< current key of each input
+  std::vector<uint32_t> m_nodes;   ///< m_nodes[0] is the overall winner, m_nodes[1..k-1] the loser of each match (children of node n: 2n and 2n+1, leaf of input i: k+i)
+
+  bool beats(const uint32_t lhs, const uint32_t rhs) const {
+    return m_keys[lhs] < m_keys[rhs] || (m_keys[lhs] == m_keys[rhs] && lhs < rhs);
+  }
+
+  uint32_t play(const uint32_t node);
+};
+
+}  // end of namespace utils
+}  // end of namespace gamgee
+
+#endif // gamgee__loser_tree__guard
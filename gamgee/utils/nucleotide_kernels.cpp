@@ -0,0 +1,592 @@
+#include "nucleotide_kernels.h"
+
+#include <atomic>
+#include <cstring>
+#include <stdexcept>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define GAMGEE_X86_KERNELS
+#include <immintrin.h>
+#define GAMGEE_TARGET_SSE4 __attribute__((target("sse4.1")))
+#define GAMGEE_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+
+namespace gamgee {
+namespace utils {
+
+namespace {
+
+const auto NT16_CODES = "=ACMGRSVTWYHKDBN";
+const auto NT4_CODES = "ACGT";
+
+/**
+ * @brief lookup tables used by the scalar kernels and by the tails of the vectorized ones
+ */
+struct NucleotideTables {
+  uint8_t complement[256];
+  uint8_t nt16[256];
+  uint8_t nt4[256];
+  uint8_t upper[256];
+  uint8_t lower[256];
+  char unpack_nt4[256][4];
+
+  NucleotideTables() {
+    for (auto i = 0; i != 256; ++i) {
+      complement[i] = i;
+      nt16[i] = 15;
+      nt4[i] = 0;
+      upper[i] = (i >= 'a' && i <= 'z') ? i - 0x20 : i;
+      lower[i] = (i >= 'A' && i <= 'Z') ? i + 0x20 : i;
+      for (auto j = 0; j != 4; ++j)
+        unpack_nt4[i][j] = NT4_CODES[(i >> (2*j)) & 3];
+    }
+    const char pairs[][2] = {{'A', 'T'}, {'C', 'G'}, {'a', 't'}, {'c', 'g'}};
+    for (const auto& pair : pairs) {
+      complement[uint8_t(pair[0])] = pair[1];
+      complement[uint8_t(pair[1])] = pair[0];
+    }
+    for (auto code = 0; code != 16; ++code) {
+      nt16[uint8_t(NT16_CODES[code])] = code;
+      nt16[lower[uint8_t(NT16_CODES[code])]] = code;
+    }
+    nt16['U'] = nt16['u'] = nt16['T'];
+    for (auto code = 0; code != 4; ++code) {
+      nt4[uint8_t(NT4_CODES[code])] = code;
+      nt4[lower[uint8_t(NT4_CODES[code])]] = code;
+    }
+    nt4['U'] = nt4['u'] = nt4['T'];
+  }
+};
+
+const NucleotideTables& tables() {
+  static const auto lookup_tables = NucleotideTables{};
+  return lookup_tables;
+}
+
+/******************************************************************************
+ * scalar kernels
+ ******************************************************************************/
+
+void scalar_complement(const char* in, char* out, const size_t size) {
+  const auto& t = tables();
+  for (auto i = size_t{0}; i < size; ++i)
+    out[i] = t.complement[uint8_t(in[i])];
+}
+
+void scalar_reverse_complement(const char* in, char* out, const size_t size) {
+  const auto& t = tables();
+  for (auto i = size_t{0}; i < size; ++i)
+    out[size - 1 - i] = t.complement[uint8_t(in[i])];
+}
+
+void scalar_reverse_complement_range(char* bases, size_t left, size_t right) {
+  const auto& t = tables();
+  for (; left + 1 < right; ++left, --right) {
+    const auto tmp = t.complement[uint8_t(bases[left])];
+    bases[left] = t.complement[uint8_t(bases[right - 1])];
+    bases[right - 1] = tmp;
+  }
+  if (left + 1 == right)
+    bases[left] = t.complement[uint8_t(bases[left])];
+}
+
+void scalar_reverse_complement_in_place(char* bases, const size_t size) {
+  scalar_reverse_complement_range(bases, 0, size);
+}
+
+void scalar_pack_4bit(const char* in, const size_t size, uint8_t* out) {
+  const auto& t = tables();
+  auto i = size_t{0};
+  for (; i + 1 < size; i += 2)
+    *out++ = (t.nt16[uint8_t(in[i])] << 4) | t.nt16[uint8_t(in[i + 1])];
+  if (i < size)
+    *out = t.nt16[uint8_t(in[i])] << 4;
+}
+
+void scalar_unpack_4bit(const uint8_t* in, const size_t size, char* out) {
+  for (auto i = size_t{0}; i < size; ++i)
+    out[i] = NT16_CODES[(in[i >> 1] >> ((~i & 1) << 2)) & 0xF];
+}
+
+void scalar_pack_2bit(const char* in, const size_t size, uint8_t* out) {
+  const auto& t = tables();
+  auto i = size_t{0};
+  for (; i + 3 < size; i += 4)
+    *out++ = t.nt4[uint8_t(in[i])] | (t.nt4[uint8_t(in[i + 1])] << 2) | (t.nt4[uint8_t(in[i + 2])] << 4) | (t.nt4[uint8_t(in[i + 3])] << 6);
+  if (i < size) {
+    auto last = uint8_t{0};
+    for (auto shift = 0; i < size; ++i, shift += 2)
+      last |= t.nt4[uint8_t(in[i])] << shift;
+    *out = last;
+  }
+}
+
+void scalar_unpack_2bit(const uint8_t* in, const size_t size, char* out) {
+  const auto& t = tables();
+  auto i = size_t{0};
+  for (; i + 3 < size; i += 4)
+    memcpy(out + i, t.unpack_nt4[in[i >> 2]], 4);
+  for (; i < size; ++i)
+    out[i] = t.unpack_nt4[in[i >> 2]][i & 3];
+}
+
+void scalar_to_upper(char* bases, const size_t size) {
+  const auto& t = tables();
+  for (auto i = size_t{0}; i < size; ++i)
+    bases[i] = t.upper[uint8_t(bases[i])];
+}
+
+void scalar_to_lower(char* bases, const size_t size) {
+  const auto& t = tables();
+  for (auto i = size_t{0}; i < size; ++i)
+    bases[i] = t.lower[uint8_t(bases[i])];
+}
+
+size_t scalar_count_n(const char* bases, const size_t size) {
+  auto count = size_t{0};
+  for (auto i = size_t{0}; i < size; ++i)
+    count += (bases[i] | 0x20) == 'n';
+  return count;
+}
+
+#ifdef GAMGEE_X86_KERNELS
+
+/******************************************************************************
+ * SSE4 kernels (16 bases at a time)
+ *
+ * Complement and packing are driven by 16-entry shuffle tables indexed by the low nibble of the case
+ * folded base. A second table holds the character each nibble is expected to come from so that
+ * non-nucleotide characters can be masked out.
+ ******************************************************************************/
+
+GAMGEE_TARGET_SSE4 inline __m128i sse4_complement_vector(const __m128i bases) {
+  const auto expected = _mm_setr_epi8(-1, 'A', -1, 'C', 'T', -1, -1, 'G', -1, -1, -1, -1, -1, -1, -1, -1);
+  const auto delta    = _mm_setr_epi8(0, 'A'^'T', 0, 'C'^'G', 'A'^'T', 0, 0, 'C'^'G', 0, 0, 0, 0, 0, 0, 0, 0);
+  const auto folded = _mm_and_si128(bases, _mm_set1_epi8(char(0xDF)));
+  const auto nibble = _mm_and_si128(folded, _mm_set1_epi8(0x0F));
+  const auto is_base = _mm_cmpeq_epi8(folded, _mm_shuffle_epi8(expected, nibble));
+  return _mm_xor_si128(bases, _mm_and_si128(is_base, _mm_shuffle_epi8(delta, nibble)));
+}
+
+GAMGEE_TARGET_SSE4 inline __m128i sse4_reverse_complement_vector(const __m128i bases) {
+  const auto reverse = _mm_setr_epi8(15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0);
+  return _mm_shuffle_epi8(sse4_complement_vector(bases), reverse);
+}
+
+GAMGEE_TARGET_SSE4 inline __m128i sse4_nt16_vector(const __m128i bases) {
+  const auto codes_4x = _mm_setr_epi8(15, 1, 14, 2, 13, 15, 15, 4, 11, 15, 15, 12, 15, 3, 15, 15);  // @ABCDEFGHIJKLMNO
+  const auto codes_5x = _mm_setr_epi8(15, 15, 5, 6, 8, 8, 7, 9, 15, 10, 15, 15, 15, 15, 15, 15);    // PQRSTUVWXYZ[\]^_
+  const auto folded = _mm_and_si128(bases, _mm_set1_epi8(char(0xDF)));
+  const auto nibble = _mm_and_si128(folded, _mm_set1_epi8(0x0F));
+  const auto high = _mm_and_si128(folded, _mm_set1_epi8(char(0xF0)));
+  const auto is_4x = _mm_cmpeq_epi8(high, _mm_set1_epi8(0x40));
+  const auto is_5x = _mm_cmpeq_epi8(high, _mm_set1_epi8(0x50));
+  auto codes = _mm_set1_epi8(15);
+  codes = _mm_blendv_epi8(codes, _mm_shuffle_epi8(codes_4x, nibble), is_4x);
+  codes = _mm_blendv_epi8(codes, _mm_shuffle_epi8(codes_5x, nibble), is_5x);
+  return _mm_andnot_si128(_mm_cmpeq_epi8(bases, _mm_set1_epi8('=')), codes);
+}
+
+GAMGEE_TARGET_SSE4 inline __m128i sse4_nt4_vector(const __m128i bases) {
+  const auto expected = _mm_setr_epi8(-1, 'A', -1, 'C', 'T', 'U', -1, 'G', -1, -1, -1, -1, -1, -1, -1, -1);
+  const auto codes    = _mm_setr_epi8(0, 0, 0, 1, 3, 3, 0, 2, 0, 0, 0, 0, 0, 0, 0, 0);
+  const auto folded = _mm_and_si128(bases, _mm_set1_epi8(char(0xDF)));
+  const auto nibble = _mm_and_si128(folded, _mm_set1_epi8(0x0F));
+  const auto is_base = _mm_cmpeq_epi8(folded, _mm_shuffle_epi8(expected, nibble));
+  return _mm_and_si128(is_base, _mm_shuffle_epi8(codes, nibble));
+}
+
+GAMGEE_TARGET_SSE4 void sse4_complement(const char* in, char* out, const size_t size) {
+  auto i = size_t{0};
+  for (; i + 16 <= size; i += 16) {
+    const auto bases = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), sse4_complement_vector(bases));
+  }
+  scalar_complement(in + i, out + i, size - i);
+}
+
+GAMGEE_TARGET_SSE4 void sse4_reverse_complement(const char* in, char* out, const size_t size) {
+  auto i = size_t{0};
+  for (; i + 16 <= size; i += 16) {
+    const auto bases = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(out + size - i - 16), sse4_reverse_complement_vector(bases));
+  }
+  scalar_reverse_complement(in + i, out, size - i);
+}
+
+GAMGEE_TARGET_SSE4 void sse4_reverse_complement_in_place(char* bases, const size_t size) {
+  auto left = size_t{0};
+  auto right = size;
+  for (; right - left >= 32; left += 16, right -= 16) {
+    const auto front = _mm_loadu_si128(reinterpret_cast<const __m128i*>(bases + left));
+    const auto back = _mm_loadu_si128(reinterpret_cast<const __m128i*>(bases + right - 16));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(bases + left), sse4_reverse_complement_vector(back));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(bases + right - 16), sse4_reverse_complement_vector(front));
+  }
+  scalar_reverse_complement_range(bases, left, right);
+}
+
+GAMGEE_TARGET_SSE4 void sse4_pack_4bit(const char* in, const size_t size, uint8_t* out) {
+  const auto weights = _mm_set1_epi16(0x0110);  // multiplies even bases by 16 and odd bases by 1
+  auto i = size_t{0};
+  for (; i + 32 <= size; i += 32, out += 16) {
+    const auto first = sse4_nt16_vector(_mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i)));
+    const auto second = sse4_nt16_vector(_mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i + 16)));
+    const auto packed = _mm_packus_epi16(_mm_maddubs_epi16(first, weights), _mm_maddubs_epi16(second, weights));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(out), packed);
+  }
+  scalar_pack_4bit(in + i, size - i, out);
+}
+
+GAMGEE_TARGET_SSE4 void sse4_unpack_4bit(const uint8_t* in, const size_t size, char* out) {
+  const auto codes = _mm_setr_epi8('=', 'A', 'C', 'M', 'G', 'R', 'S', 'V', 'T', 'W', 'Y', 'H', 'K', 'D', 'B', 'N');
+  const auto low_nibbles = _mm_set1_epi8(0x0F);
+  auto i = size_t{0};
+  for (; i + 32 <= size; i += 32, in += 16) {
+    const auto packed = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in));
+    const auto high = _mm_shuffle_epi8(codes, _mm_and_si128(_mm_srli_epi16(packed, 4), low_nibbles));
+    const auto low = _mm_shuffle_epi8(codes, _mm_and_si128(packed, low_nibbles));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), _mm_unpacklo_epi8(high, low));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i + 16), _mm_unpackhi_epi8(high, low));
+  }
+  scalar_unpack_4bit(in, size - i, out + i);
+}
+
+GAMGEE_TARGET_SSE4 void sse4_pack_2bit(const char* in, const size_t size, uint8_t* out) {
+  const auto pair_weights = _mm_set1_epi16(0x0401);  // a + 4b
+  const auto quad_weights = _mm_set1_epi32(0x00100001);  // ab + 16cd
+  auto i = size_t{0};
+  for (; i + 64 <= size; i += 64, out += 16) {
+    __m128i quads[4];
+    for (auto j = 0; j != 4; ++j) {
+      const auto codes = sse4_nt4_vector(_mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i + 16*j)));
+      quads[j] = _mm_madd_epi16(_mm_maddubs_epi16(codes, pair_weights), quad_weights);
+    }
+    const auto packed = _mm_packus_epi16(_mm_packs_epi32(quads[0], quads[1]), _mm_packs_epi32(quads[2], quads[3]));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(out), packed);
+  }
+  scalar_pack_2bit(in + i, size - i, out);
+}
+
+GAMGEE_TARGET_SSE4 void sse4_to_upper(char* bases, const size_t size) {
+  auto i = size_t{0};
+  for (; i + 16 <= size; i += 16) {
+    const auto v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(bases + i));
+    const auto is_lower = _mm_and_si128(_mm_cmpgt_epi8(v, _mm_set1_epi8('a' - 1)), _mm_cmplt_epi8(v, _mm_set1_epi8('z' + 1)));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(bases + i), _mm_sub_epi8(v, _mm_and_si128(is_lower, _mm_set1_epi8(0x20))));
+  }
+  scalar_to_upper(bases + i, size - i);
+}
+
+GAMGEE_TARGET_SSE4 void sse4_to_lower(char* bases, const size_t size) {
+  auto i = size_t{0};
+  for (; i + 16 <= size; i += 16) {
+    const auto v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(bases + i));
+    const auto is_upper = _mm_and_si128(_mm_cmpgt_epi8(v, _mm_set1_epi8('A' - 1)), _mm_cmplt_epi8(v, _mm_set1_epi8('Z' + 1)));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(bases + i), _mm_add_epi8(v, _mm_and_si128(is_upper, _mm_set1_epi8(0x20))));
+  }
+  scalar_to_lower(bases + i, size - i);
+}
+
+GAMGEE_TARGET_SSE4 size_t sse4_count_n(const char* bases, const size_t size) {
+  auto count = size_t{0};
+  auto i = size_t{0};
+  for (; i + 16 <= size; i += 16) {
+    const auto v = _mm_or_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(bases + i)), _mm_set1_epi8(0x20));
+    count += __builtin_popcount(_mm_movemask_epi8(_mm_cmpeq_epi8(v, _mm_set1_epi8('n'))));
+  }
+  return count + scalar_count_n(bases + i, size - i);
+}
+
+/******************************************************************************
+ * AVX2 kernels (32 bases at a time)
+ *
+ * Same algorithms as the SSE4 kernels. The shuffle tables are replicated in both 128-bit lanes and
+ * the lane-crossing steps (reversal, packing and unpacking) are fixed with explicit permutes.
+ ******************************************************************************/
+
+GAMGEE_TARGET_AVX2 inline __m256i avx2_broadcast(const __m128i table) {
+  return _mm256_broadcastsi128_si256(table);
+}
+
+GAMGEE_TARGET_AVX2 inline __m256i avx2_complement_vector(const __m256i bases) {
+  const auto expected = avx2_broadcast(_mm_setr_epi8(-1, 'A', -1, 'C', 'T', -1, -1, 'G', -1, -1, -1, -1, -1, -1, -1, -1));
+  const auto delta    = avx2_broadcast(_mm_setr_epi8(0, 'A'^'T', 0, 'C'^'G', 'A'^'T', 0, 0, 'C'^'G', 0, 0, 0, 0, 0, 0, 0, 0));
+  const auto folded = _mm256_and_si256(bases, _mm256_set1_epi8(char(0xDF)));
+  const auto nibble = _mm256_and_si256(folded, _mm256_set1_epi8(0x0F));
+  const auto is_base = _mm256_cmpeq_epi8(folded, _mm256_shuffle_epi8(expected, nibble));
+  return _mm256_xor_si256(bases, _mm256_and_si256(is_base, _mm256_shuffle_epi8(delta, nibble)));
+}
+
+GAMGEE_TARGET_AVX2 inline __m256i avx2_reverse_complement_vector(const __m256i bases) {
+  const auto reverse = avx2_broadcast(_mm_setr_epi8(15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0));
+  const auto reversed_lanes = _mm256_shuffle_epi8(avx2_complement_vector(bases), reverse);
+  return _mm256_permute2x128_si256(reversed_lanes, reversed_lanes, 0x01);
+}
+
+GAMGEE_TARGET_AVX2 inline __m256i avx2_nt16_vector(const __m256i bases) {
+  const auto codes_4x = avx2_broadcast(_mm_setr_epi8(15, 1, 14, 2, 13, 15, 15, 4, 11, 15, 15, 12, 15, 3, 15, 15));
+  const auto codes_5x = avx2_broadcast(_mm_setr_epi8(15, 15, 5, 6, 8, 8, 7, 9, 15, 10, 15, 15, 15, 15, 15, 15));
+  const auto folded = _mm256_and_si256(bases, _mm256_set1_epi8(char(0xDF)));
+  const auto nibble = _mm256_and_si256(folded, _mm256_set1_epi8(0x0F));
+  const auto high = _mm256_and_si256(folded, _mm256_set1_epi8(char(0xF0)));
+  const auto is_4x = _mm256_cmpeq_epi8(high, _mm256_set1_epi8(0x40));
+  const auto is_5x = _mm256_cmpeq_epi8(high, _mm256_set1_epi8(0x50));
+  auto codes = _mm256_set1_epi8(15);
+  codes = _mm256_blendv_epi8(codes, _mm256_shuffle_epi8(codes_4x, nibble), is_4x);
+  codes = _mm256_blendv_epi8(codes, _mm256_shuffle_epi8(codes_5x, nibble), is_5x);
+  return _mm256_andnot_si256(_mm256_cmpeq_epi8(bases, _mm256_set1_epi8('=')), codes);
+}
+
+GAMGEE_TARGET_AVX2 inline __m256i avx2_nt4_vector(const __m256i bases) {
+  const auto expected = avx2_broadcast(_mm_setr_epi8(-1, 'A', -1, 'C', 'T', 'U', -1, 'G', -1, -1, -1, -1, -1, -1, -1, -1));
+  const auto codes    = avx2_broadcast(_mm_setr_epi8(0, 0, 0, 1, 3, 3, 0, 2, 0, 0, 0, 0, 0, 0, 0, 0));
+  const auto folded = _mm256_and_si256(bases, _mm256_set1_epi8(char(0xDF)));
+  const auto nibble = _mm256_and_si256(folded, _mm256_set1_epi8(0x0F));
+  const auto is_base = _mm256_cmpeq_epi8(folded, _mm256_shuffle_epi8(expected, nibble));
+  return _mm256_and_si256(is_base, _mm256_shuffle_epi8(codes, nibble));
+}
+
+GAMGEE_TARGET_AVX2 void avx2_complement(const char* in, char* out, const size_t size) {
+  auto i = size_t{0};
+  for (; i + 32 <= size; i += 32) {
+    const auto bases = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + i));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), avx2_complement_vector(bases));
+  }
+  sse4_complement(in + i, out + i, size - i);
+}
+
+GAMGEE_TARGET_AVX2 void avx2_reverse_complement(const char* in, char* out, const size_t size) {
+  auto i = size_t{0};
+  for (; i + 32 <= size; i += 32) {
+    const auto bases = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + i));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + size - i - 32), avx2_reverse_complement_vector(bases));
+  }
+  sse4_reverse_complement(in + i, out, size - i);
+}
+
+GAMGEE_TARGET_AVX2 void avx2_reverse_complement_in_place(char* bases, const size_t size) {
+  auto left = size_t{0};
+  auto right = size;
+  for (; right - left >= 64; left += 32, right -= 32) {
+    const auto front = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(bases + left));
+    const auto back = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(bases + right - 32));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(bases + left), avx2_reverse_complement_vector(back));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(bases + right - 32), avx2_reverse_complement_vector(front));
+  }
+  scalar_reverse_complement_range(bases, left, right);
+}
+
+GAMGEE_TARGET_AVX2 void avx2_pack_4bit(const char* in, const size_t size, uint8_t* out) {
+  const auto weights = _mm256_set1_epi16(0x0110);
+  auto i = size_t{0};
+  for (; i + 64 <= size; i += 64, out += 32) {
+    const auto first = avx2_nt16_vector(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + i)));
+    const auto second = avx2_nt16_vector(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + i + 32)));
+    const auto packed = _mm256_packus_epi16(_mm256_maddubs_epi16(first, weights), _mm256_maddubs_epi16(second, weights));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(out), _mm256_permute4x64_epi64(packed, 0xD8));  // packus works per lane: restore order
+  }
+  sse4_pack_4bit(in + i, size - i, out);
+}
+
+GAMGEE_TARGET_AVX2 void avx2_unpack_4bit(const uint8_t* in, const size_t size, char* out) {
+  const auto codes = avx2_broadcast(_mm_setr_epi8('=', 'A', 'C', 'M', 'G', 'R', 'S', 'V', 'T', 'W', 'Y', 'H', 'K', 'D', 'B', 'N'));
+  const auto low_nibbles = _mm256_set1_epi8(0x0F);
+  auto i = size_t{0};
+  for (; i + 64 <= size; i += 64, in += 32) {
+    const auto packed = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in));
+    const auto high = _mm256_shuffle_epi8(codes, _mm256_and_si256(_mm256_srli_epi16(packed, 4), low_nibbles));
+    const auto low = _mm256_shuffle_epi8(codes, _mm256_and_si256(packed, low_nibbles));
+    const auto first = _mm256_unpacklo_epi8(high, low);
+    const auto second = _mm256_unpackhi_epi8(high, low);
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), _mm256_permute2x128_si256(first, second, 0x20));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i + 32), _mm256_permute2x128_si256(first, second, 0x31));
+  }
+  sse4_unpack_4bit(in, size - i, out + i);
+}
+
+GAMGEE_TARGET_AVX2 void avx2_pack_2bit(const char* in, const size_t size, uint8_t* out) {
+  const auto pair_weights = _mm256_set1_epi16(0x0401);
+  const auto quad_weights = _mm256_set1_epi32(0x00100001);
+  const auto lane_order = _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7);
+  auto i = size_t{0};
+  for (; i + 128 <= size; i += 128, out += 32) {
+    __m256i quads[4];
+    for (auto j = 0; j != 4; ++j) {
+      const auto codes = avx2_nt4_vector(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + i + 32*j)));
+      quads[j] = _mm256_madd_epi16(_mm256_maddubs_epi16(codes, pair_weights), quad_weights);
+    }
+    const auto packed = _mm256_packus_epi16(_mm256_packs_epi32(quads[0], quads[1]), _mm256_packs_epi32(quads[2], quads[3]));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(out), _mm256_permutevar8x32_epi32(packed, lane_order));
+  }
+  sse4_pack_2bit(in + i, size - i, out);
+}
+
+GAMGEE_TARGET_AVX2 void avx2_to_upper(char* bases, const size_t size) {
+  auto i = size_t{0};
+  for (; i + 32 <= size; i += 32) {
+    const auto v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(bases + i));
+    const auto is_lower = _mm256_and_si256(_mm256_cmpgt_epi8(v, _mm256_set1_epi8('a' - 1)), _mm256_cmpgt_epi8(_mm256_set1_epi8('z' + 1), v));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(bases + i), _mm256_sub_epi8(v, _mm256_and_si256(is_lower, _mm256_set1_epi8(0x20))));
+  }
+  sse4_to_upper(bases + i, size - i);
+}
+
+GAMGEE_TARGET_AVX2 void avx2_to_lower(char* bases, const size_t size) {
+  auto i = size_t{0};
+  for (; i + 32 <= size; i += 32) {
+    const auto v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(bases + i));
+    const auto is_upper = _mm256_and_si256(_mm256_cmpgt_epi8(v, _mm256_set1_epi8('A' - 1)), _mm256_cmpgt_epi8(_mm256_set1_epi8('Z' + 1), v));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(bases + i), _mm256_add_epi8(v, _mm256_and_si256(is_upper, _mm256_set1_epi8(0x20))));
+  }
+  sse4_to_lower(bases + i, size - i);
+}
+
+GAMGEE_TARGET_AVX2 size_t avx2_count_n(const char* bases, const size_t size) {
+  auto count = size_t{0};
+  auto i = size_t{0};
+  for (; i + 32 <= size; i += 32) {
+    const auto v = _mm256_or_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(bases + i)), _mm256_set1_epi8(0x20));
+    count += __builtin_popcount(static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('n')))));
+  }
+  return count + sse4_count_n(bases + i, size - i);
+}
+
+#endif // GAMGEE_X86_KERNELS
+
+/******************************************************************************
+ * runtime dispatch
+ ******************************************************************************/
+
+struct NucleotideKernels {
+  NucleotideKernelLevel level;
+  void (*complement)(const char*, char*, const size_t);
+  void (*reverse_complement)(const char*, char*, const size_t);
+  void (*reverse_complement_in_place)(char*, const size_t);
+  void (*pack_4bit)(const char*, const size_t, uint8_t*);
+  void (*unpack_4bit)(const uint8_t*, const size_t, char*);
+  void (*pack_2bit)(const char*, const size_t, uint8_t*);
+  void (*to_upper)(char*, const size_t);
+  void (*to_lower)(char*, const size_t);
+  size_t (*count_n)(const char*, const size_t);
+};
+
+const NucleotideKernels SCALAR_KERNELS {
+  NucleotideKernelLevel::SCALAR, scalar_complement, scalar_reverse_complement, scalar_reverse_complement_in_place,
+  scalar_pack_4bit, scalar_unpack_4bit, scalar_pack_2bit, scalar_to_upper, scalar_to_lower, scalar_count_n
+};
+
+#ifdef GAMGEE_X86_KERNELS
+const NucleotideKernels SSE4_KERNELS {
+  NucleotideKernelLevel::SSE4, sse4_complement, sse4_reverse_complement, sse4_reverse_complement_in_place,
+  sse4_pack_4bit, sse4_unpack_4bit, sse4_pack_2bit, sse4_to_upper, sse4_to_lower, sse4_count_n
+};
+
+const NucleotideKernels AVX2_KERNELS {
+  NucleotideKernelLevel::AVX2, avx2_complement, avx2_reverse_complement, avx2_reverse_complement_in_place,
+  avx2_pack_4bit, avx2_unpack_4bit, avx2_pack_2bit, avx2_to_upper, avx2_to_lower, avx2_count_n
+};
+#endif
+
+const NucleotideKernels* kernels_for_level(const NucleotideKernelLevel level) {
+  switch (level) {
+#ifdef GAMGEE_X86_KERNELS
+    case NucleotideKernelLevel::AVX2:
+      return &AVX2_KERNELS;
+    case NucleotideKernelLevel::SSE4:
+      return &SSE4_KERNELS;
+#endif
+    default:
+      return &SCALAR_KERNELS;
+  }
+}
+
+const NucleotideKernels* best_supported_kernels() {
+  if (nucleotide_kernel_level_supported(NucleotideKernelLevel::AVX2))
+    return kernels_for_level(NucleotideKernelLevel::AVX2);
+  if (nucleotide_kernel_level_supported(NucleotideKernelLevel::SSE4))
+    return kernels_for_level(NucleotideKernelLevel::SSE4);
+  return kernels_for_level(NucleotideKernelLevel::SCALAR);
+}
+
+std::atomic<const NucleotideKernels*>& active_kernels_slot() {
+  static std::atomic<const NucleotideKernels*> active {best_supported_kernels()};
+  return active;
+}
+
+inline const NucleotideKernels& kernels() {
+  return *active_kernels_slot().load(std::memory_order_relaxed);
+}
+
+} // end anonymous namespace
+
+bool nucleotide_kernel_level_supported(const NucleotideKernelLevel level) {
+#ifdef GAMGEE_X86_KERNELS
+  __builtin_cpu_init();
+#endif
+  switch (level) {
+#ifdef GAMGEE_X86_KERNELS
+    case NucleotideKernelLevel::AVX2:
+      return __builtin_cpu_supports("avx2");
+    case NucleotideKernelLevel::SSE4:
+      return __builtin_cpu_supports("sse4.1");
+#endif
+    case NucleotideKernelLevel::SCALAR:
+      return true;
+    default:
+      return false;
+  }
+}
+
+NucleotideKernelLevel nucleotide_kernel_level() {
+  return kernels().level;
+}
+
+void set_nucleotide_kernel_level(const NucleotideKernelLevel level) {
+  if (!nucleotide_kernel_level_supported(level))
+    throw std::invalid_argument{"Error: the requested nucleotide kernel instruction set is not supported by this CPU"};
+  active_kernels_slot().store(kernels_for_level(level));
+}
+
+void complement_bases(const char* in, char* out, const size_t size) {
+  kernels().complement(in, out, size);
+}
+
+void reverse_complement_bases(const char* in, char* out, const size_t size) {
+  kernels().reverse_complement(in, out, size);
+}
+
+void reverse_complement_bases(char* bases, const size_t size) {
+  kernels().reverse_complement_in_place(bases, size);
+}
+
+void pack_bases_4bit(const char* in, const size_t size, uint8_t* out) {
+  kernels().pack_4bit(in, size, out);
+}
+
+void unpack_bases_4bit(const uint8_t* in, const size_t size, char* out) {
+  kernels().unpack_4bit(in, size, out);
+}
+
+void pack_bases_2bit(const char* in, const size_t size, uint8_t* out) {
+  kernels().pack_2bit(in, size, out);
+}
+
+void unpack_bases_2bit(const uint8_t* in, const size_t size, char* out) {
+  scalar_unpack_2bit(in, size, out);
+}
+
+void to_upper_bases(char* bases, const size_t size) {
+  kernels().to_upper(bases, size);
+}
+
+void to_lower_bases(char* bases, const size_t size) {
+  kernels().to_lower(bases, size);
+}
+
+size_t count_n_bases(const char* bases, const size_t size) {
+  return kernels().count_n(bases, size);
+}
+
+} // end utils namespace
+} // end gamgee namespace
@@ -0,0 +1,122 @@
+#ifndef gamgee__nucleotide_kernels__guard
+#define gamgee__nucleotide_kernels__guard
+
+#include <cstddef>
+#include <cstdint>
+
+namespace gamgee {
+namespace utils {
+
+/**
+ * @brief instruction set used by the nucleotide kernels
+ *
+ * The best level supported by the running CPU is selected automatically the first time any of the
+ * kernels is called. All levels produce exactly the same output.
+ */
+enum class NucleotideKernelLevel {
+  SCALAR,  ///< portable table driven implementation
+  SSE4,    ///< 16 bases per instruction (SSSE3 shuffles + SSE4.1)
+  AVX2     ///< 32 bases per instruction
+};
+
+/**
+ * @brief the instruction set currently used by the nucleotide kernels
+ */
+NucleotideKernelLevel nucleotide_kernel_level();
+
+/**
+ * @brief forces the nucleotide kernels to use a given instruction set (useful for tests and benchmarks)
+ * @param level the desired instruction set
+ * @exception throws std::invalid_argument if the running CPU does not support level
+ * @note this is not thread safe with respect to kernels running concurrently in other threads
+ */
+void set_nucleotide_kernel_level(const NucleotideKernelLevel level);
+
+/**
+ * @brief whether or not the running CPU supports a given instruction set
+ */
+bool nucleotide_kernel_level_supported(const NucleotideKernelLevel level);
+
+/**
+ * @brief complements a sequence of bases (A<->T, C<->G, preserving case). Any other character is copied as is.
+ * @param in the input bases
+ * @param out the output buffer (at least size bytes). Can be the same as in for in-place operation.
+ * @param size number of bases
+ */
+void complement_bases(const char* in, char* out, const size_t size);
+
+/**
+ * @brief reverse complements a sequence of bases into a separate buffer
+ * @param in the input bases
+ * @param out the output buffer (at least size bytes). Must not overlap with in.
+ * @param size number of bases
+ */
+void reverse_complement_bases(const char* in, char* out, const size_t size);
+
+/**
+ * @brief reverse complements a sequence of bases in-place
+ * @param bases the bases to reverse complement
+ * @param size number of bases
+ */
+void reverse_complement_bases(char* bases, const size_t size);
+
+/**
+ * @brief packs bases into 4-bit codes (the "=ACMGRSVTWYHKDBN" encoding used by BAM), two bases per byte
+ *
+ * The first base of each pair goes in the high nibble. Case is ignored and anything that is not an IUPAC
+ * code is encoded as N.
+ *
+ * @param in the input bases
+ * @param size number of bases
+ * @param out the output buffer (at least (size+1)/2 bytes)
+ */
+void pack_bases_4bit(const char* in, const size_t size, uint8_t* out);
+
+/**
+ * @brief unpacks bases encoded by pack_bases_4bit into upper case characters
+ * @param in the packed bases
+ * @param size number of bases
+ * @param out the output buffer (at least size bytes)
+ */
+void unpack_bases_4bit(const uint8_t* in, const size_t size, char* out);
+
+/**
+ * @brief packs bases into 2-bit codes (A=0, C=1, G=2, T=3), four bases per byte
+ *
+ * The first base of each group of four goes in the two lowest bits. Case is ignored and anything that
+ * is not A, C, G, T (or U) is encoded as A, so callers that need to keep N's must track them separately.
+ *
+ * @param in the input bases
+ * @param size number of bases
+ * @param out the output buffer (at least (size+3)/4 bytes)
+ */
+void pack_bases_2bit(const char* in, const size_t size, uint8_t* out);
+
+/**
+ * @brief unpacks bases encoded by pack_bases_2bit into upper case characters
+ * @param in the packed bases
+ * @param size number of bases
+ * @param out the output buffer (at least size bytes)
+ * @note this kernel is table driven (four bases per lookup) in all instruction sets
+ */
+void unpack_bases_2bit(const uint8_t* in, const size_t size, char* out);
+
+/**
+ * @brief converts all lower case letters to upper case in-place (soft-masked reference bases, for example)
+ */
+void to_upper_bases(char* bases, const size_t size);
+
+/**
+ * @brief converts all upper case letters to lower case in-place
+ */
+void to_lower_bases(char* bases, const size_t size);
+
+/**
+ * @brief counts the number of N (or n) bases in a sequence
+ */
+size_t count_n_bases(const char* bases, const size_t size);
+
+} // end utils namespace
+} // end gamgee namespace
+
+#endif // gamgee__nucleotide_kernels__guard
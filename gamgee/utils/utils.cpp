@@ -1,53 +1,33 @@
 #include "utils.h" 
+#include "nucleotide_kernels.h"
 
 #include <string>
-#include <algorithm>
-#include <memory.h>
 #include <vector>
 
 namespace gamgee {
 namespace utils {
 
-char complement_base (const char base) {
-  switch (base) {
-    case 'A':
-      return 'T';
-    case 'C':
-      return 'G';
-    case 'G':
-      return 'C';
-    case 'T':
-      return 'A';
-    case 'a':
-      return 't';
-    case 'c':
-      return 'g';
-    case 'g':
-      return 'c';
-    case 't':
-      return 'a';
-    default:
-      return base;
-  }
+char complement(const char base) {
+  auto result = base;
+  complement_bases(&base, &result, 1);
+  return result;
 }
 
 std::string complement(std::string& sequence) {
-  std::transform(sequence.begin(), sequence.end(), sequence.begin(), complement_base);
+  complement_bases(&sequence[0], &sequence[0], sequence.size());
   return sequence;
 }
 
 std::string complement(const std::string& sequence) {
-  auto rev = std::string{};
-  rev.reserve(sequence.length());
-  std::transform(sequence.cbegin(), sequence.cend(), std::back_inserter(rev), complement_base);
-  return rev;
+  auto result = std::string(sequence.size(), '\0');
+  complement_bases(sequence.data(), &result[0], sequence.size());
+  return result;
 }
 
 std::string reverse_complement(const std::string& sequence) {
-  auto rev = std::string{};
-  rev.reserve(sequence.length());
-  std::transform(sequence.crbegin(), sequence.crend(), std::back_inserter(rev), complement_base);
-  return rev;
+  auto result = std::string(sequence.size(), '\0');
+  reverse_complement_bases(sequence.data(), &result[0], sequence.size());
+  return result;
 }
 
 std::vector<std::string> hts_string_array_to_vector(const char * const * const string_array, const uint32_t array_size) {
@@ -7,6 +7,7 @@
 #include "htslib/vcf.h"
 
 #include <algorithm>
+#include <cstring>
 #include <string>
 #include <vector>
 
@@ -29,6 +30,44 @@ void subset_variant_samples(bcf_hdr_t* hdr_ptr, const std::vector<std::string>&
   // NOTE: must NOT call bcf_hdr_sync() here, since htslib calls it for us in bcf_hdr_set_samples()
 }
 
+IndividualFieldMask individual_field_mask(const bcf_hdr_t* hdr_ptr, const std::vector<std::string>& fields) {
+  if (fields.empty())
+    return IndividualFieldMask{};
+  auto keep = IndividualFieldMask(hdr_ptr->n[BCF_DT_ID], false);
+  for (const auto& field : fields) {
+    const auto index = bcf_hdr_id2int(hdr_ptr, BCF_DT_ID, field.c_str());
+    if (index < 0 || !bcf_hdr_idinfo_exists(hdr_ptr, BCF_HL_FMT, index))
+      throw HeaderFieldNotFoundException{field};
+    keep[index] = true;
+  }
+  return keep;
+}
+
+void project_individual_fields(bcf1_t* record, const IndividualFieldMask& keep) {
+  if (keep.empty() || record->n_fmt == 0)
+    return;
+  auto* const indiv = reinterpret_cast<uint8_t*>(record->indiv.s);
+  auto* read = indiv;
+  auto* write = indiv;
+  auto n_kept = 0u;
+  for (auto i = 0u; i != record->n_fmt; ++i) {
+    auto* const field = read;
+    const auto index = bcf_dec_typed_int1(read, &read);
+    auto type = 0;
+    const auto n_values = bcf_dec_size(read, &read, &type);
+    read += size_t(record->n_sample) * (size_t(n_values) << bcf_type_shift[type]);
+    if (index >= 0 && size_t(index) < keep.size() && keep[index]) {
+      if (write != field)
+        std::memmove(write, field, read - field);
+      write += read - field;
+      ++n_kept;
+    }
+  }
+  record->indiv.l = write - indiv;
+  record->n_fmt = n_kept;
+  record->unpacked &= ~BCF_UN_FMT;  // decoded fields would point at the old layout
+}
+
 void merge_variant_headers(const std::shared_ptr<bcf_hdr_t>& dest_hdr_ptr, const std::shared_ptr<bcf_hdr_t>& src_hdr_ptr) {
   auto success = bcf_hdr_combine(dest_hdr_ptr.get(), src_hdr_ptr.get());
   if (success != 0)
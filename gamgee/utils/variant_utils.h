@@ -19,6 +19,31 @@ namespace gamgee {
  */
 void subset_variant_samples(bcf_hdr_t* hdr_ptr, const std::vector<std::string>& samples, const bool include);
 
+/**
+ * @brief the individual (FORMAT) fields a reader keeps, indexed by header field index. Empty to keep all fields.
+ */
+using IndividualFieldMask = std::vector<bool>;
+
+/**
+ * @brief builds the mask keeping only the given individual fields
+ *
+ * @param hdr_ptr the header the records will be read with
+ * @param fields the tags of the individual fields to keep (e.g. GT, GQ and AD). Empty to keep all fields.
+ * @exception HeaderFieldNotFoundException if a field is not declared as an individual field in the header
+ */
+IndividualFieldMask individual_field_mask(const bcf_hdr_t* hdr_ptr, const std::vector<std::string>& fields);
+
+/**
+ * @brief removes the individual fields that are not in the mask from a record, compacting its individual block in place
+ *
+ * Nothing is decoded or allocated: each field is skipped using its encoded type and length. The fields kept
+ * stay in their original order. Fields added to the header after the mask was built are removed.
+ *
+ * @param record a record as read from the file (its individual block packed)
+ * @param keep the mask built by individual_field_mask() (empty keeps all fields)
+ */
+void project_individual_fields(bcf1_t* record, const IndividualFieldMask& keep);
+
 enum class AlleleType { REFERENCE, SNP, INSERTION, DELETION };
 
 using AlleleMask = std::vector<AlleleType>;
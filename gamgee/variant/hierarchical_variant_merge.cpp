@@ -0,0 +1,178 @@
+#include "hierarchical_variant_merge.h"
+#include "merged_variant_stream.h"
+#include "variant_iterator.h"
+
+#include "../exceptions.h"
+#include "../utils/hts_memory.h"
+#include "../utils/loser_tree.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <exception>
+#include <stdexcept>
+#include <thread>
+
+#include <unistd.h>
+
+using namespace std;
+
+namespace gamgee {
+
+namespace {
+
+/**
+ * @brief an input file of the first level of the merge
+ */
+struct FileSource {
+  VariantIterator iterator;
+  shared_ptr<bcf1_t> record;    ///< current record, swapped with the iterator's buffer on every advance
+  uint32_t input;
+
+  bool advance() {
+    if (iterator.empty())
+      return false;
+    record = iterator.exchange_record(move(record));
+    ++iterator;
+    return true;
+  }
+};
+
+/**
+ * @brief a stream written by the previous level of the merge
+ */
+struct StreamSource {
+  MergedVariantStreamReader reader;
+  shared_ptr<bcf1_t> record;
+  uint32_t input;
+
+  bool advance() { return reader.read(record.get(), input); }
+};
+
+uint64_t position_key(const bcf1_t* record) {
+  return (uint64_t{static_cast<uint32_t>(record->rid)} << 32) | static_cast<uint32_t>(record->pos + 1);
+}
+
+}  // end of anonymous namespace
+
+/**
+ * @brief merges the sources of a node into a stream, with the same loser tree ordering as MultipleVariantIterator
+ */
+template <class SOURCE>
+static void merge_sources(vector<SOURCE>& sources, const string& output) {
+  auto writer = MergedVariantStreamWriter{output};
+  auto keys = vector<uint64_t>{};
+  for (auto& source : sources)
+    keys.push_back(source.advance() ? position_key(source.record.get()) : utils::LoserTree::EXHAUSTED);
+  auto tree = utils::LoserTree{move(keys)};
+  while (!tree.empty()) {
+    auto& source = sources[tree.winner()];
+    writer.write(source.record.get(), source.input);
+    tree.replace_winner(source.advance() ? position_key(source.record.get()) : utils::LoserTree::EXHAUSTED);
+  }
+  writer.close();
+}
+
+static void merge_files(const vector<string>& filenames, const vector<shared_ptr<bcf_hdr_t>>& variant_headers, const uint32_t first, const uint32_t last, const string& output) {
+  auto sources = vector<FileSource>{};
+  sources.reserve(last - first);
+  for (auto input = first; input != last; ++input) {
+    const auto file = utils::make_shared_hts_file(bcf_open(filenames[input].c_str(), "r"));
+    if (!file)
+      throw FileOpenException{filenames[input]};
+    // the header was read when the merge was set up: read it again to get to the records, but decode them with the original
+    // (only this group's thread parses the input, so lines that vcf_parse adds to it are published to the reader by the join)
+    auto* header = bcf_hdr_read(file.get());
+    if (header == nullptr)
+      throw HeaderReadException{filenames[input]};
+    bcf_hdr_destroy(header);
+    sources.push_back(FileSource{VariantIterator{file, variant_headers[input]}, utils::make_shared_variant(bcf_init1()), input});
+  }
+  merge_sources(sources, output);
+}
+
+static void merge_streams(const vector<string>& streams, const uint32_t first, const uint32_t last, const string& output) {
+  auto sources = vector<StreamSource>{};
+  sources.reserve(last - first);
+  for (auto stream = first; stream != last; ++stream)
+    sources.push_back(StreamSource{MergedVariantStreamReader{streams[stream]}, utils::make_shared_variant(bcf_init1()), 0});
+  merge_sources(sources, output);
+}
+
+static string temporary_stream(const string& directory) {
+  auto path = directory;
+  if (path.empty()) {
+    const auto* tmpdir = getenv("TMPDIR");
+    path = tmpdir != nullptr && *tmpdir != '\0' ? tmpdir : "/tmp";
+  }
+  path += "/gamgee_merge_XXXXXX";
+  const auto fd = mkstemp(&path[0]);
+  if (fd < 0)
+    throw FileOpenException{path};
+  ::close(fd);
+  return path;
+}
+
+static void remove_files(const vector<string>& paths) {
+  for (const auto& path : paths)
+    std::remove(path.c_str());
+}
+
+vector<string> merge_variant_files_to_streams(const std::vector<std::string>& filenames, const std::vector<std::shared_ptr<bcf_hdr_t>>& variant_headers,
+                                              const uint32_t max_open_files, const uint32_t n_threads, const std::string& temporary_directory) {
+  if (max_open_files < 2)
+    throw invalid_argument{"a hierarchical merge needs to open at least 2 files per node"};
+  auto streams = vector<string>{};
+  auto n_inputs = static_cast<uint32_t>(filenames.size());
+  for (auto level = 0u; level == 0 || n_inputs > max_open_files; ++level) {
+    // groups of (almost) equal sizes
+    const auto n_groups = (n_inputs + max_open_files - 1) / max_open_files;
+    auto outputs = vector<string>{};
+    try {
+      for (auto group = 0u; group != n_groups; ++group)
+        outputs.push_back(temporary_stream(temporary_directory));
+    }
+    catch (...) {
+      remove_files(outputs);
+      remove_files(streams);
+      throw;
+    }
+    auto errors = vector<exception_ptr>(n_groups);
+    atomic<uint32_t> next_group {0};
+    const auto merge_groups = [&] {
+      for (auto group = next_group++; group < n_groups; group = next_group++) {
+        const auto first = static_cast<uint32_t>(uint64_t{n_inputs} * group / n_groups);
+        const auto last = static_cast<uint32_t>(uint64_t{n_inputs} * (group + 1) / n_groups);
+        try {
+          if (level == 0)
+            merge_files(filenames, variant_headers, first, last, outputs[group]);
+          else
+            merge_streams(streams, first, last, outputs[group]);
+        }
+        catch (...) {
+          errors[group] = current_exception();
+        }
+      }
+    };
+    auto threads = vector<thread>{};
+    for (auto i = 1u; i < min(max(n_threads, 1u), n_groups); ++i)
+      threads.emplace_back(merge_groups);
+    merge_groups();
+    for (auto& thread : threads)
+      thread.join();
+
+    remove_files(streams);
+    streams = move(outputs);
+    n_inputs = n_groups;
+    for (const auto& error : errors) {
+      if (error) {
+        remove_files(streams);
+        rethrow_exception(error);
+      }
+    }
+  }
+  return streams;
+}
+
+}  // end of namespace
@@ -0,0 +1,39 @@
+#ifndef gamgee__hierarchical_variant_merge__guard
+#define gamgee__hierarchical_variant_merge__guard
+
+#include "htslib/vcf.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace gamgee {
+
+/**
+ * @brief merges variant files in a tree of temporary merged streams, opening at most max_open_files inputs per node
+ *
+ * The files are merged in groups of at most max_open_files into temporary streams (see
+ * MergedVariantStreamWriter), then those streams in groups of at most max_open_files, and so on until at
+ * most max_open_files streams are left. The nodes of a level are merged in parallel by n_threads threads,
+ * so at most n_threads * (max_open_files + 1) files are open at once. The streams of a level are deleted
+ * as soon as the next level has merged them.
+ *
+ * Records keep their encoding and the index of their file, and records at the same position come out in
+ * file order: merging the remaining streams (MultipleVariantIterator does) gives the same result as
+ * merging all the files at once.
+ *
+ * @param filenames the variant files (vcf or bcf, not streams)
+ * @param variant_headers the headers of the files (records are decoded with them)
+ * @param max_open_files maximum number of inputs merged by a node (at least 2)
+ * @param n_threads number of nodes merged at the same time
+ * @param temporary_directory where the streams are created (empty for $TMPDIR, or /tmp)
+ * @return the paths of the remaining streams, which the caller must delete
+ * @exception std::invalid_argument if max_open_files is less than 2
+ * @exception FileOpenException, FileReadException or FileWriteException if a file can't be opened, read or written
+ */
+std::vector<std::string> merge_variant_files_to_streams(const std::vector<std::string>& filenames, const std::vector<std::shared_ptr<bcf_hdr_t>>& variant_headers,
+                                                        const uint32_t max_open_files, const uint32_t n_threads, const std::string& temporary_directory = "");
+
+}  // end of namespace
+
+#endif // gamgee__hierarchical_variant_merge__guard
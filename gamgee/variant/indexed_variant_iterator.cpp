@@ -1,8 +1,11 @@
 #include "indexed_variant_iterator.h"
 #include "variant_iterator.h"
+#include "../utils/bgzf_utils.h"
 
 #include "htslib/vcf.h"
 
+#include <algorithm>
+#include <limits>
 #include <memory>
 #include <string>
 #include <vector>
@@ -17,41 +20,117 @@ IndexedVariantIterator::IndexedVariantIterator() :
   m_variant_index_ptr {},
   m_interval_list {},
   m_interval_iter {},
+  m_contig_interval_list {},
+  m_contig_interval_iter {},
   m_index_iter_ptr {}
   {}
 
 IndexedVariantIterator::IndexedVariantIterator(const std::shared_ptr<htsFile>& file_ptr,
                                                const std::shared_ptr<hts_idx_t>& index_ptr,
                                                const std::shared_ptr<bcf_hdr_t>& header_ptr,
-                                               const std::vector<std::string>& interval_list) :
-  VariantIterator { file_ptr, header_ptr },
+                                               const std::vector<std::string>& interval_list,
+                                               const IndividualFieldMask& individual_fields) :
+  VariantIterator { file_ptr, header_ptr, individual_fields },
   m_variant_index_ptr { index_ptr },
   m_interval_list { interval_list.empty() ? all_intervals : interval_list },
   m_interval_iter { m_interval_list.begin() },
-  m_index_iter_ptr { utils::make_unique_hts_itr(bcf_itr_querys(m_variant_index_ptr.get(), m_variant_header_ptr.get(), m_interval_iter->c_str())) }
+  m_contig_interval_list {},
+  m_contig_interval_iter {},
+  m_index_iter_ptr { utils::make_unique_hts_itr(query_interval()) }
 {
   fetch_next_record();
 }
 
+IndexedVariantIterator::IndexedVariantIterator(const std::shared_ptr<htsFile>& file_ptr,
+                                               const std::shared_ptr<hts_idx_t>& index_ptr,
+                                               const std::shared_ptr<bcf_hdr_t>& header_ptr,
+                                               const std::vector<ContigInterval>& interval_list,
+                                               const IndividualFieldMask& individual_fields) :
+  VariantIterator { file_ptr, header_ptr, individual_fields },
+  m_variant_index_ptr { index_ptr },
+  m_interval_list {},
+  m_interval_iter {},
+  m_contig_interval_list { interval_list },
+  m_contig_interval_iter { m_contig_interval_list.begin() },
+  m_index_iter_ptr {}
+{
+  if (m_contig_interval_list.empty()) {
+    m_variant_file_ptr.reset();
+    m_variant_record = Variant{};
+    return;
+  }
+  m_index_iter_ptr.reset(query_interval());
+  fetch_next_record();
+}
+
 bool IndexedVariantIterator::operator!=(const IndexedVariantIterator& rhs) {
   return m_variant_file_ptr != rhs.m_variant_file_ptr &&
     m_index_iter_ptr != rhs.m_index_iter_ptr;
 }
 
+void IndexedVariantIterator::seek(const uint64_t offset) {
+  resume(IteratorCheckpoint{offset, interval_number()});
+}
+
+IteratorCheckpoint IndexedVariantIterator::checkpoint() const {
+  return IteratorCheckpoint{tell(), interval_number()};
+}
+
+void IndexedVariantIterator::resume(const IteratorCheckpoint& checkpoint) {
+  utils::seekable_bgzf(m_variant_file_ptr.get());  // fail before touching the iterator
+  if (checkpoint.interval >= (m_contig_interval_list.empty() ? m_interval_list.size() : m_contig_interval_list.size())) {
+    m_variant_file_ptr.reset();
+    m_variant_record = Variant{};
+    return;
+  }
+  if (m_contig_interval_list.empty())
+    m_interval_iter = m_interval_list.cbegin() + checkpoint.interval;
+  else
+    m_contig_interval_iter = m_contig_interval_list.cbegin() + checkpoint.interval;
+  m_index_iter_ptr.reset(query_interval());
+  utils::reposition_hts_iterator(m_index_iter_ptr.get(), m_variant_file_ptr.get(), checkpoint.offset);
+  fetch_next_record();
+}
+
+uint32_t IndexedVariantIterator::interval_number() const {
+  if (m_contig_interval_list.empty())
+    return m_interval_iter - m_interval_list.cbegin();
+  return m_contig_interval_iter - m_contig_interval_list.cbegin();
+}
+
 /**
  * @brief pre-fetches the next variant record
  * @warning we're reusing the existing htslib memory, so users should be aware that all objects from the previous iteration are now stale unless a deep copy has been performed
  */
 void IndexedVariantIterator::fetch_next_record() {
   while (bcf_itr_next(m_variant_file_ptr, m_index_iter_ptr.get(), m_variant_record_ptr.get()) < 0) {
-    ++m_interval_iter;
-    if (m_interval_list.end() == m_interval_iter) {
+    if (!next_interval()) {
       m_variant_file_ptr.reset();
       m_variant_record = Variant{};
       return;
     }
-    m_index_iter_ptr.reset(bcf_itr_querys(m_variant_index_ptr.get(), m_variant_header_ptr.get(), m_interval_iter->c_str()));
   }
+  trim_record();
+}
+
+hts_itr_t* IndexedVariantIterator::query_interval() const {
+  if (m_contig_interval_list.empty())
+    return bcf_itr_querys(m_variant_index_ptr.get(), m_variant_header_ptr.get(), m_interval_iter->c_str());
+  // htslib takes 0-based half-open coordinates
+  const auto& interval = *m_contig_interval_iter;
+  return bcf_itr_queryi(m_variant_index_ptr.get(), static_cast<int>(interval.contig), static_cast<int>(interval.start) - 1,
+      static_cast<int>(min<uint32_t>(interval.stop, numeric_limits<int>::max())));
+}
+
+bool IndexedVariantIterator::next_interval() {
+  if (m_contig_interval_list.empty()) {
+    if (++m_interval_iter == m_interval_list.end())
+      return false;
+  }
+  else if (++m_contig_interval_iter == m_contig_interval_list.end())
+    return false;
+  m_index_iter_ptr.reset(query_interval());
+  return true;
 }
 
 }
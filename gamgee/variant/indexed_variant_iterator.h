@@ -3,6 +3,7 @@
 
 #include "variant_iterator.h"
 
+#include "../contig_interval.h"
 #include "../utils/hts_memory.h"
 
 #include "htslib/vcf.h"
@@ -30,11 +31,28 @@ class IndexedVariantIterator : public VariantIterator {
    * @param index_ptr           shared pointer to a BCF file index (CSI) created with the bcf_index_load() macro from htslib
    * @param header_ptr          shared pointer to a BCF file header created with the bcf_hdr_read() macro from htslib
    * @param interval_list       vector of intervals represented by strings
+   * @param individual_fields   the individual fields to keep in each record (see individual_field_mask()), empty for all
    */
   IndexedVariantIterator(const std::shared_ptr<htsFile>& file_ptr,
                          const std::shared_ptr<hts_idx_t>& index_ptr,
                          const std::shared_ptr<bcf_hdr_t>& header_ptr,
-                         const std::vector<std::string>& interval_list = all_intervals);
+                         const std::vector<std::string>& interval_list = all_intervals,
+                         const IndividualFieldMask& individual_fields = IndividualFieldMask{});
+
+  /**
+   * @brief initializes a new iterator over compact intervals, queried without parsing region strings
+   *
+   * @param file_ptr            shared pointer to a BCF file opened via the bcf_open() macro from htslib
+   * @param index_ptr           shared pointer to a BCF file index (CSI) created with the bcf_index_load() macro from htslib
+   * @param header_ptr          shared pointer to a BCF file header created with the bcf_hdr_read() macro from htslib
+   * @param interval_list       intervals whose contig ids are the contig ids of header_ptr. Unlike the string version, an empty list yields no records.
+   * @param individual_fields   the individual fields to keep in each record (see individual_field_mask()), empty for all
+   */
+  IndexedVariantIterator(const std::shared_ptr<htsFile>& file_ptr,
+                         const std::shared_ptr<hts_idx_t>& index_ptr,
+                         const std::shared_ptr<bcf_hdr_t>& header_ptr,
+                         const std::vector<ContigInterval>& interval_list,
+                         const IndividualFieldMask& individual_fields = IndividualFieldMask{});
 
   /**
    * @brief an IndexedVariantIterator cannot be copied safely, as it is iterating over a stream.
@@ -60,6 +78,10 @@ class IndexedVariantIterator : public VariantIterator {
    */
   bool operator!=(const IndexedVariantIterator& rhs);
 
+  void seek(const uint64_t offset) override;                               ///< @brief continues the current interval from a virtual offset (e.g. one returned by tell())
+  IteratorCheckpoint checkpoint() const override;                          ///< @brief the position of the iterator (interval and offset), to be restored with resume()
+  void resume(const IteratorCheckpoint& checkpoint) override;              ///< @brief continues after the record that was current when checkpoint was taken (on an iterator over the same file and intervals)
+
  protected:
   void fetch_next_record() override;                                       ///< fetches next Variant record into existing htslib memory without making a copy
 
@@ -67,7 +89,13 @@ class IndexedVariantIterator : public VariantIterator {
   std::shared_ptr<hts_idx_t> m_variant_index_ptr;                          ///< pointer to the internal structure of the index file
   std::vector<std::string> m_interval_list;                                ///< vector of intervals represented by strings
   std::vector<std::string>::const_iterator m_interval_iter;                ///< iterator for the interval list
+  std::vector<ContigInterval> m_contig_interval_list;                      ///< compact intervals (used instead of m_interval_list when not empty)
+  std::vector<ContigInterval>::const_iterator m_contig_interval_iter;      ///< iterator for the compact interval list
   std::unique_ptr<hts_itr_t, utils::HtsIteratorDeleter> m_index_iter_ptr;  ///< pointer to the htslib BCF index iterator
+
+  hts_itr_t* query_interval() const;                                       ///< creates the htslib iterator for the current interval
+  bool next_interval();                                                    ///< moves to the next interval, returning false if there are none left
+  uint32_t interval_number() const;                                        ///< position of the current interval in the interval list
 };
 
 }
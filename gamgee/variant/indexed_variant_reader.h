@@ -2,9 +2,14 @@
 #define gamgee__indexed_variant_reader__guard
 
 #include "indexed_variant_iterator.h"
+#include "site_filtering_variant_iterator.h"
+#include "variant_decoding_options.h"
+#include "variant_site_predicate.h"
 
+#include "../contig_interval.h"
 #include "../exceptions.h"
 #include "../utils/hts_memory.h"
+#include "../utils/variant_utils.h"
 
 #include "htslib/vcf.h"
 
@@ -37,15 +42,43 @@ class IndexedVariantReader {
    *
    * @param filename the name of the variant file
    * @param interval_list a vector of intervals represented by strings.  Empty vector for all intervals.
+   * @param options which parts of every record to decode (by default, all of them)
+   * @exception HeaderFieldNotFoundException if one of options.individual_fields is not declared in the header
+   */
+  IndexedVariantReader(const std::string& filename, const std::vector<std::string>& interval_list, const VariantDecodingOptions& options = VariantDecodingOptions{}) :
+    m_variant_file_ptr {},
+    m_variant_index_ptr {},
+    m_variant_header_ptr {},
+    m_interval_list { interval_list },
+    m_contig_interval_list {},
+    m_use_contig_intervals { false },
+    m_individual_fields {}
+  {
+    init_reader(filename, options);
+  }
+
+  /**
+   * @brief reads through all records in a file overlapping compact intervals, parsing them into Variant objects
    *
+   * @param filename the name of the variant file
+   * @param interval_list intervals to look for records, in order. Unlike the string version, an empty vector yields no records.
+   * @param dictionary the contig dictionary of interval_list (it doesn't need to match the file header:
+   * contigs are matched by name and intervals on contigs missing from the file are skipped)
+   * @param options which parts of every record to decode (by default, all of them)
+   * @exception HeaderFieldNotFoundException if one of options.individual_fields is not declared in the header
    */
-  IndexedVariantReader(const std::string& filename, const std::vector<std::string>& interval_list) :
+  IndexedVariantReader(const std::string& filename, const std::vector<ContigInterval>& interval_list, const ContigDictionary& dictionary,
+                       const VariantDecodingOptions& options = VariantDecodingOptions{}) :
     m_variant_file_ptr {},
     m_variant_index_ptr {},
     m_variant_header_ptr {},
-    m_interval_list { interval_list }
+    m_interval_list {},
+    m_contig_interval_list {},
+    m_use_contig_intervals { true },
+    m_individual_fields {}
   {
-    init_reader(filename);
+    init_reader(filename, options);
+    init_contig_intervals(interval_list, dictionary);
   }
 
   /**
@@ -63,13 +96,38 @@ class IndexedVariantReader {
   IndexedVariantReader& operator=(IndexedVariantReader&& other) = default;
 
   ITERATOR begin() const {
-    return ITERATOR{ m_variant_file_ptr, m_variant_index_ptr, m_variant_header_ptr, m_interval_list };
+    if (m_use_contig_intervals)
+      return ITERATOR{ m_variant_file_ptr, m_variant_index_ptr, m_variant_header_ptr, m_contig_interval_list, m_individual_fields };
+    return ITERATOR{ m_variant_file_ptr, m_variant_index_ptr, m_variant_header_ptr, m_interval_list, m_individual_fields };
   }
 
   ITERATOR end() const {
     return ITERATOR{};
   }
 
+  /**
+   * @brief iterates over the records of the intervals passing a site predicate only, leaving the samples of the other records packed
+   *
+   * @param predicate site conditions compiled against header()
+   * @return a range to use in a for-each loop in place of the reader
+   */
+  SiteFilteredVariants<SiteFilteringVariantIterator<ITERATOR>> filter_sites(const VariantSitePredicate& predicate) const {
+    const auto file_ptr = m_variant_file_ptr;
+    const auto index_ptr = m_variant_index_ptr;
+    const auto header_ptr = m_variant_header_ptr;
+    const auto individual_fields = m_individual_fields;
+    if (m_use_contig_intervals) {
+      const auto interval_list = m_contig_interval_list;
+      return SiteFilteredVariants<SiteFilteringVariantIterator<ITERATOR>>{[file_ptr, index_ptr, header_ptr, interval_list, individual_fields, predicate] {
+        return SiteFilteringVariantIterator<ITERATOR>{predicate, file_ptr, index_ptr, header_ptr, interval_list, individual_fields};
+      }};
+    }
+    const auto interval_list = m_interval_list;
+    return SiteFilteredVariants<SiteFilteringVariantIterator<ITERATOR>>{[file_ptr, index_ptr, header_ptr, interval_list, individual_fields, predicate] {
+      return SiteFilteringVariantIterator<ITERATOR>{predicate, file_ptr, index_ptr, header_ptr, interval_list, individual_fields};
+    }};
+  }
+
   /**
    * @brief returns the variant header of the file being read
    */
@@ -80,8 +138,11 @@ class IndexedVariantReader {
   std::shared_ptr<hts_idx_t> m_variant_index_ptr;     ///< pointer to the internal structure of the index file
   std::shared_ptr<bcf_hdr_t> m_variant_header_ptr;    ///< pointer to the internal structure of the header file
   std::vector<std::string> m_interval_list;           ///< vector of intervals represented by strings
+  std::vector<ContigInterval> m_contig_interval_list; ///< compact intervals, with contig ids translated to the contig ids of the file
+  bool m_use_contig_intervals;                        ///< whether the reader was created with compact intervals
+  IndividualFieldMask m_individual_fields;            ///< individual fields kept in each record (empty for all)
 
-  void init_reader(const std::string& filename) {
+  void init_reader(const std::string& filename, const VariantDecodingOptions& options) {
     // Need to check raw pointers for null before wrapping them in a shared_ptr to avoid a segfault
     // during destruction if an exception is thrown
 
@@ -102,6 +163,23 @@ class IndexedVariantReader {
       throw HeaderReadException{filename};
     }
     m_variant_header_ptr = utils::make_shared_variant_header(header_ptr);
+
+    m_individual_fields = individual_field_mask(m_variant_header_ptr.get(), options.individual_fields);
+    if (options.unpack_level == VariantUnpackLevel::SITES_ONLY)
+      subset_variant_samples(m_variant_header_ptr.get(), std::vector<std::string>{}, true);
+  }
+
+  void init_contig_intervals(const std::vector<ContigInterval>& interval_list, const ContigDictionary& dictionary) {
+    auto contig_ids = std::vector<int>{};
+    contig_ids.reserve(dictionary.size());
+    for (const auto& contig : dictionary.names())
+      contig_ids.push_back(bcf_hdr_name2id(m_variant_header_ptr.get(), contig.c_str()));
+    m_contig_interval_list.reserve(interval_list.size());
+    for (const auto& interval : interval_list) {
+      const auto contig_id = contig_ids[interval.contig];
+      if (contig_id >= 0)
+        m_contig_interval_list.push_back(ContigInterval{static_cast<uint32_t>(contig_id), interval.start, interval.stop});
+    }
   }
 };
 
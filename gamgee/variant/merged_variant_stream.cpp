@@ -0,0 +1,90 @@
+#include "merged_variant_stream.h"
+
+#include "../exceptions.h"
+
+#include "htslib/kstring.h"
+
+using namespace std;
+
+namespace gamgee {
+
+constexpr auto FIXED_FIELDS_SIZE = 24u;   ///< bytes of CHROM, POS, rlen, QUAL, n_allele/n_info and n_fmt/n_sample, counted in the shared length of a BCF2 record
+
+/**
+ * @brief the fixed part of a stream record: the input, then the first 32 bytes of a BCF2 record
+ */
+struct MergedRecordPrefix {
+  uint32_t input;
+  uint32_t shared_length;
+  uint32_t individual_length;
+  int32_t chromosome;
+  int32_t position;
+  int32_t reference_length;
+  float qual;
+  uint32_t alleles_and_info;
+  uint32_t formats_and_samples;
+};
+
+MergedVariantStreamWriter::MergedVariantStreamWriter(const std::string& filename) :
+  m_filename {filename},
+  m_file {bgzf_open(filename.c_str(), "w1")}
+{
+  if (!m_file)
+    throw FileOpenException{filename};
+}
+
+void MergedVariantStreamWriter::write(const bcf1_t* record, const uint32_t input) {
+  const auto prefix = MergedRecordPrefix{input, static_cast<uint32_t>(record->shared.l + FIXED_FIELDS_SIZE), static_cast<uint32_t>(record->indiv.l),
+    record->rid, record->pos, record->rlen, record->qual,
+    static_cast<uint32_t>(record->n_allele) << 16 | record->n_info, static_cast<uint32_t>(record->n_fmt) << 24 | record->n_sample};
+  if (bgzf_write(m_file.get(), &prefix, sizeof(prefix)) != static_cast<ssize_t>(sizeof(prefix)) ||
+      bgzf_write(m_file.get(), record->shared.s, record->shared.l) != static_cast<ssize_t>(record->shared.l) ||
+      bgzf_write(m_file.get(), record->indiv.s, record->indiv.l) != static_cast<ssize_t>(record->indiv.l))
+    throw FileWriteException{m_filename};
+}
+
+void MergedVariantStreamWriter::close() {
+  if (m_file && bgzf_close(m_file.release()) != 0)
+    throw FileWriteException{m_filename};
+}
+
+MergedVariantStreamReader::MergedVariantStreamReader(const std::string& filename) :
+  m_filename {filename},
+  m_file {bgzf_open(filename.c_str(), "r")}
+{
+  if (!m_file)
+    throw FileOpenException{filename};
+}
+
+/**
+ * @brief the counterpart of htslib's BCF record reader, with the input index in front of the record
+ */
+bool MergedVariantStreamReader::read(bcf1_t* record, uint32_t& input) {
+  auto prefix = MergedRecordPrefix{};
+  const auto prefix_bytes = bgzf_read(m_file.get(), &prefix, sizeof(prefix));
+  if (prefix_bytes == 0)
+    return false;
+  if (prefix_bytes != static_cast<ssize_t>(sizeof(prefix)) || prefix.shared_length < FIXED_FIELDS_SIZE)
+    throw FileReadException{m_filename};
+  bcf_clear(record);
+  const auto shared_length = prefix.shared_length - FIXED_FIELDS_SIZE;
+  if (ks_resize(&record->shared, shared_length) < 0 || ks_resize(&record->indiv, prefix.individual_length) < 0)
+    throw bad_alloc{};
+  record->rid = prefix.chromosome;
+  record->pos = prefix.position;
+  record->rlen = prefix.reference_length;
+  record->qual = prefix.qual;
+  record->n_allele = prefix.alleles_and_info >> 16;
+  record->n_info = prefix.alleles_and_info & 0xffff;
+  record->n_fmt = prefix.formats_and_samples >> 24;
+  record->n_sample = prefix.formats_and_samples & 0xffffff;
+  record->shared.l = shared_length;
+  record->indiv.l = prefix.individual_length;
+  if (bgzf_read(m_file.get(), record->shared.s, record->shared.l) != static_cast<ssize_t>(record->shared.l) ||
+      bgzf_read(m_file.get(), record->indiv.s, record->indiv.l) != static_cast<ssize_t>(record->indiv.l))
+    throw FileReadException{m_filename};
+  input = prefix.input;
+  return true;
+}
+
+}  // end of namespace
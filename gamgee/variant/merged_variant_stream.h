@@ -0,0 +1,73 @@
+#ifndef gamgee__merged_variant_stream__guard
+#define gamgee__merged_variant_stream__guard
+
+#include "../utils/hts_memory.h"
+
+#include "htslib/bgzf.h"
+#include "htslib/vcf.h"
+
+#include <memory>
+#include <string>
+
+namespace gamgee {
+
+/**
+ * @brief Writes the records of several variant files, merged in order, to a temporary file (a node of a hierarchical merge).
+ *
+ * Each record is written in the binary layout of a BCF2 record (so it is decoded with the header of the
+ * file it comes from) preceded by the index of that file. The stream is BGZF compressed at level 1:
+ * it is read once, soon after it is written.
+ */
+class MergedVariantStreamWriter {
+ public:
+  /**
+   * @brief creates (or truncates) the stream
+   * @exception FileOpenException if the file cannot be created
+   */
+  explicit MergedVariantStreamWriter(const std::string& filename);
+
+  /**
+   * @brief appends a record read from input
+   * @note the record must be in its encoded form (as read, not modified through the unpacked fields)
+   * @exception FileWriteException if the record cannot be written
+   */
+  void write(const bcf1_t* record, const uint32_t input);
+
+  /**
+   * @brief flushes and closes the stream
+   * @exception FileWriteException if the end of the stream cannot be written
+   */
+  void close();
+
+ private:
+  std::string m_filename;
+  std::unique_ptr<BGZF, utils::BgzfDeleter> m_file;
+};
+
+/**
+ * @brief Reads the records of a stream written by MergedVariantStreamWriter, in order.
+ */
+class MergedVariantStreamReader {
+ public:
+  /**
+   * @exception FileOpenException if the file cannot be opened
+   */
+  explicit MergedVariantStreamReader(const std::string& filename);
+
+  /**
+   * @brief reads the next record into existing htslib memory
+   * @param record the record memory (its content is replaced)
+   * @param input set to the index of the file the record comes from
+   * @return false at the end of the stream
+   * @exception FileReadException if the stream ends in the middle of a record
+   */
+  bool read(bcf1_t* record, uint32_t& input);
+
+ private:
+  std::string m_filename;
+  std::unique_ptr<BGZF, utils::BgzfDeleter> m_file;
+};
+
+}  // end of namespace
+
+#endif // gamgee__merged_variant_stream__guard
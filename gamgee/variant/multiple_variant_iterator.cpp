@@ -1,15 +1,73 @@
 #include "multiple_variant_iterator.h"
 
+#include "../utils/hts_memory.h"
+
+#include <cstdio>
+
 namespace gamgee {
 
-MultipleVariantIterator::MultipleVariantIterator(const std::vector<std::shared_ptr<htsFile>>& variant_files, const std::vector<std::shared_ptr<bcf_hdr_t>>& variant_headers) :
-  m_queue {},
-  m_variant_vector {}
+constexpr auto RECORD_RING_SIZE = 4u;   ///< buffers per input: enough for a few records at one position plus the one being read, without allocations
+
+MultipleVariantIterator::MultipleVariantIterator(const std::vector<std::shared_ptr<htsFile>>& variant_files, const std::vector<std::shared_ptr<bcf_hdr_t>>& variant_headers, const uint32_t decoder_threads) :
+  m_iterators {},
+  m_prefetcher {},
+  m_streams {},
+  m_stream_inputs {},
+  m_next_records {},
+  m_tree {},
+  m_variant_vector {},
+  m_variant_headers {variant_headers},
+  m_record_rings(variant_files.size(), RecordRing{std::vector<std::shared_ptr<bcf1_t>>(RECORD_RING_SIZE), 0, RECORD_RING_SIZE})
 {
-  m_variant_vector.reserve(variant_files.size());
-  for (auto i = 0u; i < variant_files.size(); i++) {
-    m_queue.push(VariantIteratorIndexPair{std::make_shared<VariantIterator>(variant_files[i], variant_headers[i]), i});
+  if (decoder_threads == 0) {
+    m_iterators.reserve(variant_files.size());
+    for (auto i = 0u; i < variant_files.size(); i++)
+      m_iterators.emplace_back(variant_files[i], variant_headers[i]);
   }
+  else {
+    m_prefetcher.reset(new VariantPrefetcher{variant_files, variant_headers, decoder_threads});
+    for (auto i = 0u; i < variant_files.size(); i++)
+      m_next_records.push_back(m_prefetcher->next_record(i));
+  }
+  start_merge(variant_files.size());
+}
+
+MultipleVariantIterator::MultipleVariantIterator(const std::vector<std::string>& merged_streams, const std::vector<std::shared_ptr<bcf_hdr_t>>& variant_headers, const uint32_t) :
+  m_iterators {},
+  m_prefetcher {},
+  m_streams {},
+  m_stream_inputs(merged_streams.size(), 0),
+  m_next_records {},
+  m_tree {},
+  m_variant_vector {},
+  m_variant_headers {variant_headers},
+  // many records of a position can come from one stream: let the rings grow to one buffer per input
+  m_record_rings(merged_streams.size(), RecordRing{std::vector<std::shared_ptr<bcf1_t>>(RECORD_RING_SIZE), 0, static_cast<uint32_t>(variant_headers.size()) + RECORD_RING_SIZE})
+{
+  m_streams.reserve(merged_streams.size());
+  for (auto i = 0u; i != merged_streams.size(); ++i) {
+    try {
+      m_streams.emplace_back(merged_streams[i]);
+    }
+    catch (...) {
+      for (auto j = i; j != merged_streams.size(); ++j)   // the streams already open were removed below
+        std::remove(merged_streams[j].c_str());
+      throw;
+    }
+    std::remove(merged_streams[i].c_str());   // the stream is read through its open handle from now on
+  }
+  for (auto i = 0u; i < merged_streams.size(); i++)
+    m_next_records.push_back(read_stream_record(i));
+  start_merge(merged_streams.size());
+}
+
+void MultipleVariantIterator::start_merge(const uint32_t n_sources) {
+  m_variant_vector.reserve(m_variant_headers.size());
+  auto keys = std::vector<uint64_t>{};
+  keys.reserve(n_sources);
+  for (auto i = 0u; i < n_sources; i++)
+    keys.push_back(position_key(i));
+  m_tree = utils::LoserTree{std::move(keys)};
   fetch_next_vector();
 }
 
@@ -28,47 +86,81 @@ bool MultipleVariantIterator::operator!=(const MultipleVariantIterator& rhs) {
   return !(m_variant_vector.empty() && rhs.m_variant_vector.empty());
 }
 
-bool MultipleVariantIterator::Comparator::operator()(const VariantIteratorIndexPair& left, const VariantIteratorIndexPair& right) {
-  if ((**(left.first)).chromosome() > (**(right.first)).chromosome())
-    return true;
+uint64_t MultipleVariantIterator::position_key(const uint32_t source) {
+  if (m_iterators.empty()) {
+    const auto* record = m_next_records[source].get();
+    if (record == nullptr)
+      return utils::LoserTree::EXHAUSTED;
+    return (uint64_t{static_cast<uint32_t>(record->rid)} << 32) | static_cast<uint32_t>(record->pos + 1);
+  }
+  auto& iterator = m_iterators[source];
+  if (iterator.empty())
+    return utils::LoserTree::EXHAUSTED;
+  const auto& variant = *iterator;
+  return (uint64_t{variant.chromosome()} << 32) | variant.alignment_start();
+}
 
-  if ((**(left.first)).chromosome() < (**(right.first)).chromosome())
-    return false;
+std::shared_ptr<bcf1_t> MultipleVariantIterator::next_record(const uint32_t source) {
+  if (m_iterators.empty()) {
+    auto record = std::move(m_next_records[source]);
+    m_next_records[source] = m_prefetcher ? m_prefetcher->next_record(source) : read_stream_record(source);
+    return record;
+  }
+  auto& iterator = m_iterators[source];
+  auto record = take_record(iterator, source);
+  ++iterator;
+  return record;
+}
 
-  return (**(left.first)).alignment_start() > (**(right.first)).alignment_start();
+/**
+ * @brief like take_record(), reuses the buffers the Variants of the previous vectors released, but grows the ring
+ * (up to its capacity) rather than allocating a new buffer when the next one is still in use
+ */
+std::shared_ptr<bcf1_t> MultipleVariantIterator::read_stream_record(const uint32_t source) {
+  auto& ring = m_record_rings[source];
+  if (ring.buffers[ring.next].use_count() > 1 && ring.buffers.size() < ring.capacity)
+    ring.buffers.insert(ring.buffers.begin() + ring.next, nullptr);
+  auto& slot = ring.buffers[ring.next];
+  ring.next = (ring.next + 1) % ring.buffers.size();
+  if (!slot || slot.use_count() > 1)
+    slot = utils::make_shared_variant(bcf_init1());
+  if (!m_streams[source].read(slot.get(), m_stream_inputs[source]))
+    return nullptr;
+  return slot;
 }
 
+/**
+ * @brief pops every source whose current record is at the winning position, advancing each of them
+ */
 void MultipleVariantIterator::fetch_next_vector() {
   m_variant_vector.clear();
-  auto current_chrom = 0u;
-  auto current_start = 0u;
-
-  while (!m_queue.empty()) {
-    const auto top_queue_elem = m_queue.top();
-    const auto top_iterator = top_queue_elem.first;
-    const auto& variant = **top_iterator;
-
-    //top VariantIterator returns 'empty' Variant - no more variants in this VCF
-    if(variant.missing())
-    {
-      m_queue.pop();
-      continue;
-    }
-
-    if (!m_variant_vector.empty() && !(variant.chromosome() == current_chrom && variant.alignment_start() == current_start))
-      break;
-    else {
-      current_chrom = variant.chromosome();
-      current_start = variant.alignment_start();
-      m_variant_vector.push_back(VariantIndexPair{variant, top_queue_elem.second});
-
-      m_queue.pop();
-      top_iterator->operator++();
-      if (! top_iterator->empty())
-        m_queue.push(std::move(top_queue_elem));
-    }
+  if (m_tree.empty())
+    return;
+  const auto position = m_tree.winner_key();
+  while (m_tree.winner_key() == position) {
+    const auto source = m_tree.winner();
+    const auto input = m_streams.empty() ? source : m_stream_inputs[source];
+    m_variant_vector.emplace_back(Variant{m_variant_headers[input], next_record(source)}, input);
+    m_tree.replace_winner(position_key(source));
   }
 }
 
+/**
+ * @brief the iterator reads its next record into the oldest buffer of the ring while the record it hands over takes its slot
+ *
+ * Buffers are reused once the Variants of the vector they were handed to are gone (the ring holds the
+ * only reference). A buffer still in use (e.g. a Variant moved out of its vector) is left to its user
+ * and replaced in the ring by a new one.
+ */
+std::shared_ptr<bcf1_t> MultipleVariantIterator::take_record(VariantIterator& iterator, const uint32_t input) {
+  auto& ring = m_record_rings[input];
+  auto& slot = ring.buffers[ring.next];
+  ring.next = (ring.next + 1) % ring.buffers.size();
+  if (!slot || slot.use_count() > 1)
+    slot = utils::make_shared_variant(bcf_init1());
+  slot = iterator.exchange_record(std::move(slot));
+  return slot;
+}
+
 }
 
@@ -4,18 +4,28 @@
 #include "htslib/vcf.h"
 
 #include "variant.h"
+#include "merged_variant_stream.h"
 #include "variant_iterator.h"
+#include "variant_prefetcher.h"
+#include "../utils/loser_tree.h"
 
 #include <memory>
-#include <queue>
+#include <vector>
 
 namespace gamgee {
 
-using VariantIteratorIndexPair = std::pair<std::shared_ptr<VariantIterator>, uint32_t>;
 using VariantIndexPair = std::pair<Variant, uint32_t>;
 
 /**
  * @brief Utility class to enable for-each style iteration in the MultipleVariantReader class
+ *
+ * The inputs are merged with a loser tree (utils::LoserTree) keyed by the chromosome and start of the
+ * current record of each input, so a merge step costs log2(number of inputs) integer comparisons and
+ * scales to thousands of inputs.
+ *
+ * The inputs are decoded on the thread calling operator++, or ahead of it by a pool of decoder threads
+ * (VariantPrefetcher) when the iterator is given some. The iterator can also finish a hierarchical merge
+ * (merge_variant_files_to_streams()) by merging its temporary streams.
  */
 class MultipleVariantIterator {
  public:
@@ -30,8 +40,18 @@ class MultipleVariantIterator {
    *
    * @param variant_files   vector of vcf/bcf files opened via the bcf_open() macro from htslib
    * @param variant_headers vector of headers corresponding to the files
+   * @param decoder_threads number of threads decoding the inputs ahead of the merge (0 to decode them on demand on the calling thread)
    */
-  MultipleVariantIterator(const std::vector<std::shared_ptr<htsFile>>& variant_files, const std::vector<std::shared_ptr<bcf_hdr_t>>& variant_headers);
+  MultipleVariantIterator(const std::vector<std::shared_ptr<htsFile>>& variant_files, const std::vector<std::shared_ptr<bcf_hdr_t>>& variant_headers, const uint32_t decoder_threads = 0);
+
+  /**
+   * @brief initializes a new iterator merging the streams of a hierarchical merge (see merge_variant_files_to_streams())
+   *
+   * @param merged_streams  the streams left by the hierarchical merge (deleted once opened, or all deleted if one of them cannot be opened)
+   * @param variant_headers vector of headers of the files merged in the streams (the indices of the vectors refer to them)
+   * @param decoder_threads unused (the streams were merged in parallel already)
+   */
+  MultipleVariantIterator(const std::vector<std::string>& merged_streams, const std::vector<std::shared_ptr<bcf_hdr_t>>& variant_headers, const uint32_t decoder_threads = 0);
 
   /**
    * @brief a MultipleVariantIterator move constructor guarantees all objects will have the same state.
@@ -72,20 +92,55 @@ class MultipleVariantIterator {
   std::vector<VariantIndexPair>& operator++();
 
  private:
+  // record buffers of a source, handed over in turn to the Variants of the vectors
+  struct RecordRing {
+    std::vector<std::shared_ptr<bcf1_t>> buffers;
+    uint32_t next;
+    uint32_t capacity;   // number of buffers the ring can grow to when the buffers come back in use
+  };
+
   // fetches the next Variant vector
   void fetch_next_vector();
 
-  // comparison class for genomic locations in the priority queue
-  class Comparator {
-   public:
-    bool operator()(const VariantIteratorIndexPair& left, const VariantIteratorIndexPair& right);
-  };
+  // takes the current record of an input iterator without copying it, giving the iterator a free buffer of the input's ring
+  std::shared_ptr<bcf1_t> take_record(VariantIterator& iterator, const uint32_t input);
+
+  // reads the next record of a merged stream into a free buffer of its ring (nullptr at the end of the stream)
+  std::shared_ptr<bcf1_t> read_stream_record(const uint32_t source);
+
+  // the merge key of the current record of a source (an input, or a merged stream): chromosome, then start
+  uint64_t position_key(const uint32_t source);
 
-  // the individual file iterators
-  std::priority_queue<VariantIteratorIndexPair, std::vector<VariantIteratorIndexPair>, Comparator> m_queue;
+  // takes the current record of a source and advances it
+  std::shared_ptr<bcf1_t> next_record(const uint32_t source);
+
+  // the individual file iterators (when decoding on demand)
+  std::vector<VariantIterator> m_iterators;
+
+  // the decoder threads (when decoding ahead)
+  std::unique_ptr<VariantPrefetcher> m_prefetcher;
+
+  // the merged streams and the input of their current record (when finishing a hierarchical merge)
+  std::vector<MergedVariantStreamReader> m_streams;
+  std::vector<uint32_t> m_stream_inputs;
+
+  // the current record of each source (when decoding ahead or reading merged streams)
+  std::vector<std::shared_ptr<bcf1_t>> m_next_records;
+
+  // the tournament of the sources' current positions
+  utils::LoserTree m_tree;
 
   // caches next Variant vector
   std::vector<VariantIndexPair> m_variant_vector;
+
+  // the headers of the inputs, shared by the Variants of the vectors
+  std::vector<std::shared_ptr<bcf_hdr_t>> m_variant_headers;
+
+  // the record buffers of each source
+  std::vector<RecordRing> m_record_rings;
+
+  // builds the tournament and fetches the first vector
+  void start_merge(const uint32_t n_sources);
 };
 
 }  // end namespace gamgee
@@ -3,6 +3,7 @@
 
 #include "htslib/vcf.h"
 
+#include "hierarchical_variant_merge.h"
 #include "variant_header.h"
 #include "variant_header_merger.h"
 
@@ -10,6 +11,8 @@
 #include "../utils/hts_memory.h"
 #include "../utils/variant_utils.h"
 
+#include <stdexcept>
+
 namespace gamgee {
 
 /**
@@ -46,8 +49,12 @@ class MultipleVariantReader {
    * @param validate_headers should we validate that the header files have identical chromosomes?  default = true
    */
   explicit MultipleVariantReader(const std::vector<std::string>& filenames, const bool validate_headers = true) :
+    m_filenames { },
     m_variant_files { },
-    m_variant_headers { }
+    m_variant_headers { },
+    m_decoder_threads {0},
+    m_max_open_files {0},
+    m_temporary_directory { }
   {
     init_reader(filenames, validate_headers);
   }
@@ -62,13 +69,53 @@ class MultipleVariantReader {
    */
   MultipleVariantReader(const std::vector<std::string>& filenames, const bool validate_headers,
                         const std::vector<std::string>& samples, const bool include = true) :
+    m_filenames { },
     m_variant_files { },
-    m_variant_headers { }
+    m_variant_headers { },
+    m_decoder_threads {0},
+    m_max_open_files {0},
+    m_temporary_directory { }
   {
     init_reader(filenames, validate_headers);
     subset_variant_samples(m_variant_header_merger.get_raw_merged_header().get(), samples, include);
   }
 
+  /**
+   * @brief enables reading records in more files than can be open at once, with a hierarchical merge
+   *
+   * The files are only opened here to read their headers. Each iteration (begin()) first merges them in groups of at most
+   * max_open_files into temporary files, level after level, until at most max_open_files of those are left, which the
+   * iterator merges (see merge_variant_files_to_streams()). The groups of a level are merged in parallel by the decoder
+   * threads (see set_decoder_threads()). The iteration gives the same vectors as reading all the files at once, which is
+   * what this reader does when there are no more than max_open_files files.
+   *
+   * @param filenames the names of the variant files (not streams)
+   * @param validate_headers should we validate that the header files have identical chromosomes?
+   * @param max_open_files maximum number of files merged together (at least 2)
+   * @param temporary_directory where the temporary files go (empty for $TMPDIR, or /tmp)
+   * @exception std::invalid_argument if max_open_files is less than 2 or a filename is empty or "-" (stdin)
+   */
+  MultipleVariantReader(const std::vector<std::string>& filenames, const bool validate_headers, const uint32_t max_open_files,
+                        const std::string& temporary_directory = "") :
+    m_filenames { },
+    m_variant_files { },
+    m_variant_headers { },
+    m_decoder_threads {0},
+    m_max_open_files {filenames.size() > max_open_files ? max_open_files : 0},
+    m_temporary_directory {temporary_directory}
+  {
+    if (max_open_files < 2)
+      throw std::invalid_argument{"a hierarchical merge needs to open at least 2 files per node"};
+    if (m_max_open_files != 0) {
+      for (const auto& filename : filenames) {
+        if (filename.empty() || filename == "-")
+          throw std::invalid_argument{"standard input cannot be read by a hierarchical merge"};
+      }
+      m_filenames = filenames;
+    }
+    init_reader(filenames, validate_headers);
+  }
+
   /**
    * @brief helper function for constructors
    *
@@ -76,7 +123,9 @@ class MultipleVariantReader {
    * @param validate_headers should we validate that the header files have identical chromosomes?
    */
   void init_reader(const std::vector<std::string>& filenames, const bool validate_headers) {
-    m_variant_files.reserve(filenames.size());
+    // a hierarchical merge opens the files again in each iteration
+    const auto keep_files_open = m_max_open_files == 0;
+    m_variant_files.reserve(keep_files_open ? filenames.size() : 0);
     m_variant_headers.reserve(filenames.size());
 
     for (const auto& filename : filenames) {
@@ -85,7 +134,9 @@ class MultipleVariantReader {
       if ( file_ptr == nullptr ) {
         throw FileOpenException{filename};
       }
-      m_variant_files.push_back(std::move(utils::make_shared_hts_file(file_ptr)));
+      const auto file = utils::make_shared_hts_file(file_ptr);
+      if (keep_files_open)
+        m_variant_files.push_back(file);
 
       auto* header_raw_ptr = bcf_hdr_read(file_ptr);
       if ( header_raw_ptr == nullptr ) {
@@ -112,14 +163,29 @@ class MultipleVariantReader {
   MultipleVariantReader(const MultipleVariantReader&) = delete;
   MultipleVariantReader& operator=(const MultipleVariantReader& other) = delete;
 
+  /**
+   * @brief decodes the input files ahead of the merge in a pool of threads, each keeping a bounded queue of
+   * records per input filled (see VariantPrefetcher)
+   *
+   * @param n_threads number of decoder threads (0, the default, decodes the inputs on demand on the thread iterating)
+   * @note applies to the iterators created by the next calls to begin()
+   * @note in a hierarchical merge, these threads merge the groups of files of each level in parallel instead
+   */
+  void set_decoder_threads(const uint32_t n_threads) { m_decoder_threads = n_threads; }
+
   /**
    * @brief creates an ITERATOR pointing at the start of the input streams (needed by for-each
    * loop)
    *
    * @return an ITERATOR ready to start parsing the files
+   * @note with a hierarchical merge (see the max_open_files constructor), every call redoes the whole merge into new
+   * temporary files, which the iterator deletes as it opens them: iterate once if the files are large
    */
   ITERATOR begin() const {
-    return ITERATOR{m_variant_files, m_variant_headers};
+    if (m_max_open_files != 0)
+      return ITERATOR{merge_variant_files_to_streams(m_filenames, m_variant_headers, m_max_open_files, m_decoder_threads, m_temporary_directory),
+                      m_variant_headers, m_decoder_threads};
+    return ITERATOR{m_variant_files, m_variant_headers, m_decoder_threads};
   }
 
   /**
@@ -158,9 +224,13 @@ class MultipleVariantReader {
       throw HeaderCompatibilityException{"chromosomes in header files are inconsistent"};
   }
 
+  std::vector<std::string> m_filenames;                         ///< names of the variant files (in a hierarchical merge only)
   std::vector<std::shared_ptr<htsFile>> m_variant_files;        ///< vector of the internal file structures of the variant files
   std::vector<std::shared_ptr<bcf_hdr_t>> m_variant_headers;    ///< vector of the internal header structures of the variant files
   InputOrderedVariantHeaderMerger m_variant_header_merger;			///< merge headers and create LUTs for fields, samples,
+  uint32_t m_decoder_threads;                                   ///< number of threads decoding the inputs ahead of the iteration (0 for none)
+  uint32_t m_max_open_files;                                    ///< maximum number of files merged together (0 when all the files are read at once)
+  std::string m_temporary_directory;                            ///< where a hierarchical merge creates its temporary files
 
 };
 
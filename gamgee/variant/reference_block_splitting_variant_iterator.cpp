@@ -4,11 +4,25 @@
 
 namespace gamgee {
 
-ReferenceBlockSplittingVariantIterator::ReferenceBlockSplittingVariantIterator(const std::vector<std::shared_ptr<htsFile>>& variant_files, const std::vector<std::shared_ptr<bcf_hdr_t>>& variant_headers) :
-  MultipleVariantIterator {variant_files, variant_headers},
+ReferenceBlockSplittingVariantIterator::ReferenceBlockSplittingVariantIterator(const std::vector<std::shared_ptr<htsFile>>& variant_files, const std::vector<std::shared_ptr<bcf_hdr_t>>& variant_headers, const uint32_t decoder_threads) :
+  MultipleVariantIterator {variant_files, variant_headers, decoder_threads},
   m_pending_variants {},
-  m_split_variants {}
+  m_split_variants {},
+  m_deferred_splits {}
 {
+  start(variant_headers);
+}
+
+ReferenceBlockSplittingVariantIterator::ReferenceBlockSplittingVariantIterator(const std::vector<std::string>& merged_streams, const std::vector<std::shared_ptr<bcf_hdr_t>>& variant_headers, const uint32_t decoder_threads) :
+  MultipleVariantIterator {merged_streams, variant_headers, decoder_threads},
+  m_pending_variants {},
+  m_split_variants {},
+  m_deferred_splits {}
+{
+  start(variant_headers);
+}
+
+void ReferenceBlockSplittingVariantIterator::start(const std::vector<std::shared_ptr<bcf_hdr_t>>& variant_headers) {
   // will over-count for duplicate samples because we don't have access to the combined header
   // but that is not a big deal
   auto sample_count = 0u;
@@ -17,6 +31,7 @@ ReferenceBlockSplittingVariantIterator::ReferenceBlockSplittingVariantIterator(c
 
   m_pending_variants.reserve(sample_count);
   m_split_variants.reserve(sample_count);
+  m_deferred_splits.reserve(sample_count);
   fetch_next_split_vector();
 }
 
@@ -37,7 +52,8 @@ bool ReferenceBlockSplittingVariantIterator::operator!=(const ReferenceBlockSpli
 }
 
 void ReferenceBlockSplittingVariantIterator::populate_pending () {
-  for (const auto& variant_pair : MultipleVariantIterator::operator*()) {
+  // the incoming records are moved, not copied: they are not used anymore once the incoming vector is consumed
+  for (auto& variant_pair : MultipleVariantIterator::operator*()) {
     const auto& variant = variant_pair.first;
     m_pending_min_end = std::min(m_pending_min_end, variant.alignment_stop());
     m_pending_variants.push_back(std::move(variant_pair));
@@ -71,22 +87,20 @@ void ReferenceBlockSplittingVariantIterator::populate_split_variants () {
     auto& variant = variant_pair.first;
     auto var_end = variant.alignment_stop();
     // don't split reference blocks which end at the correct point
-    // or variants with actual alt alleles
-    if (var_end == m_pending_min_end || variant.alt().size() > 1) {
+    // or variants with actual alt alleles (more than REF and <NON_REF>)
+    if (var_end == m_pending_min_end || variant.n_alleles() > 2) {
       m_split_variants.push_back(std::move(variant_pair));
     }
     else {
-      // this is a reference block that extends past the desired end, so copy and split it
-      auto split_variant_pair = variant_pair;
-      auto& split_variant = split_variant_pair.first;
+      // this is a reference block that extends past the desired end: the split half shares its record
+      // and the pending half gets its own coordinates in apply_deferred_splits(), once the split vector is consumed
+      auto split_variant = variant.shallow_copy();
       split_variant.set_alignment_stop(m_pending_min_end);
-      m_split_variants.push_back(std::move(split_variant_pair));
+      m_split_variants.push_back(VariantIndexPair{std::move(split_variant), variant_pair.second});
 
       new_pending_start = m_pending_min_end + 1;
       new_pending_end = std::min(new_pending_end, var_end);
-      variant.set_alignment_start(new_pending_start);
-      variant.set_alignment_stop(var_end);      // stop is internally an offset to start, so we need to reset it after updating stop
-      variant.set_reference_allele(new_reference_allele);
+      m_deferred_splits.push_back(DeferredSplit{next_pending_index, var_end, m_split_variants.back().first.m_body});
 
       // check if variant is already in the right location
       if (next_pending_index != current_pending_index)
@@ -100,13 +114,29 @@ void ReferenceBlockSplittingVariantIterator::populate_split_variants () {
   if (new_pending_start != -1) {
     m_pending_start = new_pending_start;
     m_pending_min_end = new_pending_end;
+    m_deferred_reference_allele = new_reference_allele;
   }
 
   m_pending_variants.resize(next_pending_index);
 }
 
+void ReferenceBlockSplittingVariantIterator::apply_deferred_splits() {
+  for (const auto& split : m_deferred_splits) {
+    auto& variant = m_pending_variants[split.pending_index].first;
+    // the split half was moved out of its vector and kept: it must not see the changes below
+    if (!split.split_record.expired())
+      variant = Variant{variant};
+    variant.set_alignment_start(m_pending_start);
+    variant.set_alignment_stop(split.alignment_stop);   // stop is internally an offset to start, so we need to reset it after updating start
+    // a reference block is at least one base long: the allele is overwritten in place, without bcf_update_alleles
+    variant.set_reference_allele(m_deferred_reference_allele);
+  }
+  m_deferred_splits.clear();
+}
+
 void ReferenceBlockSplittingVariantIterator::fetch_next_split_vector() {
   m_split_variants.clear();
+  apply_deferred_splits();
   // run until we have split variants or the incoming pre-split vector is empty, indicating iteration is done
   // if the incoming vector is empty, we also end with an empty vector to indicate our iteration is done
   while (m_split_variants.empty() && ! MultipleVariantIterator::operator*().empty()) {
@@ -5,6 +5,7 @@
 #include "multiple_variant_iterator.h"
 
 #include <list>
+#include <memory>
 
 namespace gamgee {
 
@@ -12,6 +13,11 @@ namespace gamgee {
  * @brief Utility class to handle reference blocks while iterating over multiple variant files
  *
  * @warn This class is experimental/WIP
+ *
+ * Splitting a reference block doesn't copy its record: the half ending at the split point shares the record
+ * with the half left pending, whose coordinates are only moved past the split point when the iterator advances.
+ * If the split half was moved out of its vector and is still alive at that point, the pending half is given its
+ * own copy of the record first, so that Variants moved out of a split vector stay valid, as with MultipleVariantIterator.
  */
 class ReferenceBlockSplittingVariantIterator : public MultipleVariantIterator {
  public:
@@ -26,8 +32,18 @@ class ReferenceBlockSplittingVariantIterator : public MultipleVariantIterator {
    *
    * @param variant_files   vector of vcf/bcf files opened via the bcf_open() macro from htslib
    * @param variant_headers vector of variant headers corresponding to these files
+   * @param decoder_threads number of threads decoding the inputs ahead of the merge (0 to decode them on demand on the calling thread)
+   */
+  ReferenceBlockSplittingVariantIterator(const std::vector<std::shared_ptr<htsFile>>& variant_files, const std::vector<std::shared_ptr<bcf_hdr_t>>& variant_headers, const uint32_t decoder_threads = 0);
+
+  /**
+   * @brief initializes a new iterator merging the streams of a hierarchical merge (see merge_variant_files_to_streams())
+   *
+   * @param merged_streams  the streams left by the hierarchical merge (deleted once opened)
+   * @param variant_headers vector of headers of the files merged in the streams
+   * @param decoder_threads unused (the streams were merged in parallel already)
    */
-  ReferenceBlockSplittingVariantIterator(const std::vector<std::shared_ptr<htsFile>>& variant_files, const std::vector<std::shared_ptr<bcf_hdr_t>>& variant_headers);
+  ReferenceBlockSplittingVariantIterator(const std::vector<std::string>& merged_streams, const std::vector<std::shared_ptr<bcf_hdr_t>>& variant_headers, const uint32_t decoder_threads = 0);
 
   /**
    * @brief a ReferenceBlockSplittingVariantIterator move constructor guarantees all objects will have the same state.
@@ -68,6 +84,9 @@ class ReferenceBlockSplittingVariantIterator : public MultipleVariantIterator {
   std::vector<VariantIndexPair>& operator++();
 
  private:
+  // sizes the vectors and fetches the first split vector
+  void start(const std::vector<std::shared_ptr<bcf_hdr_t>>& variant_headers);
+
   // fetches the next reference-block-split Variant vector
   // calls populate_pending() and populate_split_variants() as needed
   void fetch_next_split_vector();
@@ -78,12 +97,27 @@ class ReferenceBlockSplittingVariantIterator : public MultipleVariantIterator {
   // populates the vector of split variants from the list of pending variants, modifying the pending list as well
   inline void populate_split_variants();
 
+  // moves the records of the blocks split by the last populate_split_variants() past the split point,
+  // now that the split vector sharing them has been consumed
+  inline void apply_deferred_splits();
+
   // holds the incoming reference-block variants before and during split operations
   std::vector<VariantIndexPair> m_pending_variants;
 
   // caches next reference-block-split Variant vector
   std::vector<VariantIndexPair> m_split_variants;
 
+  // a pending block split by the last populate_split_variants()
+  struct DeferredSplit {
+    uint32_t pending_index;                   // index in m_pending_variants
+    uint32_t alignment_stop;
+    std::weak_ptr<bcf1_t> split_record;       // record of the split half, expired once nobody holds that half
+  };
+  std::vector<DeferredSplit> m_deferred_splits;
+
+  // reference allele of the pending blocks split by the last populate_split_variants()
+  char m_deferred_reference_allele = 'N';
+
   unsigned int m_pending_chrom = UINT_MAX;
   unsigned int m_pending_start = UINT_MAX;
   unsigned int m_pending_min_end = UINT_MAX;
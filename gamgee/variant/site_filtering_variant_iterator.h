@@ -0,0 +1,140 @@
+#ifndef gamgee__site_filtering_variant_iterator__guard
+#define gamgee__site_filtering_variant_iterator__guard
+
+#include "variant_iterator.h"
+#include "variant_site_predicate.h"
+
+#include "htslib/hts.h"
+#include "htslib/kseq.h"
+#include "htslib/vcf.h"
+
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <string>
+#include <type_traits>
+
+namespace gamgee {
+
+/**
+ * @brief Iterator adaptor that only stops at records passing a VariantSitePredicate, decoding the samples of those records only.
+ *
+ * ITERATOR is the iterator being filtered: VariantIterator or IndexedVariantIterator. Each record read is
+ * tested right after its site columns are decoded:
+ *
+ * - BCF records are decoded lazily, so testing a record only unpacks the shared parts the predicate looks
+ *   at and the individual block of a rejected record is never unpacked.
+ * - VCF lines are parsed by htslib in one go, samples included. When reading a VCF file sequentially, this
+ *   iterator parses the site columns of each line alone (bcf1_t::max_unpack) and parses the whole line only
+ *   when the record passes.
+ *
+ * Get one from VariantReader::filter_sites() or IndexedVariantReader::filter_sites().
+ */
+template <class ITERATOR>
+class SiteFilteringVariantIterator : public ITERATOR {
+ public:
+
+  /**
+   * @brief creates an empty iterator (used for the end() method)
+   */
+  SiteFilteringVariantIterator() = default;
+
+  /**
+   * @brief initializes a new iterator on the records passing predicate
+   *
+   * @param predicate the site conditions, compiled against the header of the file
+   * @param iterator_args the arguments of the ITERATOR constructor (file, header, ...)
+   */
+  template <class... ITERATOR_ARGS>
+  explicit SiteFilteringVariantIterator(const VariantSitePredicate& predicate, const ITERATOR_ARGS&... iterator_args) :
+    ITERATOR {iterator_args...},
+    m_predicate {predicate},
+    m_site_columns {}
+  {
+    // the ITERATOR constructor has already fetched the first record, without the predicate
+    if (!this->empty() && !m_predicate(this->m_variant_record_ptr.get()))
+      fetch_next_record();
+  }
+
+  SiteFilteringVariantIterator(SiteFilteringVariantIterator&&) = default;
+  SiteFilteringVariantIterator& operator=(SiteFilteringVariantIterator&&) = default;
+  SiteFilteringVariantIterator(const SiteFilteringVariantIterator&) = delete;
+  SiteFilteringVariantIterator& operator=(const SiteFilteringVariantIterator&) = delete;
+
+ protected:
+  void fetch_next_record() override {
+    if (reads_text_sequentially()) {
+      fetch_next_text_record();
+      return;
+    }
+    do {
+      ITERATOR::fetch_next_record();
+    } while (!this->empty() && !m_predicate(this->m_variant_record_ptr.get()));
+  }
+
+ private:
+  VariantSitePredicate m_predicate;  ///< site conditions records must meet
+  std::string m_site_columns;        ///< copy of the site columns of the current VCF line (htslib tokenizes the line it parses in place)
+
+  bool reads_text_sequentially() const {
+    return std::is_same<ITERATOR, VariantIterator>::value && !this->m_variant_file_ptr->is_bin;
+  }
+
+  /**
+   * @brief the VCF counterpart of VariantIterator::fetch_next_record(), which only parses the samples of passing records
+   */
+  void fetch_next_text_record() {
+    auto* file = this->m_variant_file_ptr.get();
+    auto* header = this->m_variant_header_ptr.get();
+    auto* record = this->m_variant_record_ptr.get();
+    while (hts_getline(file, KS_SEP_LINE, &file->line) >= 0) {
+      if (!site_columns_pass(file->line, header, record))
+        continue;
+      if (vcf_parse(&file->line, header, record) < 0)
+        break;
+      this->trim_record();
+      return;
+    }
+    this->m_variant_file_ptr.reset();
+    this->m_variant_record = Variant{};
+  }
+
+  /**
+   * @brief parses the first 8 columns of a line into record and tests them
+   * @return true if the record passes or can't be parsed (the full parse will report it)
+   */
+  bool site_columns_pass(const kstring_t& line, const bcf_hdr_t* header, bcf1_t* record) {
+    auto end = line.s;
+    for (auto column = 0; column != 8 && end != nullptr; ++column) {
+      end = static_cast<char*>(std::memchr(end, '\t', line.s + line.l - end));
+      if (end != nullptr)
+        ++end;
+    }
+    const auto length = end == nullptr ? line.l : static_cast<size_t>(end - line.s - 1);
+    m_site_columns.assign(line.s, length);
+    auto site_line = kstring_t{m_site_columns.size(), m_site_columns.size() + 1, &m_site_columns[0]};
+    const auto max_unpack = record->max_unpack;
+    record->max_unpack = BCF_UN_SHR;
+    const auto status = vcf_parse(&site_line, header, record);
+    record->max_unpack = max_unpack;
+    return status < 0 || m_predicate(record);
+  }
+};
+
+/**
+ * @brief a range (begin() and end() for for-each loops) of SiteFilteringVariantIterator, returned by the readers' filter_sites()
+ */
+template <class ITERATOR>
+class SiteFilteredVariants {
+ public:
+  explicit SiteFilteredVariants(const std::function<ITERATOR()>& make_begin) : m_make_begin {make_begin} {}
+  ITERATOR begin() const { return m_make_begin(); }  ///< @brief an iterator at the first passing record
+  ITERATOR end() const { return ITERATOR{}; }        ///< @brief the end of the iteration
+
+ private:
+  std::function<ITERATOR()> m_make_begin;
+};
+
+}  // end of namespace
+
+#endif /* gamgee__site_filtering_variant_iterator__guard */
@@ -10,12 +10,14 @@ namespace gamgee {
 
 SyncedVariantIterator::SyncedVariantIterator() :
   m_synced_readers {},
-  m_variant_vector {}
+  m_variant_vector {},
+  m_record_buffers {}
 {}
 
 SyncedVariantIterator::SyncedVariantIterator(const std::shared_ptr<bcf_srs_t>& synced_readers) :
   m_synced_readers {synced_readers},
-  m_variant_vector {}
+  m_variant_vector {},
+  m_record_buffers(synced_readers->nreaders)
 {
   m_variant_vector.reserve(m_synced_readers->nreaders);
   fetch_next_record();
@@ -41,10 +43,9 @@ bool SyncedVariantIterator::operator!=(const SyncedVariantIterator& rhs) {
  */
 void SyncedVariantIterator::init_headers_vector() {
   m_headers_vector.reserve(m_synced_readers->nreaders);
-  for (int idx = 0; idx < m_synced_readers->nreaders; idx++) {
-    auto* hdr_ptr = utils::variant_header_deep_copy(bcf_sr_get_header(m_synced_readers.get(), idx));
-    m_headers_vector.emplace_back(utils::make_shared_variant_header(hdr_ptr));
-  }
+  // the headers belong to the synced readers: Variants keep the synced readers alive rather than copying the headers
+  for (int idx = 0; idx < m_synced_readers->nreaders; idx++)
+    m_headers_vector.emplace_back(m_synced_readers, bcf_sr_get_header(m_synced_readers.get(), idx));
 }
 
 /**
@@ -65,13 +66,22 @@ void SyncedVariantIterator::fetch_next_record() {
     init_headers_vector();
 
   for (int idx = 0; idx < m_synced_readers->nreaders; idx++) {
-    if (bcf_sr_has_line(m_synced_readers.get(), idx)) {
-      // can't cache variant bodies because they may change location in the synced reader
-      auto* body_ptr = utils::variant_deep_copy(bcf_sr_get_line(m_synced_readers.get(), idx));
-      m_variant_vector[idx] = Variant{m_headers_vector[idx], utils::make_shared_variant(body_ptr)};
-    }
+    if (bcf_sr_has_line(m_synced_readers.get(), idx))
+      m_variant_vector[idx] = Variant{m_headers_vector[idx], copy_line(idx)};
   }
 }
 
+/**
+ * @brief can't share the synced reader's record because it may change location in the synced reader, so the
+ * line is copied into the reader's buffer, or into a new one if a Variant of a previous vector still holds it
+ */
+std::shared_ptr<bcf1_t> SyncedVariantIterator::copy_line(const int reader) {
+  auto& buffer = m_record_buffers[reader];
+  if (!buffer || buffer.use_count() > 1)
+    buffer = utils::make_shared_variant(bcf_init1());
+  utils::variant_deep_copy(buffer.get(), bcf_sr_get_line(m_synced_readers.get(), reader));
+  return buffer;
+}
+
 }
 
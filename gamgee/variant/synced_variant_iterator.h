@@ -12,6 +12,10 @@ namespace gamgee {
 
 /**
  * @brief Utility class to enable for-each style iteration in the SyncedVariantReader class
+ *
+ * The synced readers reuse their records, so each line is copied out of them, into a buffer kept for its
+ * reader. A buffer is only recycled once no Variant refers to it anymore: the Variants of a vector stay
+ * valid after the iterator moves on, and buffers are only allocated while Variants of previous vectors are kept.
  */
 class SyncedVariantIterator {
  public:
@@ -70,9 +74,11 @@ class SyncedVariantIterator {
   std::shared_ptr<bcf_srs_t> m_synced_readers;                  ///< pointer to the synced readers of the variant files
   std::vector<Variant> m_variant_vector;                        ///< caches next Variant vector
   std::vector<std::shared_ptr<bcf_hdr_t>> m_headers_vector;     ///< caches each reader's htslib header
+  std::vector<std::shared_ptr<bcf1_t>> m_record_buffers;        ///< each reader's record buffer, reused when the Variants are done with it
 
   void init_headers_vector();                                   ///< initializes m_variant_headers
   void fetch_next_record();                                     ///< fetches next Variant vector
+  std::shared_ptr<bcf1_t> copy_line(const int reader);          ///< copies the current line of a reader into its buffer
 };
 
 }  // end namespace gamgee
@@ -3,11 +3,15 @@
 #include "individual_field_value.h"
 #include "shared_field.h"
 
+#include "../utils/genotype_utils.h"
 #include "../utils/hts_memory.h"
 #include "../utils/utils.h"
 
 #include "htslib/vcf.h"
 
+#include <limits>
+#include <stdexcept>
+
 using namespace std;
 namespace gamgee {
 
@@ -38,6 +42,18 @@ SharedField<FIELD_TYPE> Variant::shared_field_as(const INDEX_OR_TAG& p) const {
   return SharedField<FIELD_TYPE>{m_body, field_ptr};
 }
 
+/**
+ * @brief the index of the field of a handle in this record's header: the handle's index if the record was read
+ * with the handle's header, otherwise the tag is looked up (and type checked) as the getters by tag do
+ */
+template<class FIELD_TYPE, int32_t FIELD_CATEGORY>
+int32_t Variant::handle_index(const VariantFieldHandle<FIELD_TYPE, FIELD_CATEGORY>& handle) const {
+  if (handle.m_header == m_header.m_header)
+    return handle.m_index;
+  const auto index = m_header.field_index(handle.m_tag);
+  return check_field(FIELD_CATEGORY, utils::HtslibFieldType<FIELD_TYPE>::value, index) ? index : missing_values::int32;
+}
+
 AlleleType Variant::allele_type_from_difference(const int diff) const {
   if (diff == 0)
     return AlleleType::SNP;
@@ -62,11 +78,10 @@ Variant::Variant(const std::shared_ptr<bcf_hdr_t>& header, const std::shared_ptr
  * @brief creates a deep copy of a variant record
  *
  * @note does not perform a deep copy of the variant header; to copy the header,
- *       first get it via the header() function and then copy it via the usual C++
- *       semantics
+ *       first get it via the header() function and then clone() it
  */
 Variant::Variant(const Variant& other) :
-  m_header {other.m_header.m_header},   // Avoid a deep copy here by constructing using other's internal shared header pointer
+  m_header {other.m_header},   // headers are immutable and shared
   m_body {utils::make_shared_variant(utils::variant_deep_copy(other.m_body.get()))}
 {}
 
@@ -74,13 +89,12 @@ Variant::Variant(const Variant& other) :
  * @brief creates a deep copy of a variant record
  * @param other the Variant to be copied
  * @note does not perform a deep copy of the variant header; to copy the header,
- *       first get it via the header() function and then copy it via the usual C++
- *       semantics
+ *       first get it via the header() function and then clone() it
  */
 Variant& Variant::operator=(const Variant& other) {
   if ( &other == this )  
     return *this;
-  m_header = VariantHeader{other.m_header.m_header};    // Avoid a deep copy here by constructing using other's internal shared header pointer
+  m_header = other.m_header;    // headers are immutable and shared
   m_body = utils::make_shared_variant(utils::variant_deep_copy(other.m_body.get()));  ///< shared_ptr assignment will take care of deallocating old record if necessary
   return *this;
 }
@@ -183,6 +197,21 @@ IndividualField<IndividualFieldValue<std::string>> Variant::individual_field_as_
   return individual_field_as<string>(index);
 }
 
+IndividualField<IndividualFieldValue<int32_t>> Variant::individual_field(const IndividualFieldHandle<int32_t>& handle) const {
+  const auto index = handle_index(handle);
+  return gamgee::missing(index) ? IndividualField<IndividualFieldValue<int32_t>>{} : individual_field_as<int32_t>(index);
+}
+
+IndividualField<IndividualFieldValue<float>> Variant::individual_field(const IndividualFieldHandle<float>& handle) const {
+  const auto index = handle_index(handle);
+  return gamgee::missing(index) ? IndividualField<IndividualFieldValue<float>>{} : individual_field_as<float>(index);
+}
+
+IndividualField<IndividualFieldValue<string>> Variant::individual_field(const IndividualFieldHandle<string>& handle) const {
+  const auto index = handle_index(handle);
+  return gamgee::missing(index) ? IndividualField<IndividualFieldValue<string>>{} : individual_field_as<string>(index);
+}
+
 
 /******************************************************************************
  * Shared field API                                                           *
@@ -249,6 +278,21 @@ SharedField<string> Variant::shared_field_as_string(const int32_t index) const {
   return shared_field_as<string>(index);
 }
 
+SharedField<int32_t> Variant::shared_field(const SharedFieldHandle<int32_t>& handle) const {
+  const auto index = handle_index(handle);
+  return gamgee::missing(index) ? SharedField<int32_t>{} : shared_field_as<int32_t>(index);
+}
+
+SharedField<float> Variant::shared_field(const SharedFieldHandle<float>& handle) const {
+  const auto index = handle_index(handle);
+  return gamgee::missing(index) ? SharedField<float>{} : shared_field_as<float>(index);
+}
+
+SharedField<string> Variant::shared_field(const SharedFieldHandle<string>& handle) const {
+  const auto index = handle_index(handle);
+  return gamgee::missing(index) ? SharedField<string>{} : shared_field_as<string>(index);
+}
+
 IndividualField<Genotype> Variant::genotypes() const {
   // bcf_get_fmt() will unpack the record if necessary
   const auto fmt = bcf_get_fmt(m_header.m_header.get(), m_body.get(), "GT");
@@ -257,4 +301,46 @@ IndividualField<Genotype> Variant::genotypes() const {
   return IndividualField<Genotype>{m_body, fmt};
 }
 
+template<class ALLELE_TYPE>
+void Variant::decode_genotypes_as(const uint32_t ploidy, ALLELE_TYPE* alleles, uint8_t* phased) const {
+  if (n_alleles() > uint32_t(numeric_limits<ALLELE_TYPE>::max()) + 1)
+    throw invalid_argument("record has " + to_string(n_alleles()) + " alleles, too many for a genotype matrix of " + to_string(sizeof(ALLELE_TYPE)) + " byte alleles");
+  // bcf_get_fmt() will unpack the record if necessary
+  const auto fmt = bcf_get_fmt(m_header.m_header.get(), m_body.get(), "GT");
+  utils::decode_genotypes(fmt, n_samples(), ploidy, alleles, phased);
+}
+
+template<class ALLELE_TYPE>
+void Variant::decode_genotypes_as(const std::vector<Variant>& records, const uint32_t ploidy, ALLELE_TYPE* alleles, uint8_t* phased) {
+  if (records.empty())
+    return;
+  const auto n_samples = records.front().n_samples();
+  for (const auto& record : records) {
+    if (record.n_samples() != n_samples)
+      throw invalid_argument("records with " + to_string(record.n_samples()) + " and " + to_string(n_samples) + " samples can't share a genotype matrix");
+  }
+  for (const auto& record : records) {
+    record.decode_genotypes_as(ploidy, alleles, phased);
+    alleles += n_samples * ploidy;
+    if (phased != nullptr)
+      phased += n_samples;
+  }
+}
+
+void Variant::decode_genotypes(const uint32_t ploidy, int8_t* alleles, uint8_t* phased) const {
+  decode_genotypes_as(ploidy, alleles, phased);
+}
+
+void Variant::decode_genotypes(const uint32_t ploidy, int16_t* alleles, uint8_t* phased) const {
+  decode_genotypes_as(ploidy, alleles, phased);
+}
+
+void Variant::decode_genotypes(const std::vector<Variant>& records, const uint32_t ploidy, int8_t* alleles, uint8_t* phased) {
+  decode_genotypes_as(records, ploidy, alleles, phased);
+}
+
+void Variant::decode_genotypes(const std::vector<Variant>& records, const uint32_t ploidy, int16_t* alleles, uint8_t* phased) {
+  decode_genotypes_as(records, ploidy, alleles, phased);
+}
+
 }
@@ -41,14 +41,14 @@ class Variant {
    * @note does not deep copy the header; returned VariantHeader object shares existing memory
    */
   VariantHeader header() const {
-    // Avoid a deep copy here by constructing using VariantHeader's internal shared header pointer
-    return VariantHeader{m_header.m_header};
+    return m_header;
   }
 
   bool missing() const { return m_body == nullptr; }                 ///< returns true if this is a default-constructed Variant object with no data
 
   uint32_t chromosome()         const {return uint32_t(m_body->rid);}                                         ///< returns the integer representation of the chromosome. Notice that chromosomes are listed in index order with regards to the header (so a 0-based number). Similar to Picards getReferenceIndex()
-  std::string chromosome_name() const {return header().chromosomes()[chromosome()];}                          ///< returns the name of the chromosome by querying the header.
+  std::string chromosome_name() const {return m_header.get_chromosome_name(chromosome());}                   ///< returns the name of the chromosome by querying the header.
+  const char* chromosome_name_c_str() const {return m_header.get_chromosome_name_c_str(chromosome());}       ///< same as chromosome_name() without making a string (for per-record lookups). @note points into the header: valid as long as the header of this record exists
   uint32_t alignment_start()    const {return uint32_t(m_body->pos+1);}                                       ///< returns a 1-based alignment start position (as you would see in a VCF file). @note the internal encoding is 0-based to mimic that of the BCF files.
   uint32_t alignment_stop()     const {return uint32_t(m_body->pos + m_body->rlen);}                          ///< returns a 1-based alignment stop position, as you would see in a VCF INFO END tag, or the end position of the reference allele if there is no END tag.
   float    qual()               const {return m_body->qual;}                                                  ///< returns the Phred scaled site qual (probability that the site is not reference). See VCF spec.
@@ -77,6 +77,9 @@ class Variant {
   IndividualField<IndividualFieldValue<int32_t>> individual_field_as_integer(const int32_t index) const;       ///< same as integer_individual_field but will attempt to convert underlying data to integer if possible. @warning creates a new object but makes no copies of the underlying values.
   IndividualField<IndividualFieldValue<float>> individual_field_as_float(const int32_t index) const;           ///< same as float_individual_field but will attempt to convert underlying data to float if possible. @warning creates a new object but makes no copies of the underlying values.
   IndividualField<IndividualFieldValue<std::string>> individual_field_as_string(const int32_t index) const;    ///< same as string_individual_field but will attempt to convert underlying data to string if possible. @warning creates a new object but makes no copies of the underlying values.
+  IndividualField<IndividualFieldValue<int32_t>> individual_field(const IndividualFieldHandle<int32_t>& handle) const;         ///< same as integer_individual_field, without looking the field up again if this record was read with the handle's header. @warning creates a new object but makes no copies of the underlying values.
+  IndividualField<IndividualFieldValue<float>> individual_field(const IndividualFieldHandle<float>& handle) const;             ///< same as float_individual_field, without looking the field up again if this record was read with the handle's header. @warning creates a new object but makes no copies of the underlying values.
+  IndividualField<IndividualFieldValue<std::string>> individual_field(const IndividualFieldHandle<std::string>& handle) const; ///< same as string_individual_field, without looking the field up again if this record was read with the handle's header. @warning creates a new object but makes no copies of the underlying values.
 
   // shared field getters (a.k.a "info fields")
   bool boolean_shared_field(const std::string& tag) const;                       ///< whether or not the tag is present @note bools are treated specially as vector<bool> is impossible given the spec
@@ -93,6 +96,41 @@ class Variant {
   SharedField<int32_t> shared_field_as_integer(const int32_t index) const;       ///< same as integer_shared_field but will attempt to convert underlying data to integer if possible. @warning creates a new object but makes no copies of the underlying values.
   SharedField<float> shared_field_as_float(const int32_t index) const;           ///< same as float_shared_field but will attempt to convert underlying data to float if possible. @warning creates a new object but makes no copies of the underlying values.
   SharedField<std::string> shared_field_as_string(const int32_t index) const;    ///< same as string_shared_field but will attempt to convert underlying data to string if possible. @warning creates a new object but makes no copies of the underlying values.
+  SharedField<int32_t> shared_field(const SharedFieldHandle<int32_t>& handle) const;         ///< same as integer_shared_field, without looking the field up again if this record was read with the handle's header. @warning creates a new object but makes no copies of the underlying values.
+  SharedField<float> shared_field(const SharedFieldHandle<float>& handle) const;             ///< same as float_shared_field, without looking the field up again if this record was read with the handle's header. @warning creates a new object but makes no copies of the underlying values.
+  SharedField<std::string> shared_field(const SharedFieldHandle<std::string>& handle) const; ///< same as string_shared_field, without looking the field up again if this record was read with the handle's header. @warning creates a new object but makes no copies of the underlying values.
+
+  /**
+   * @brief decodes the genotypes (GT) of all samples of this record into a dense, caller-owned matrix
+   *
+   * Unlike genotypes(), this makes no Genotype objects and no vectors of allele keys: the raw GT values of
+   * all samples are decoded in one pass over the record, so that population-genetics code can work on
+   * plain arrays.
+   *
+   * ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+   * auto alleles = std::vector<int8_t>(record.n_samples() * 2);
+   * record.decode_genotypes(2, alleles.data());
+   * const auto alt_count = std::count_if(alleles.begin(), alleles.end(), [](const auto allele) { return allele > 0; });
+   * ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+   *
+   * @param ploidy the number of alleles per sample in the matrix (must be at least the ploidy of the GT field of this record)
+   * @param alleles the n_samples() * ploidy allele indices (0 for the reference), sample by sample. Missing alleles are GENOTYPE_MATRIX_MISSING_ALLELE and alleles past the ploidy of a sample are GENOTYPE_MATRIX_NO_ALLELE. All alleles are missing if the record has no GT field.
+   * @param phased the n_samples() phasing flags (1 if all the alleles of the sample are phased, as in 0|1), or nullptr if not needed
+   * @exception std::invalid_argument if the GT field of this record has a higher ploidy or the record has more alleles than the matrix type can hold (use the int16_t version above 127 alleles)
+   */
+  void decode_genotypes(const uint32_t ploidy, int8_t* alleles, uint8_t* phased = nullptr) const;
+  void decode_genotypes(const uint32_t ploidy, int16_t* alleles, uint8_t* phased = nullptr) const;  ///< @brief same as the int8_t version, for records with up to 32767 alleles
+
+  /**
+   * @brief decodes the genotypes (GT) of a batch of records with the same samples into a dense records x samples x ploidy matrix
+   *
+   * Row r of the matrix (n_samples * ploidy alleles) and of the phasing flags (n_samples flags) is filled by
+   * records[r].decode_genotypes(ploidy, ...).
+   *
+   * @exception std::invalid_argument if the records don't all have the same number of samples, or as decode_genotypes()
+   */
+  static void decode_genotypes(const std::vector<Variant>& records, const uint32_t ploidy, int8_t* alleles, uint8_t* phased = nullptr);
+  static void decode_genotypes(const std::vector<Variant>& records, const uint32_t ploidy, int16_t* alleles, uint8_t* phased = nullptr);  ///< @brief same as the int8_t version, for records with up to 32767 alleles
 
   /**
    * @brief functional-style set logic operations for variant field vectors
@@ -184,6 +222,9 @@ class Variant {
 
   template<class FIELD_TYPE, class INDEX_OR_TAG> SharedField<FIELD_TYPE> shared_field_as(const INDEX_OR_TAG& p) const;
   template<class FIELD_TYPE, class INDEX_OR_TAG> IndividualField<IndividualFieldValue<FIELD_TYPE>> individual_field_as(const INDEX_OR_TAG& p) const;
+  template<class FIELD_TYPE, int32_t FIELD_CATEGORY> int32_t handle_index(const VariantFieldHandle<FIELD_TYPE, FIELD_CATEGORY>& handle) const;
+  template<class ALLELE_TYPE> void decode_genotypes_as(const uint32_t ploidy, ALLELE_TYPE* alleles, uint8_t* phased) const;
+  template<class ALLELE_TYPE> static void decode_genotypes_as(const std::vector<Variant>& records, const uint32_t ploidy, ALLELE_TYPE* alleles, uint8_t* phased);
 
   friend class VariantWriter;
   friend class VariantBuilder; ///< builder needs access to the internals in order to build efficiently
@@ -192,6 +233,15 @@ class Variant {
 
   friend class ReferenceBlockSplittingVariantIterator;
 
+  /**
+   * @brief a Variant sharing this record: changes to one show in the other
+   * @note the copy has its own reference count (keeping this record alive), so that whether it still exists can be
+   * told apart from the other references to the record
+   */
+  inline Variant shallow_copy() const {
+    const auto body = m_body;
+    return Variant{m_header.m_header, std::shared_ptr<bcf1_t>{m_body.get(), [body](bcf1_t*) {}}};
+  }
   inline void set_alignment_start(const int32_t start) { m_body->pos = start - 1; }
   inline void set_alignment_stop(const int32_t end) { m_body->rlen = end - m_body->pos; }
 
@@ -0,0 +1,30 @@
+#ifndef gamgee__variant_decoding_options__guard
+#define gamgee__variant_decoding_options__guard
+
+#include "variant_unpack_level.h"
+
+#include <string>
+#include <vector>
+
+namespace gamgee {
+
+/**
+ * @brief which parts of every record an indexed variant reader decodes
+ *
+ * The defaults decode everything. Set only the members that matter:
+ *
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ * auto options = VariantDecodingOptions{};
+ * options.individual_fields = {"GT", "GQ"};
+ * for (const auto& record : IndexedVariantReader<IndexedVariantIterator>{filename, intervals, options})
+ *   ...
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ */
+struct VariantDecodingOptions {
+  VariantUnpackLevel unpack_level = VariantUnpackLevel::ALL;  ///< how much of every record to decode (see VariantUnpackLevel)
+  std::vector<std::string> individual_fields = {};            ///< the individual fields to keep (e.g. GT, GQ and AD), the others are dropped from each record as it is read. Empty for all fields.
+};
+
+}  // end of namespace
+
+#endif /* gamgee__variant_decoding_options__guard */
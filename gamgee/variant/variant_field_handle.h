@@ -0,0 +1,79 @@
+#ifndef gamgee__variant_field_handle__guard
+#define gamgee__variant_field_handle__guard
+
+#include "../missing.h"
+
+#include "htslib/vcf.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+namespace gamgee {
+
+namespace utils {
+
+/**
+ * @brief the htslib type (BCF_HT_*) of the fields that can be read as TYPE
+ */
+template <class TYPE> struct HtslibFieldType;
+template <> struct HtslibFieldType<int32_t>     { static constexpr int32_t value = BCF_HT_INT; };
+template <> struct HtslibFieldType<float>       { static constexpr int32_t value = BCF_HT_REAL; };
+template <> struct HtslibFieldType<std::string> { static constexpr int32_t value = BCF_HT_STR; };
+
+}  // end of namespace utils
+
+/**
+ * @brief a shared (INFO) or individual (FORMAT) field of type TYPE, looked up once in a header
+ *
+ * Getting a field by tag hashes the tag and checks the type the header declares for it on every record.
+ * A handle does both once, when it is obtained from VariantHeader::shared_field_handle() or
+ * VariantHeader::individual_field_handle(), so that Variant::shared_field() and
+ * Variant::individual_field() go straight to the field:
+ *
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ * auto reader = SingleVariantReader{"cohort.bcf"};
+ * const auto dp = reader.header().individual_field_handle<int32_t>("DP");
+ * for (const auto& record : reader)
+ *   for (const auto& sample_dp : record.individual_field(dp))
+ *     ...
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ *
+ * Records read with another header (e.g. from the other inputs of a MultipleVariantReader) are still
+ * served correctly: the tag is looked up and checked in their header, as with the getters by tag.
+ *
+ * @tparam TYPE int32_t, float or std::string
+ * @tparam FIELD_CATEGORY BCF_HL_INFO or BCF_HL_FMT
+ */
+template <class TYPE, int32_t FIELD_CATEGORY>
+class VariantFieldHandle {
+ public:
+  VariantFieldHandle() : m_header {}, m_tag {}, m_index {missing_values::int32} {}  ///< @brief a handle on no field: getters return empty fields
+  VariantFieldHandle(const VariantFieldHandle&) = default;
+  VariantFieldHandle(VariantFieldHandle&&) = default;
+  VariantFieldHandle& operator=(const VariantFieldHandle&) = default;
+  VariantFieldHandle& operator=(VariantFieldHandle&&) = default;
+
+  const std::string& tag() const { return m_tag; }     ///< @brief the tag of the field
+  int32_t index() const { return m_index; }            ///< @brief the index of the field in the header the handle was obtained from
+  bool missing() const { return gamgee::missing(m_index); }  ///< @brief whether the field is not declared in the header the handle was obtained from
+
+ private:
+  std::shared_ptr<bcf_hdr_t> m_header;  ///< the header the index belongs to (kept alive so that its address can't be reused)
+  std::string m_tag;                    ///< to look the field up in the headers of records read with another header
+  int32_t m_index;
+
+  VariantFieldHandle(const std::shared_ptr<bcf_hdr_t>& header, const std::string& tag, const int32_t index) :
+    m_header {header}, m_tag {tag}, m_index {index}
+  {}
+
+  friend class VariantHeader;
+  friend class Variant;
+};
+
+template <class TYPE> using SharedFieldHandle = VariantFieldHandle<TYPE, BCF_HL_INFO>;     ///< @brief a handle on a shared (INFO) field
+template <class TYPE> using IndividualFieldHandle = VariantFieldHandle<TYPE, BCF_HL_FMT>;  ///< @brief a handle on an individual (FORMAT) field
+
+}  // end of namespace
+
+#endif /* gamgee__variant_field_handle__guard */
@@ -7,6 +7,9 @@
 #include <vector>
 #include <utility>
 #include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <unordered_map>
 
 #include <iostream>
 
@@ -14,39 +17,21 @@ namespace gamgee {
 
 using namespace std;
 
-/**
- * @brief simple function to plow through all the hrec's and find the ones that match the type tag
- */
-static vector<string> find_fields_of_type(bcf_hdr_t* h, int type) {
-  auto result = vector<string>{};
-  for (auto i = 0; i != h->nhrec; ++i) {
-    if (h->hrec[i]->type == type)
-      result.emplace_back(*(h->hrec[i]->vals));
-  }
-  return result;
-}
-
-static uint32_t count_fields_of_type(const bcf_hdr_t* h, const int type) {
-  auto count = 0u;
-  for ( auto i = 0; i != h->nhrec; ++i ) {
-    if ( h->hrec[i]->type == type )
-      ++count;
-  }
-  return count;
-}
-
 VariantHeader::VariantHeader(const VariantHeader& other) :
-  m_header {utils::make_shared_variant_header(utils::variant_header_deep_copy(other.m_header.get()))} 
+  m_header {other.m_header},
+  m_name_tables {atomic_load(&other.m_name_tables)}
 {}
 
 VariantHeader::VariantHeader(VariantHeader&& other) noexcept :
-  m_header {move(other.m_header)}
+  m_header {move(other.m_header)},
+  m_name_tables {move(other.m_name_tables)}
 {}
 
 VariantHeader& VariantHeader::operator=(const VariantHeader& other) {
-  if ( &other == this )  
+  if (&other == this)
     return *this;
-  m_header = utils::make_shared_variant_header(utils::variant_header_deep_copy(other.m_header.get())); ///< shared_ptr assignment will take care of deallocating old sam record if necessary
+  m_header = other.m_header;
+  m_name_tables = atomic_load(&other.m_name_tables);
   return *this;
 }
 
@@ -57,25 +42,32 @@ VariantHeader& VariantHeader::operator=(VariantHeader&& other) noexcept {
   if (&other == this)
     return *this;
   m_header = move(other.m_header);
+  m_name_tables = move(other.m_name_tables);
   return *this;
 }
 
+VariantHeader VariantHeader::clone() const {
+  return VariantHeader{utils::make_shared_variant_header(utils::variant_header_deep_copy(m_header.get()))};
+}
+
 bool VariantHeader::operator==(const VariantHeader& rhs) const {
   // compare names
-  if (samples() != rhs.samples()) return false;
-  if (chromosomes() != rhs.chromosomes()) return false;
-  if (filters() != rhs.filters()) return false;
-  if (shared_fields() != rhs.shared_fields()) return false;
-  if (individual_fields() != rhs.individual_fields()) return false;
+  const auto& tables = name_tables();
+  const auto& rhs_tables = rhs.name_tables();
+  if (tables.samples != rhs_tables.samples) return false;
+  if (tables.chromosomes != rhs_tables.chromosomes) return false;
+  if (tables.filters != rhs_tables.filters) return false;
+  if (tables.shared_fields != rhs_tables.shared_fields) return false;
+  if (tables.individual_fields != rhs_tables.individual_fields) return false;
 
   // can't use index here because filters/shared/individual indices depend on the insertion order of the others
 
-  for (const auto& field : shared_fields()) {
+  for (const auto& field : tables.shared_fields) {
     if (shared_field_type(field) != rhs.shared_field_type(field))
       return false;
   }
 
-  for (const auto& field : individual_fields()) {
+  for (const auto& field : tables.individual_fields) {
     if (individual_field_type(field) != rhs.individual_field_type(field))
       return false;
   }
@@ -85,44 +77,152 @@ bool VariantHeader::operator==(const VariantHeader& rhs) const {
   return true;
 }
 
+VariantHeader::HeaderSizes VariantHeader::header_sizes() const {
+  return HeaderSizes{{m_header->nhrec, m_header->n[BCF_DT_ID], m_header->n[BCF_DT_CTG], m_header->n[BCF_DT_SAMPLE]}};
+}
+
+/**
+ * @brief the name tables of one htslib header, in every version built so far
+ *
+ * htslib adds header lines for the undeclared contigs and fields it meets when parsing VCF text, so a new version
+ * of the tables is built when the size of the header changes. The older versions are kept, so that references
+ * handed out earlier stay valid as long as the header.
+ */
+class VariantHeader::NameTableCache {
+ public:
+  NameTableCache() : m_latest {nullptr}, m_mutex {}, m_versions {} {}
+
+  const NameTables& tables(const bcf_hdr_t* header, const HeaderSizes& sizes) {
+    const auto* latest = m_latest.load(memory_order_acquire);
+    if (latest != nullptr && latest->header_sizes == sizes)
+      return *latest;
+    lock_guard<mutex> lock {m_mutex};
+    if (!m_versions.empty() && m_versions.back()->header_sizes == sizes)
+      return *m_versions.back();
+    m_versions.push_back(build(header, sizes));
+    m_latest.store(m_versions.back().get(), memory_order_release);
+    return *m_versions.back();
+  }
+
+ private:
+  atomic<const NameTables*> m_latest;                    ///< the last version built (lock-free fast path)
+  mutex m_mutex;                                         ///< serializes builds
+  vector<unique_ptr<const NameTables>> m_versions;       ///< every version built, oldest first
+
+  /**
+   * @brief builds the tables by plowing through all the hrec's once and sorting their names by type
+   */
+  static unique_ptr<const NameTables> build(const bcf_hdr_t* header, const HeaderSizes& sizes) {
+    auto built = unique_ptr<NameTables>{new NameTables{}};
+    built->header_sizes = sizes;
+    built->samples = utils::hts_string_array_to_vector(header->samples, uint32_t(bcf_hdr_nsamples(header)));
+    for (auto i = 0; i != header->nhrec; ++i) {
+      const auto* hrec = header->hrec[i];
+      switch (hrec->type) {
+        case BCF_HL_CTG:  built->chromosomes.emplace_back(*(hrec->vals)); break;
+        case BCF_HL_FLT:  built->filters.emplace_back(*(hrec->vals)); break;
+        case BCF_HL_INFO: built->shared_fields.emplace_back(*(hrec->vals)); break;
+        case BCF_HL_FMT:  built->individual_fields.emplace_back(*(hrec->vals)); break;
+        default: break;
+      }
+    }
+    return move(built);
+  }
+};
+
+namespace {
+
+/**
+ * @brief the caches of the live htslib headers, by address
+ *
+ * A cache is kept as long as its header is alive, whatever VariantHeaders, Variants or readers hold the header and
+ * however their shared_ptrs were made (e.g. aliasing the synced readers that own it). Entries of headers that
+ * were freed are dropped as the registry grows, before their address can be confused with a new header's.
+ */
+template <class CACHE>
+class NameTableRegistry {
+ public:
+  shared_ptr<CACHE> find(const shared_ptr<bcf_hdr_t>& header) {
+    lock_guard<mutex> lock {m_mutex};
+    auto& entry = m_entries[header.get()];
+    if (entry.first.expired() || !entry.second) {  // new header, maybe at the address of a freed one
+      entry = make_pair(weak_ptr<bcf_hdr_t>{header}, make_shared<CACHE>());
+      if (m_entries.size() >= 2 * m_swept_size)
+        sweep();
+    }
+    return entry.second;
+  }
+
+ private:
+  mutex m_mutex;
+  unordered_map<const bcf_hdr_t*, pair<weak_ptr<bcf_hdr_t>, shared_ptr<CACHE>>> m_entries;
+  size_t m_swept_size = 32;  ///< number of entries after the last sweep (at least 32, so small programs never sweep)
+
+  void sweep() {
+    for (auto entry = m_entries.begin(); entry != m_entries.end(); ) {
+      if (entry->second.first.expired())
+        entry = m_entries.erase(entry);
+      else
+        ++entry;
+    }
+    m_swept_size = max<size_t>(m_entries.size(), 32);
+  }
+};
+
+}  // end of anonymous namespace
+
 /**
- * This implementation is simply transforming the char ** representation of the sample names into a 
- * contiguous vector<string>. As efficient as it gets.
+ * @brief the tables of the htslib header, finding the cache shared by all the VariantHeaders on it the first time
  */
-vector<string> VariantHeader::samples() const {
-  return utils::hts_string_array_to_vector(m_header->samples, uint32_t(bcf_hdr_nsamples(m_header)));
+const VariantHeader::NameTables& VariantHeader::name_tables() const {
+  static NameTableRegistry<NameTableCache> registry;
+  auto cache = atomic_load(&m_name_tables);
+  if (!cache) {
+    cache = registry.find(m_header);
+    atomic_store(&m_name_tables, cache);
+  }
+  return cache->tables(m_header.get(), header_sizes());
 }
 
-vector<string> VariantHeader::chromosomes() const {
-  return find_fields_of_type(m_header.get(), BCF_HL_CTG);
+const vector<string>& VariantHeader::samples() const {
+  return name_tables().samples;
+}
+
+const vector<string>& VariantHeader::chromosomes() const {
+  return name_tables().chromosomes;
 }
 
 uint32_t VariantHeader::n_chromosomes() const {
-  return count_fields_of_type(m_header.get(), BCF_HL_CTG);
+  return name_tables().chromosomes.size();
+}
+
+uint32_t VariantHeader::chromosome_length(const std::string& chromosome) const {
+  const auto id = bcf_hdr_name2id(m_header.get(), chromosome.c_str());
+  return id < 0 ? 0 : m_header->id[BCF_DT_CTG][id].val->info[0];
 }
 
-vector<string> VariantHeader::filters() const {
-  return find_fields_of_type(m_header.get(), BCF_HL_FLT);
+const vector<string>& VariantHeader::filters() const {
+  return name_tables().filters;
 }
 
 uint32_t VariantHeader::n_filters() const {
-  return count_fields_of_type(m_header.get(), BCF_HL_FLT);
+  return name_tables().filters.size();
 }
 
-vector<string> VariantHeader::shared_fields() const {
-  return find_fields_of_type(m_header.get(), BCF_HL_INFO);
+const vector<string>& VariantHeader::shared_fields() const {
+  return name_tables().shared_fields;
 }
 
 uint32_t VariantHeader::n_shared_fields() const {
-  return count_fields_of_type(m_header.get(), BCF_HL_INFO);
+  return name_tables().shared_fields.size();
 }
 
-vector<string> VariantHeader::individual_fields() const {
-  return find_fields_of_type(m_header.get(), BCF_HL_FMT);
+const vector<string>& VariantHeader::individual_fields() const {
+  return name_tables().individual_fields;
 }
 
 uint32_t VariantHeader::n_individual_fields() const {
-  return count_fields_of_type(m_header.get(), BCF_HL_FMT);
+  return name_tables().individual_fields.size();
 }
 
 }
@@ -1,11 +1,15 @@
 #ifndef gamgee__variant_header__guard
 #define gamgee__variant_header__guard
 
+#include "variant_field_handle.h"
+
 #include "htslib/vcf.h"
 
 #include "../missing.h"
 
+#include <array>
 #include <memory>
+#include <stdexcept>
 #include <string>
 #include <vector>
 
@@ -48,17 +52,32 @@ class VariantHeaderMerger;  //forward declaration to declare friendship in Varia
  * for (auto idx = 0u; idx < header.field_index_end(); ++idx)
  *   if (header.has_individual_field(idx))
  *     do_something_with_field(variant.integer_individual_field(idx));
+ *
+ * Copies of a VariantHeader share the underlying htslib header: copying the header of a file with many samples
+ * costs nothing. They are not snapshots, though: a copy of a reader's header (e.g. auto header = reader.header())
+ * sees the lines htslib adds to it while the file is read, as it does for the undeclared contigs and fields of VCF
+ * text. Use clone() to get an independent snapshot, and a VariantHeaderBuilder (which works on its own copy) to
+ * derive a modified header.
+ *
+ * The name vectors (samples(), chromosomes(), filters(), ...) are built together the first time one of them is
+ * needed, in a cache that every VariantHeader on the same htslib header shares (e.g. the ones Variant::header()
+ * returns), and rebuilt if htslib adds header lines, as it does for undeclared contigs and fields when parsing VCF
+ * text. The accessors return references into the cache, which stay valid as long as the htslib header exists (a
+ * rebuild doesn't free the previous vectors). Lookups of a single name or index go to the htslib dictionaries
+ * directly (field_index(), chromosome_index(), get_chromosome_name_c_str(), ...) and allocate nothing.
  */
 class VariantHeader {
  public:
   VariantHeader() = default;                                                             ///< @brief initializes a null VariantHeader @warning if you need to create a VariantHeader from scratch, use the builder instead
   explicit VariantHeader(const std::shared_ptr<bcf_hdr_t>& header) : m_header{header} {} ///< @brief creates a VariantHeader given htslib object. @note used by all iterators
-  VariantHeader(const VariantHeader& other);                                             ///< @brief makes a deep copy of a VariantHeader. Shared pointers maintain state to all other associated objects correctly.
+  VariantHeader(const VariantHeader& other);                                             ///< @brief makes a VariantHeader sharing the htslib header of other (no copy is made, so later changes to it show in both) @note use clone() for a snapshot
   VariantHeader(VariantHeader&& other) noexcept;                                         ///< @brief moves VariantHeader accordingly. Shared pointers maintain state to all other associated objects correctly.
-  VariantHeader& operator=(const VariantHeader& other);                                  ///< @brief deep copy assignment of a VariantHeader. Shared pointers maintain state to all other associated objects correctly.
+  VariantHeader& operator=(const VariantHeader& other);                                  ///< @brief shares the htslib header of other (no copy is made, so later changes to it show in both)
   VariantHeader& operator=(VariantHeader&& other) noexcept;                              ///< @brief move assignment of a VariantHeader. Shared pointers maintain state to all other associated objects correctly.
   ~VariantHeader() = default;
 
+  VariantHeader clone() const;                                                           ///< @brief makes a deep copy of the underlying htslib header: a snapshot that later changes to this header don't affect, or that can be modified
+
   /**
    * @brief equality operators
    * @param rhs the other VariantHeader to compare to
@@ -68,10 +87,11 @@ class VariantHeader {
   bool operator==(const VariantHeader& rhs) const;
   bool operator!=(const VariantHeader& rhs) const { return !operator==(rhs); }
 
-  std::vector<std::string> samples() const;           ///< @brief builds a vector with the names of the samples
+  const std::vector<std::string>& samples() const; ///< @brief the names of the samples @note valid as long as the htslib header exists
   uint32_t n_samples() const { return uint32_t(bcf_hdr_nsamples(m_header.get())); };  ///< @brief returns the number of samples in the header  @note much faster than getting the actual list of samples
-  std::vector<std::string> chromosomes() const;       ///< @brief builds a vector with the contigs
+  const std::vector<std::string>& chromosomes() const; ///< @brief the names of the contigs @note valid as long as the htslib header exists
   uint32_t n_chromosomes() const;                     ///< @brief returns the number of chromosomes declared in this header
+  uint32_t chromosome_length(const std::string& chromosome) const; ///< @brief returns the length declared for a chromosome (0 if the chromosome is not declared or has no length)
 
   /**
   * @brief returns the last valid field index + 1, to indicate the end of field iteration
@@ -88,21 +108,21 @@ class VariantHeader {
   * @warn do not use for iteration over filter indices -- use field_index_end() instead
   */
   uint32_t n_filters() const;
-  std::vector<std::string> filters() const;           ///< @brief returns a vector of filter names
+  const std::vector<std::string>& filters() const; ///< @brief the filter names @note valid as long as the htslib header exists
 
   /**
   * @brief returns the number of shared fields declared in this header
   * @warn do not use for iteration over filter indices -- use field_index_end() instead
   */
   uint32_t n_shared_fields() const;
-  std::vector<std::string> shared_fields() const;     ///< @brief returns a vector of shared field names
+  const std::vector<std::string>& shared_fields() const; ///< @brief the shared field names @note valid as long as the htslib header exists
 
   /**
   * @brief returns the number of individual fields declared in this header
   * @warn do not use for iteration over filter indices -- use field_index_end() instead
   */
   uint32_t n_individual_fields() const;
-  std::vector<std::string> individual_fields() const; ///< @brief returns a vector of individual field names
+  const std::vector<std::string>& individual_fields() const; ///< @brief the individual field names @note valid as long as the htslib header exists
 
   // type checking functions: returns BCF_HT_FLAG, BCF_HT_INT, BCF_HT_REAL, BCF_HT_STR from htslib/vcf.h
   uint8_t shared_field_type(const std::string& tag) const { return field_type(field_index(tag), BCF_HL_INFO); }     ///< @brief returns the type of this shared (INFO) field  @note must check whether the field exists before calling this function, as it doesn't check for you
@@ -221,6 +241,15 @@ class VariantHeader {
     return index >= 0 ? index : missing_values::int32;
   }
 
+  /**
+   * @brief looks up the index of a chromosome, i.e. the value Variant::chromosome() returns for records on it
+   * @return missing_values::int32_t if the chromosome is not declared in the header (you can use missing() on the return value to check)
+   */
+  int32_t chromosome_index(const std::string& chromosome) const {
+    const auto index = bcf_hdr_name2id(m_header.get(), chromosome.c_str());
+    return index >= 0 ? index : missing_values::int32;
+  }
+
   /**
    * @brief looks up the index of a particular sample, enabling subsequent O(1) random-access lookups for that sample throughout the iteration.
    * @return missing_values::int32_t if the tag is not present in the header (you can use missing() on the return value to check)
@@ -231,7 +260,31 @@ class VariantHeader {
     return index >= 0 ? index : missing_values::int32;
   }
 
-  std::string get_field_name(const int32_t field_idx) const {
+  /**
+   * @brief looks up a shared (INFO) field once, for Variant::shared_field() to read it without looking it up on every record
+   * @tparam TYPE int32_t, float or std::string
+   * @return a handle that is missing() if the field is not declared in this header
+   * @exception std::runtime_error if the field is not declared with the type TYPE stands for
+   */
+  template <class TYPE>
+  SharedFieldHandle<TYPE> shared_field_handle(const std::string& tag) const { return field_handle<TYPE, BCF_HL_INFO>(tag); }
+
+  /**
+   * @brief looks up an individual (FORMAT) field once, for Variant::individual_field() to read it without looking it up on every record
+   * @copydetails shared_field_handle
+   */
+  template <class TYPE>
+  IndividualFieldHandle<TYPE> individual_field_handle(const std::string& tag) const { return field_handle<TYPE, BCF_HL_FMT>(tag); }
+
+  std::string get_field_name(const int32_t field_idx) const { return get_field_name_c_str(field_idx); }                 ///< @brief the name of a field ("" if the index is not valid)
+  std::string get_chromosome_name(const int32_t chromosome_idx) const { return get_chromosome_name_c_str(chromosome_idx); } ///< @brief the name of a chromosome ("" if the index is not valid)
+  std::string get_sample_name(const int32_t sample_idx) const { return get_sample_name_c_str(sample_idx); }                ///< @brief the name of a sample ("" if the index is not valid)
+
+  /**
+   * @brief the name of a field, without making a string ("" if the index is not valid)
+   * @note points into the htslib header: valid as long as this header (or a copy) exists
+   */
+  const char* get_field_name_c_str(const int32_t field_idx) const {
     if(field_idx >= 0 && field_idx < m_header->n[BCF_DT_ID])
     {
       auto name_ptr = bcf_hdr_int2id(m_header.get(), BCF_DT_ID, field_idx);
@@ -241,7 +294,25 @@ class VariantHeader {
     return "";
   }
 
-  std::string get_sample_name(const int32_t sample_idx) const {
+  /**
+   * @brief the name of a chromosome, without making a string ("" if the index is not valid)
+   * @note points into the htslib header: valid as long as this header (or a copy) exists
+   */
+  const char* get_chromosome_name_c_str(const int32_t chromosome_idx) const {
+    if(chromosome_idx >= 0 && chromosome_idx < m_header->n[BCF_DT_CTG])
+    {
+      auto name_ptr = bcf_hdr_id2name(m_header.get(), chromosome_idx);
+      if(name_ptr)
+	return name_ptr;
+    }
+    return "";
+  }
+
+  /**
+   * @brief the name of a sample, without making a string ("" if the index is not valid)
+   * @note points into the htslib header: valid as long as this header (or a copy) exists
+   */
+  const char* get_sample_name_c_str(const int32_t sample_idx) const {
     if(sample_idx >= 0 && sample_idx < m_header->n[BCF_DT_SAMPLE])
     {
       auto name_ptr= bcf_hdr_int2id(m_header.get(), BCF_DT_SAMPLE, sample_idx);
@@ -252,7 +323,37 @@ class VariantHeader {
   }
 
  private:
+  using HeaderSizes = std::array<int32_t, 4>;  ///< number of header lines, ids, contigs and samples
+
+  /**
+   * @brief the names of the header lines of each kind, in header order
+   */
+  struct NameTables {
+    std::vector<std::string> samples;
+    std::vector<std::string> chromosomes;
+    std::vector<std::string> filters;
+    std::vector<std::string> shared_fields;
+    std::vector<std::string> individual_fields;
+    HeaderSizes header_sizes;  ///< sizes of the htslib header when the tables were built, to notice added lines
+  };
+
+  class NameTableCache;  ///< the tables of one htslib header, shared by all the VariantHeaders on it
+
   std::shared_ptr<bcf_hdr_t> m_header;
+  mutable std::shared_ptr<NameTableCache> m_name_tables;  ///< found the first time the tables are needed
+
+  const NameTables& name_tables() const;
+  HeaderSizes header_sizes() const;
+
+  template <class TYPE, int32_t FIELD_CATEGORY>
+  VariantFieldHandle<TYPE, FIELD_CATEGORY> field_handle(const std::string& tag) const {
+    auto index = field_index(tag);
+    if (!has_field(index, FIELD_CATEGORY))
+      index = missing_values::int32;
+    else if (field_type(index, FIELD_CATEGORY) != utils::HtslibFieldType<TYPE>::value)
+      throw std::runtime_error("field requested is not of the right type");
+    return VariantFieldHandle<TYPE, FIELD_CATEGORY>{m_header, tag, index};
+  }
 
   friend class Variant;
   friend class VariantWriter;
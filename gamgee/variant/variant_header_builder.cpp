@@ -25,7 +25,7 @@ VariantHeaderBuilder::VariantHeaderBuilder() noexcept :
 {}
 
 VariantHeaderBuilder::VariantHeaderBuilder(const VariantHeader& header) :
-  m_header {utils::make_shared_variant_header(utils::variant_header_deep_copy(header.m_header.get()))}
+  m_header {header.clone().m_header}   // the builder modifies its header, which other VariantHeaders may share
 {}
 
 VariantHeaderBuilder& VariantHeaderBuilder::add_chromosome(const string& id, const string& length, const string& url, const string& extra) {
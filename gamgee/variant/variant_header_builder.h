@@ -60,7 +60,7 @@ class VariantHeaderBuilder {
   VariantHeader build() const {
     // Need to sync the header before returning it so that changes will be reflected in the final product
     bcf_hdr_sync(m_header.get());
-    return VariantHeader{utils::make_shared_variant_header(utils::variant_header_deep_copy(m_header.get()))};
+    return VariantHeader{m_header}.clone();
   }
 
   /**
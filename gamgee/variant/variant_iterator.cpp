@@ -2,16 +2,18 @@
 #include "variant.h"
 
 #include "../utils/hts_memory.h"
+#include "../utils/bgzf_utils.h"
 
 using namespace std;
 
 namespace gamgee {
 
-VariantIterator::VariantIterator(const std::shared_ptr<htsFile>& variant_file_ptr, const std::shared_ptr<bcf_hdr_t>& variant_header_ptr) :
+VariantIterator::VariantIterator(const std::shared_ptr<htsFile>& variant_file_ptr, const std::shared_ptr<bcf_hdr_t>& variant_header_ptr, const IndividualFieldMask& individual_fields) :
   m_variant_file_ptr {variant_file_ptr},
   m_variant_header_ptr {variant_header_ptr},
   m_variant_record_ptr {utils::make_shared_variant(bcf_init1())},      ///< important to initialize the record buffer in the constructor so we can reuse it across the iterator
-  m_variant_record {m_variant_header_ptr, m_variant_record_ptr}
+  m_variant_record {m_variant_header_ptr, m_variant_record_ptr},
+  m_individual_fields {individual_fields}
 {
   fetch_next_record();
 }
@@ -33,6 +35,29 @@ bool VariantIterator::empty() const {
   return !m_variant_file_ptr;
 }
 
+uint64_t VariantIterator::tell() const {
+  return utils::bgzf_position(m_variant_file_ptr.get());
+}
+
+void VariantIterator::seek(const uint64_t offset) {
+  utils::bgzf_reposition(m_variant_file_ptr.get(), offset);
+  fetch_next_record();
+}
+
+std::shared_ptr<bcf1_t> VariantIterator::exchange_record(std::shared_ptr<bcf1_t> buffer) {
+  swap(m_variant_record_ptr, buffer);
+  m_variant_record = Variant{m_variant_header_ptr, m_variant_record_ptr};
+  return buffer;
+}
+
+IteratorCheckpoint VariantIterator::checkpoint() const {
+  return IteratorCheckpoint{tell(), 0};
+}
+
+void VariantIterator::resume(const IteratorCheckpoint& checkpoint) {
+  seek(checkpoint.offset);
+}
+
 /**
  * @brief pre-fetches the next variant record
  * @warning we're reusing the existing htslib memory, so users should be aware that all objects from the previous iteration are now stale unless a deep copy has been performed
@@ -41,7 +66,25 @@ void VariantIterator::fetch_next_record() {
  if (bcf_read1(m_variant_file_ptr.get(), m_variant_header_ptr.get(), m_variant_record_ptr.get()) < 0) {
     m_variant_file_ptr.reset();
     m_variant_record = Variant{};
+    return;
+  }
+  trim_record();
+}
+
+/**
+ * @brief drops the individual fields that were not selected and makes BCF records of a sites-only reader sites-only
+ *
+ * bcf_hdr_set_samples() with no samples makes vcf_parse skip the FORMAT columns, but BCF records keep
+ * the individual block they were read with (and their sample count).
+ */
+void VariantIterator::trim_record() {
+  auto* record = m_variant_record_ptr.get();
+  if (record->n_sample != 0 && bcf_hdr_nsamples(m_variant_header_ptr.get()) == 0) {
+    record->indiv.l = 0;
+    record->n_sample = 0;
+    record->n_fmt = 0;
   }
+  project_individual_fields(record, m_individual_fields);
 }
 
 }
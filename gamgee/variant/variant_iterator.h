@@ -2,6 +2,8 @@
 #define gamgee__variant_iterator__guard
 
 #include "variant.h"
+#include "../iterator_checkpoint.h"
+#include "../utils/variant_utils.h"
 
 #include "htslib/vcf.h"
 
@@ -25,8 +27,9 @@ class VariantIterator {
    *
    * @param variant_file_ptr   shared pointer to a vcf/bcf file opened via the bcf_open() macro from htslib
    * @param variant_header_ptr shared pointer to a vcf/bcf file header created with the bcf_hdr_read() macro from htslib
+   * @param individual_fields  the individual fields to keep in each record (see individual_field_mask()), empty for all
    */
-  VariantIterator(const std::shared_ptr<htsFile>& variant_file_ptr, const std::shared_ptr<bcf_hdr_t>& variant_header_ptr);
+  VariantIterator(const std::shared_ptr<htsFile>& variant_file_ptr, const std::shared_ptr<bcf_hdr_t>& variant_header_ptr, const IndividualFieldMask& individual_fields = IndividualFieldMask{});
 
   /**
    * @brief a VariantIterator move constructor guarantees all objects will have the same state.
@@ -80,13 +83,41 @@ class VariantIterator {
    */
   bool empty() const;
 
+  /**
+   * @brief the virtual offset right after the current record, where the next record starts
+   * @exception FileSeekException if the file is not a BCF file or the iteration is over
+   */
+  uint64_t tell() const;
+
+  /**
+   * @brief moves to the record starting at a virtual offset (e.g. one returned by tell()), which becomes the current record
+   * @exception FileSeekException if the file is not a BCF file or the offset is not in the file
+   */
+  virtual void seek(const uint64_t offset);
+
+  /**
+   * @brief hands the memory of the current record over without copying it, and continues in another buffer
+   *
+   * The following records are read into buffer, so the record handed over stays valid when the iterator
+   * advances. Until then, operator*() refers to the content of buffer.
+   *
+   * @param buffer record memory to read the next records into (its content is discarded), e.g. a record handed over earlier that is not used anymore
+   * @return the memory of the current record
+   */
+  std::shared_ptr<bcf1_t> exchange_record(std::shared_ptr<bcf1_t> buffer);
+
+  virtual IteratorCheckpoint checkpoint() const;                  ///< @brief the position of the iterator, to be restored with resume()
+  virtual void resume(const IteratorCheckpoint& checkpoint);      ///< @brief continues after the record that was current when checkpoint was taken (on an iterator over the same file)
+
  protected:
   std::shared_ptr<htsFile> m_variant_file_ptr;          ///< pointer to the vcf/bcf file
   std::shared_ptr<bcf_hdr_t> m_variant_header_ptr;      ///< pointer to the variant header
   std::shared_ptr<bcf1_t> m_variant_record_ptr;         ///< pointer to the internal structure of the variant record. Useful to only allocate it once.
   Variant m_variant_record;                             ///< temporary record to hold between fetch (operator++) and serve (operator*)
+  IndividualFieldMask m_individual_fields;              ///< individual fields kept in each record (empty for all)
 
   virtual void fetch_next_record();                     ///< fetches next Variant record into existing htslib memory without making a copy
+  void trim_record();                                   ///< drops the per-sample data of the record just read that the reader was told not to keep (all of it when the header has no samples)
 };
 
 }  // end namespace gamgee
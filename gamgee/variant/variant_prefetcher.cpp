@@ -0,0 +1,144 @@
+#include "variant_prefetcher.h"
+
+#include "../utils/hts_memory.h"
+
+#include <algorithm>
+#include <atomic>
+
+using namespace std;
+
+namespace gamgee {
+
+constexpr uint32_t VariantPrefetcher::DEFAULT_LOOKAHEAD;
+constexpr uint32_t VariantPrefetcher::NO_WORKER;
+
+constexpr auto CONSUMER_RECORDS = 4u;   ///< buffers of an input the consumer may still hold when the ring comes back to them (current record, last vectors)
+
+VariantPrefetcher::VariantPrefetcher(const std::vector<std::shared_ptr<htsFile>>& variant_files, const std::vector<std::shared_ptr<bcf_hdr_t>>& variant_headers,
+                                     const uint32_t n_threads, const uint32_t lookahead) :
+  m_inputs {},
+  m_workers {},
+  m_lookahead {max(lookahead, 1u)}
+{
+  const auto n_binary = count_if(variant_files.begin(), variant_files.end(), [](const shared_ptr<htsFile>& file) { return file->is_bin; });
+  m_workers = vector<Worker>(min<size_t>(max(n_threads, 1u), n_binary));
+  m_inputs.reserve(variant_files.size());
+  auto next_worker = 0u;
+  for (auto i = 0u; i != variant_files.size(); ++i) {
+    auto worker = NO_WORKER;
+    if (variant_files[i]->is_bin) {
+      worker = next_worker;
+      next_worker = (next_worker + 1) % m_workers.size();
+      m_workers[worker].inputs.push_back(i);
+    }
+    auto iterator = VariantIterator{variant_files[i], variant_headers[i]};
+    const auto finished = iterator.empty();
+    m_inputs.push_back(Input{move(iterator), vector<shared_ptr<bcf1_t>>(m_lookahead + CONSUMER_RECORDS), 0, {}, finished, nullptr, worker});
+  }
+  for (auto& worker : m_workers)
+    worker.thread = thread{[this, &worker] { decode(worker); }};
+}
+
+VariantPrefetcher::~VariantPrefetcher() {
+  for (auto& worker : m_workers) {
+    {
+      lock_guard<mutex> lock {worker.mutex};
+      worker.stopping = true;
+    }
+    worker.queue_not_full.notify_one();
+  }
+  for (auto& worker : m_workers)
+    worker.thread.join();
+}
+
+shared_ptr<bcf1_t> VariantPrefetcher::next_record(const uint32_t input_index) {
+  auto& input = m_inputs[input_index];
+  if (input.worker == NO_WORKER) {  // a VCF input, parsed on the consumer's thread
+    if (input.iterator.empty())
+      return nullptr;
+    auto record = input.iterator.exchange_record(free_buffer(input));
+    ++input.iterator;
+    return record;
+  }
+  auto& worker = m_workers[input.worker];
+  unique_lock<mutex> lock {worker.mutex};
+  worker.queue_not_empty.wait(lock, [&input] { return !input.records.empty() || input.finished; });
+  if (input.records.empty()) {
+    if (input.error)
+      rethrow_exception(input.error);
+    return nullptr;
+  }
+  const auto was_full = input.records.size() >= m_lookahead;
+  auto record = move(input.records.front());
+  input.records.pop_front();
+  lock.unlock();
+  if (was_full)
+    worker.queue_not_full.notify_one();
+  return record;
+}
+
+/**
+ * @brief fills the queues of the worker's inputs, decoding a batch of records for each queue with room
+ * for them, and waits when every queue is full
+ *
+ * Records are decoded without holding the lock: the iterator and buffers of an input are only used by
+ * its worker thread.
+ */
+void VariantPrefetcher::decode(Worker& worker) {
+  auto batch = vector<shared_ptr<bcf1_t>>{};
+  unique_lock<mutex> lock {worker.mutex};
+  while (!worker.stopping) {
+    auto active = false;
+    auto decoded = false;
+    for (const auto input_index : worker.inputs) {
+      auto& input = m_inputs[input_index];
+      if (input.finished)
+        continue;
+      active = true;
+      const auto room = m_lookahead - min<size_t>(input.records.size(), m_lookahead);
+      if (room == 0)
+        continue;
+      lock.unlock();
+      auto error = exception_ptr{};
+      try {
+        while (batch.size() != room && !input.iterator.empty()) {
+          batch.push_back(input.iterator.exchange_record(free_buffer(input)));
+          ++input.iterator;
+        }
+      }
+      catch (...) {
+        error = current_exception();
+      }
+      const auto finished = error || input.iterator.empty();
+      lock.lock();
+      move(batch.begin(), batch.end(), back_inserter(input.records));
+      batch.clear();
+      input.finished = finished;
+      input.error = error;
+      decoded = true;
+      worker.queue_not_empty.notify_one();
+    }
+    if (!active)
+      break;
+    if (!decoded)
+      worker.queue_not_full.wait(lock);
+  }
+}
+
+/**
+ * @brief the next buffer of the input's ring, or a new one if the consumer still refers to it
+ *
+ * A use count of 1 means the ring holds the only reference, and the consumer released it: the fence
+ * makes the consumer's last changes to the record visible before it is overwritten.
+ */
+shared_ptr<bcf1_t> VariantPrefetcher::free_buffer(Input& input) {
+  auto& slot = input.buffers[input.next_buffer];
+  input.next_buffer = (input.next_buffer + 1) % input.buffers.size();
+  if (slot && slot.use_count() == 1)
+    atomic_thread_fence(memory_order_acquire);
+  else
+    slot = utils::make_shared_variant(bcf_init1());
+  return slot;
+}
+
+}  // end of namespace
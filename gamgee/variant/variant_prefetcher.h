@@ -0,0 +1,105 @@
+#ifndef gamgee__variant_prefetcher__guard
+#define gamgee__variant_prefetcher__guard
+
+#include "variant_iterator.h"
+
+#include "htslib/vcf.h"
+
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace gamgee {
+
+/**
+ * @brief Decodes the records of several variant files ahead of their consumer, in a pool of threads.
+ *
+ * Each input is assigned to one of the decoder threads (round robin), which keeps a bounded queue of
+ * the input's next records filled. The consumer takes records from the queues with next_record() and
+ * only waits when an input's queue is empty. Records are handed over without copies, in buffers that
+ * are reused once the consumer no longer refers to them.
+ *
+ * Used by MultipleVariantIterator (and so ReferenceBlockSplittingVariantIterator) when the reader is
+ * given decoder threads, so that merging many BGZF compressed files is not limited by the inflate
+ * speed of a single core.
+ *
+ * Only BCF inputs are decoded by the threads. Parsing a VCF line adds the contigs and fields it uses
+ * without declaring them to the header of the input, which the consumer reads through every record, so
+ * VCF inputs are parsed on demand by next_record() on the consumer's thread, as without decoder threads.
+ */
+class VariantPrefetcher {
+ public:
+  static constexpr uint32_t DEFAULT_LOOKAHEAD = 64;  ///< @brief default number of records decoded ahead per input
+
+  /**
+   * @brief starts decoding the inputs
+   *
+   * @param variant_files   vector of vcf/bcf files opened via the bcf_open() macro from htslib
+   * @param variant_headers vector of headers corresponding to the files
+   * @param n_threads       number of decoder threads (at most one per BCF input is used)
+   * @param lookahead       maximum number of records decoded ahead per input
+   */
+  VariantPrefetcher(const std::vector<std::shared_ptr<htsFile>>& variant_files, const std::vector<std::shared_ptr<bcf_hdr_t>>& variant_headers,
+                    const uint32_t n_threads, const uint32_t lookahead = DEFAULT_LOOKAHEAD);
+
+  /**
+   * @brief stops the decoder threads (records already handed over stay valid)
+   */
+  ~VariantPrefetcher();
+
+  VariantPrefetcher(const VariantPrefetcher&) = delete;
+  VariantPrefetcher& operator=(const VariantPrefetcher&) = delete;
+  VariantPrefetcher(VariantPrefetcher&&) = delete;
+  VariantPrefetcher& operator=(VariantPrefetcher&&) = delete;
+
+  /**
+   * @brief takes the next record of an input, waiting for it to be decoded if needed (or parsing it, for VCF inputs)
+   * @return the record, or nullptr once all the records of the input have been taken
+   * @note rethrows any exception raised while decoding the input
+   */
+  std::shared_ptr<bcf1_t> next_record(const uint32_t input);
+
+ private:
+  /**
+   * @brief an input file, its queue of decoded records and the buffers its records are decoded into
+   */
+  struct Input {
+    VariantIterator iterator;                        ///< only used by the decoder thread of the input (by the consumer for VCF inputs)
+    std::vector<std::shared_ptr<bcf1_t>> buffers;    ///< ring of record buffers, only used by the decoder thread of the input
+    uint32_t next_buffer;
+    std::deque<std::shared_ptr<bcf1_t>> records;     ///< decoded records not yet taken
+    bool finished;                                   ///< whether the last record of the input has been queued
+    std::exception_ptr error;                        ///< exception raised while decoding
+    uint32_t worker;                                 ///< the decoder thread of the input, or NO_WORKER for VCF inputs
+  };
+
+  static constexpr uint32_t NO_WORKER = std::numeric_limits<uint32_t>::max();
+
+  /**
+   * @brief a decoder thread and the synchronization of the queues of its inputs
+   */
+  struct Worker {
+    std::mutex mutex;                                ///< guards the records, finished and error of the worker's inputs, and stopping
+    std::condition_variable queue_not_full;          ///< signalled when the consumer takes a record from a full queue
+    std::condition_variable queue_not_empty;         ///< signalled when records are queued
+    std::vector<uint32_t> inputs;
+    bool stopping = false;
+    std::thread thread;
+  };
+
+  std::vector<Input> m_inputs;
+  std::vector<Worker> m_workers;
+  uint32_t m_lookahead;
+
+  void decode(Worker& worker);
+  std::shared_ptr<bcf1_t> free_buffer(Input& input);
+};
+
+}  // end of namespace
+
+#endif // gamgee__variant_prefetcher__guard
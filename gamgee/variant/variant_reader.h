@@ -3,6 +3,9 @@
 
 #include "variant_header.h"
 #include "variant_iterator.h"
+#include "variant_site_predicate.h"
+#include "site_filtering_variant_iterator.h"
+#include "variant_unpack_level.h"
 
 #include "../exceptions.h"
 #include "../utils/hts_memory.h"
@@ -55,7 +58,8 @@ class VariantReader {
    */
   explicit VariantReader(const std::string& filename) :
     m_variant_file_ptr {},
-    m_variant_header_ptr {}
+    m_variant_header_ptr {},
+    m_individual_fields {}
   {
     init_reader(filename);
   }
@@ -68,7 +72,8 @@ class VariantReader {
    */
   explicit VariantReader(const std::vector<std::string>& filenames) :
     m_variant_file_ptr {},
-    m_variant_header_ptr {}
+    m_variant_header_ptr {},
+    m_individual_fields {}
   {
     if (filenames.size() > 1)
       throw SingleInputException{"filenames", filenames.size()};
@@ -76,6 +81,25 @@ class VariantReader {
       init_reader(filenames.front());
   }
 
+  /**
+   * @brief reads through all records in a file (vcf or bcf) decoding only the parts needed for unpack_level
+   *
+   * With VariantUnpackLevel::SITES_ONLY the per-sample block of every record is skipped, which makes
+   * site-level scans of files with many samples much cheaper.
+   *
+   * @param filename the name of the variant file
+   * @param unpack_level how much of every record to decode
+   */
+  VariantReader(const std::string& filename, const VariantUnpackLevel unpack_level) :
+    m_variant_file_ptr {},
+    m_variant_header_ptr {},
+    m_individual_fields {}
+  {
+    init_reader(filename);
+    if (unpack_level == VariantUnpackLevel::SITES_ONLY)
+      subset_variant_samples(m_variant_header_ptr.get(), std::vector<std::string>{}, true);
+  }
+
   /**
    * @brief reads through all records in a file (vcf or bcf) parsing them into Variant
    * objects but only including the selected samples. To create a sites only file, simply
@@ -87,7 +111,8 @@ class VariantReader {
    */
   VariantReader(const std::string& filename, const std::vector<std::string>& samples, const bool include = true) :
     m_variant_file_ptr {},
-    m_variant_header_ptr {}
+    m_variant_header_ptr {},
+    m_individual_fields {}
   {
     init_reader(filename);
     subset_variant_samples(m_variant_header_ptr.get(), samples, include);
@@ -104,7 +129,8 @@ class VariantReader {
    */
   VariantReader(const std::vector<std::string>& filenames, const std::vector<std::string>& samples, const bool include = true) :
     m_variant_file_ptr {},
-    m_variant_header_ptr {}
+    m_variant_header_ptr {},
+    m_individual_fields {}
   {
     if (filenames.size() > 1)
       throw SingleInputException{"filenames", filenames.size()};
@@ -114,6 +140,24 @@ class VariantReader {
     }
   }
 
+  /**
+   * @brief reads through all records in a file (vcf or bcf) keeping only the selected samples and individual fields
+   *
+   * The other individual (FORMAT) fields are dropped from each record as it is read, so they take no room
+   * in the record and are skipped by every IndividualField access.
+   *
+   * @param filename the name of the variant file
+   * @param samples the list of samples you want included/excluded from your iteration
+   * @param include whether you want these samples to be included or excluded from your iteration (pass an empty list and false for all samples)
+   * @param individual_fields the individual fields to keep (e.g. GT, GQ and AD). Empty for all fields.
+   * @exception HeaderFieldNotFoundException if an individual field is not declared in the header
+   */
+  VariantReader(const std::string& filename, const std::vector<std::string>& samples, const bool include, const std::vector<std::string>& individual_fields) :
+    VariantReader {filename, samples, include}
+  {
+    m_individual_fields = individual_field_mask(m_variant_header_ptr.get(), individual_fields);
+  }
+
   /**
    * @brief a VariantReader cannot be copied safely, as it is iterating over a stream.
    */
@@ -135,7 +179,7 @@ class VariantReader {
    * @return a ITERATOR ready to start parsing the file
    */
   ITERATOR begin() const {
-    return ITERATOR{ m_variant_file_ptr, m_variant_header_ptr };
+    return ITERATOR{ m_variant_file_ptr, m_variant_header_ptr, m_individual_fields };
   }
 
   /**
@@ -147,6 +191,21 @@ class VariantReader {
     return ITERATOR{};
   }
 
+  /**
+   * @brief iterates over the records passing a site predicate only, decoding the samples of those records only
+   *
+   * @param predicate site conditions compiled against header()
+   * @return a range to use in a for-each loop in place of the reader
+   */
+  SiteFilteredVariants<SiteFilteringVariantIterator<ITERATOR>> filter_sites(const VariantSitePredicate& predicate) const {
+    const auto file_ptr = m_variant_file_ptr;
+    const auto header_ptr = m_variant_header_ptr;
+    const auto individual_fields = m_individual_fields;
+    return SiteFilteredVariants<SiteFilteringVariantIterator<ITERATOR>>{[file_ptr, header_ptr, individual_fields, predicate] {
+      return SiteFilteringVariantIterator<ITERATOR>{predicate, file_ptr, header_ptr, individual_fields};
+    }};
+  }
+
   /**
    * @brief returns the variant header of the file being read
    */
@@ -155,6 +214,7 @@ class VariantReader {
  private:
   std::shared_ptr<htsFile> m_variant_file_ptr;          ///< pointer to the internal file structure of the variant/bam/cram file
   std::shared_ptr<bcf_hdr_t> m_variant_header_ptr;      ///< pointer to the internal header structure of the variant/bam/cram file
+  IndividualFieldMask m_individual_fields;              ///< individual fields kept in each record (empty for all)
 
   /**
    * @brief initialize the VariantReader (helper function for constructors)
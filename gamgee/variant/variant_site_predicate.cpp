@@ -0,0 +1,222 @@
+#include "variant_site_predicate.h"
+
+#include "../exceptions.h"
+#include "../missing.h"
+#include "../utils/variant_field_type.h"
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+
+using namespace std;
+
+namespace gamgee {
+
+constexpr auto WHOLE_CHROMOSOME = numeric_limits<uint32_t>::max();
+
+static uint8_t allele_type_bit(const AlleleType type) {
+  return uint8_t{1} << static_cast<uint8_t>(type);
+}
+
+/**
+ * @brief whether an alternate allele names no sequence: symbolic (<DEL>, <NON_REF>), a breakend, the spanning deletion * or missing (.)
+ */
+static bool is_non_sequence_allele(const char* allele) {
+  return allele[0] == '<' || allele[0] == '*' || (allele[0] == '.' && allele[1] == '\0') || strpbrk(allele, "[]") != nullptr;
+}
+
+VariantSitePredicate::VariantSitePredicate() :
+  m_header {},
+  m_restrict_intervals {false},
+  m_intervals {},
+  m_restrict_qual {false},
+  m_min_qual {0},
+  m_min_alleles {0},
+  m_max_alleles {numeric_limits<uint32_t>::max()},
+  m_passing_filters {false},
+  m_missing_filter_passes {true},
+  m_pass_index {0},  // htslib always gives PASS the first filter index
+  m_excluded_filters {},
+  m_required_shared_fields {},
+  m_shared_field_bounds {},
+  m_allele_types {0}
+{}
+
+VariantSitePredicate::VariantSitePredicate(VariantHeader header) :
+  VariantSitePredicate {}
+{
+  m_header = make_shared<const VariantHeader>(move(header));
+  m_pass_index = m_header->field_index("PASS");
+}
+
+VariantSitePredicate& VariantSitePredicate::in_intervals(const std::vector<Interval>& intervals) {
+  m_restrict_intervals = true;
+  m_intervals.clear();
+  for (const auto& interval : intervals) {
+    const auto contig = m_header->chromosome_index(interval.chr());
+    if (!missing(contig))
+      m_intervals.push_back(ContigInterval{static_cast<uint32_t>(contig), interval.start(), interval.stop()});
+  }
+  // sorted and merged, the intervals can be binary searched by their stops
+  sort(m_intervals.begin(), m_intervals.end());
+  auto merged = vector<ContigInterval>{};
+  for (const auto& interval : m_intervals) {
+    if (!merged.empty() && merged.back().contig == interval.contig && interval.start <= merged.back().stop)
+      merged.back().stop = max(merged.back().stop, interval.stop);
+    else
+      merged.push_back(interval);
+  }
+  m_intervals = move(merged);
+  return *this;
+}
+
+VariantSitePredicate& VariantSitePredicate::in_chromosomes(const std::vector<std::string>& chromosomes) {
+  auto intervals = vector<Interval>{};
+  for (const auto& chromosome : chromosomes)
+    intervals.emplace_back(chromosome, 1, WHOLE_CHROMOSOME);
+  return in_intervals(intervals);
+}
+
+VariantSitePredicate& VariantSitePredicate::min_qual(const float qual) {
+  m_restrict_qual = true;
+  m_min_qual = qual;
+  return *this;
+}
+
+VariantSitePredicate& VariantSitePredicate::n_alleles_between(const uint32_t min, const uint32_t max) {
+  m_min_alleles = min;
+  m_max_alleles = max;
+  return *this;
+}
+
+VariantSitePredicate& VariantSitePredicate::passing_filters(const bool missing_passes) {
+  m_passing_filters = true;
+  m_missing_filter_passes = missing_passes;
+  return *this;
+}
+
+VariantSitePredicate& VariantSitePredicate::excluding_filters(const std::vector<std::string>& filters) {
+  for (const auto& filter : filters)
+    m_excluded_filters.push_back(compile_field(filter, BCF_HL_FLT));
+  return *this;
+}
+
+VariantSitePredicate& VariantSitePredicate::with_shared_field(const std::string& tag) {
+  m_required_shared_fields.push_back(compile_field(tag, BCF_HL_INFO));
+  return *this;
+}
+
+VariantSitePredicate& VariantSitePredicate::shared_field_at_least(const std::string& tag, const float value) {
+  return add_bound(tag, value, true);
+}
+
+VariantSitePredicate& VariantSitePredicate::shared_field_at_most(const std::string& tag, const float value) {
+  return add_bound(tag, value, false);
+}
+
+VariantSitePredicate& VariantSitePredicate::with_allele_types(const std::vector<AlleleType>& types) {
+  m_allele_types = 0;
+  for (const auto type : types)
+    m_allele_types |= allele_type_bit(type);
+  return *this;
+}
+
+bool VariantSitePredicate::accepts_all() const {
+  return !m_restrict_intervals && !m_restrict_qual && m_min_alleles == 0 && m_max_alleles == numeric_limits<uint32_t>::max() &&
+    !m_passing_filters && m_excluded_filters.empty() && m_required_shared_fields.empty() && m_shared_field_bounds.empty() && m_allele_types == 0;
+}
+
+/**
+ * @brief the conditions on the fixed part of the record (no unpacking) go first, then FILTER, alleles and INFO,
+ * in the order htslib lays them out in the shared block
+ */
+bool VariantSitePredicate::operator()(bcf1_t* record) const {
+  if (m_restrict_intervals && !overlaps_intervals(record))
+    return false;
+  if (m_restrict_qual && (bcf_float_is_missing(record->qual) || record->qual < m_min_qual))
+    return false;
+  if (record->n_allele < m_min_alleles || record->n_allele > m_max_alleles)
+    return false;
+  if ((m_passing_filters || !m_excluded_filters.empty()) && !filters_pass(record))
+    return false;
+  if (m_allele_types != 0 && !alleles_pass(record))
+    return false;
+  if ((!m_required_shared_fields.empty() || !m_shared_field_bounds.empty()) && !shared_fields_pass(record))
+    return false;
+  return true;
+}
+
+int32_t VariantSitePredicate::compile_field(const std::string& name, const int32_t field_category) const {
+  const auto index = m_header->field_index(name);
+  if (missing(index) || !m_header->has_field(index, field_category))
+    throw HeaderFieldNotFoundException{name};
+  return index;
+}
+
+VariantSitePredicate& VariantSitePredicate::add_bound(const std::string& tag, const float value, const bool at_least) {
+  const auto index = compile_field(tag, BCF_HL_INFO);
+  const auto type = m_header->shared_field_type(index);
+  if (type != BCF_HT_INT && type != BCF_HT_REAL)
+    throw invalid_argument{"shared field " + tag + " is not numeric"};
+  m_shared_field_bounds.push_back(SharedFieldBound{index, value, at_least});
+  return *this;
+}
+
+bool VariantSitePredicate::overlaps_intervals(const bcf1_t* record) const {
+  const auto contig = static_cast<uint32_t>(record->rid);
+  const auto start = static_cast<uint32_t>(record->pos + 1);
+  const auto stop = max(start, static_cast<uint32_t>(record->pos + record->rlen));
+  // the first interval that doesn't end before the record starts
+  const auto interval = lower_bound(m_intervals.begin(), m_intervals.end(), start, [contig](const ContigInterval& lhs, const uint32_t position) {
+      return lhs.contig < contig || (lhs.contig == contig && lhs.stop < position);
+  });
+  return interval != m_intervals.end() && interval->contig == contig && interval->start <= stop;
+}
+
+bool VariantSitePredicate::filters_pass(bcf1_t* record) const {
+  bcf_unpack(record, BCF_UN_FLT);
+  const auto* filters_begin = record->d.flt;
+  const auto* filters_end = record->d.flt + record->d.n_flt;
+  if (m_passing_filters && !((record->d.n_flt == 0 && m_missing_filter_passes) || (record->d.n_flt == 1 && record->d.flt[0] == m_pass_index)))
+    return false;
+  for (const auto filter : m_excluded_filters) {
+    if (find(filters_begin, filters_end, filter) != filters_end)
+      return false;
+  }
+  return true;
+}
+
+bool VariantSitePredicate::alleles_pass(bcf1_t* record) const {
+  bcf_unpack(record, BCF_UN_STR);
+  const auto ref_length = static_cast<int32_t>(strlen(record->d.allele[0]));
+  for (auto i = 1u; i < record->n_allele; ++i) {
+    if (is_non_sequence_allele(record->d.allele[i]))
+      continue;
+    const auto diff = static_cast<int32_t>(strlen(record->d.allele[i])) - ref_length;
+    const auto type = diff == 0 ? AlleleType::SNP : (diff > 0 ? AlleleType::INSERTION : AlleleType::DELETION);
+    if (m_allele_types & allele_type_bit(type))
+      return true;
+  }
+  return false;
+}
+
+bool VariantSitePredicate::shared_fields_pass(bcf1_t* record) const {
+  bcf_unpack(record, BCF_UN_INFO);
+  for (const auto index : m_required_shared_fields) {
+    if (bcf_get_info_id(record, index) == nullptr)
+      return false;
+  }
+  for (const auto& bound : m_shared_field_bounds) {
+    const auto* info = bcf_get_info_id(record, bound.index);
+    if (info == nullptr || info->len < 1)
+      return false;
+    const auto type = static_cast<utils::VariantFieldType>(info->type);
+    const auto value = utils::convert_data_to_float(info->vptr, 0, utils::size_for_type(type, info), type);
+    if (missing(value) || (bound.at_least ? value < bound.value : value > bound.value))
+      return false;
+  }
+  return true;
+}
+
+}  // end of namespace
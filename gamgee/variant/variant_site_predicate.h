@@ -0,0 +1,152 @@
+#ifndef gamgee__variant_site_predicate__guard
+#define gamgee__variant_site_predicate__guard
+
+#include "variant_header.h"
+
+#include "../contig_interval.h"
+#include "../interval.h"
+#include "../utils/variant_utils.h"
+
+#include "htslib/vcf.h"
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <memory>
+
+namespace gamgee {
+
+/**
+ * @brief Site-level (CHROM to INFO) conditions on variant records, compiled against a header.
+ *
+ * Every condition names its chromosomes, filters and shared fields by string, but they are turned into
+ * header indices once, when the condition is added, so testing a record involves no string lookups. A
+ * record passes when it meets all the conditions added (a predicate with no conditions accepts every
+ * record). The test only decodes the parts of the shared block its conditions need, cheapest first, and
+ * never touches the per-sample data: this is what lets SiteFilteringVariantIterator skip decoding the
+ * samples of the records it rejects.
+ *
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ * auto reader = SingleVariantReader{"cohort.bcf"};
+ * auto predicate = VariantSitePredicate{reader.header()};
+ * predicate.in_chromosomes({"20"}).min_qual(30).passing_filters().shared_field_at_least("AF", 0.01);
+ * for (const auto& record : reader.filter_sites(predicate))
+ *   ...
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ */
+class VariantSitePredicate {
+ public:
+  /**
+   * @brief a predicate accepting every record, to which no condition can be added (used by empty iterators)
+   */
+  VariantSitePredicate();
+
+  /**
+   * @brief a predicate accepting every record of files with this header
+   * @note records tested must have been read with this header (or one with the same dictionaries)
+   * @note copies of the predicate share the header
+   */
+  explicit VariantSitePredicate(VariantHeader header);
+
+  VariantSitePredicate(const VariantSitePredicate&) = default;
+  VariantSitePredicate(VariantSitePredicate&&) = default;
+  VariantSitePredicate& operator=(const VariantSitePredicate&) = default;
+  VariantSitePredicate& operator=(VariantSitePredicate&&) = default;
+
+  /**
+   * @brief only records overlapping one of these intervals (replaces any previous intervals or chromosomes)
+   * @note intervals on chromosomes that are not in the header select nothing
+   */
+  VariantSitePredicate& in_intervals(const std::vector<Interval>& intervals);
+
+  /**
+   * @brief only records on one of these chromosomes (replaces any previous intervals or chromosomes)
+   * @note chromosomes that are not in the header select nothing
+   */
+  VariantSitePredicate& in_chromosomes(const std::vector<std::string>& chromosomes);
+
+  VariantSitePredicate& min_qual(const float qual);                         ///< @brief only records with a QUAL of at least qual (records with a missing QUAL fail)
+  VariantSitePredicate& n_alleles_between(const uint32_t min, const uint32_t max); ///< @brief only records with between min and max alleles (inclusive, counting the reference allele)
+
+  /**
+   * @brief only records whose FILTER is PASS
+   * @param missing_passes whether records whose FILTER is missing (.), i.e. that were never filtered, pass too (as the VCF specification suggests)
+   */
+  VariantSitePredicate& passing_filters(const bool missing_passes = true);
+
+  /**
+   * @brief only records that have none of these filters
+   * @exception HeaderFieldNotFoundException if a filter is not declared in the header
+   */
+  VariantSitePredicate& excluding_filters(const std::vector<std::string>& filters);
+
+  /**
+   * @brief only records where this shared (INFO) field is present (for flags: set)
+   * @exception HeaderFieldNotFoundException if the field is not declared in the header
+   */
+  VariantSitePredicate& with_shared_field(const std::string& tag);
+
+  /**
+   * @brief only records where the first value of this numeric shared (INFO) field is at least value (records without a value fail)
+   * @exception HeaderFieldNotFoundException if the field is not declared in the header
+   * @exception std::invalid_argument if the field is not an Integer or Float field
+   */
+  VariantSitePredicate& shared_field_at_least(const std::string& tag, const float value);
+
+  /**
+   * @brief only records where the first value of this numeric shared (INFO) field is at most value (records without a value fail)
+   * @copydetails shared_field_at_least
+   */
+  VariantSitePredicate& shared_field_at_most(const std::string& tag, const float value);
+
+  /**
+   * @brief only records with at least one alternate allele of one of these types
+   * @note alleles are typed by comparing their length to the reference, as Variant::allele_mask() does, but
+   * alleles that name no sequence are skipped: symbolic alleles (<DEL>, <NON_REF>), breakends, the
+   * spanning deletion * and missing alleles (.). A record whose only alternates are such alleles never passes.
+   */
+  VariantSitePredicate& with_allele_types(const std::vector<AlleleType>& types);
+
+  /**
+   * @brief tests a record, unpacking only the shared parts of it the conditions need
+   */
+  bool operator()(bcf1_t* record) const;
+
+  bool accepts_all() const;  ///< @brief whether no condition was added
+
+ private:
+  /**
+   * @brief a comparison of the first value of a numeric shared field with a threshold
+   */
+  struct SharedFieldBound {
+    int32_t index;
+    float value;
+    bool at_least;
+  };
+
+  std::shared_ptr<const VariantHeader> m_header;   ///< header the indices are compiled against (used when adding conditions only)
+  bool m_restrict_intervals;                       ///< whether m_intervals applies
+  std::vector<ContigInterval> m_intervals;         ///< sorted, non-overlapping intervals whose contig is the header contig id
+  bool m_restrict_qual;
+  float m_min_qual;
+  uint32_t m_min_alleles;
+  uint32_t m_max_alleles;
+  bool m_passing_filters;
+  bool m_missing_filter_passes;                    ///< whether a missing FILTER (.) counts as PASS for m_passing_filters
+  int32_t m_pass_index;                            ///< header index of PASS
+  std::vector<int32_t> m_excluded_filters;
+  std::vector<int32_t> m_required_shared_fields;
+  std::vector<SharedFieldBound> m_shared_field_bounds;
+  uint8_t m_allele_types;                          ///< bit per AlleleType accepted, 0 for any
+
+  int32_t compile_field(const std::string& name, const int32_t field_category) const;
+  VariantSitePredicate& add_bound(const std::string& tag, const float value, const bool at_least);
+  bool overlaps_intervals(const bcf1_t* record) const;
+  bool filters_pass(bcf1_t* record) const;
+  bool alleles_pass(bcf1_t* record) const;
+  bool shared_fields_pass(bcf1_t* record) const;
+};
+
+}  // end of namespace
+
+#endif /* gamgee__variant_site_predicate__guard */
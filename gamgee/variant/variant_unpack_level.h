@@ -0,0 +1,20 @@
+#ifndef gamgee__variant_unpack_level__guard
+#define gamgee__variant_unpack_level__guard
+
+namespace gamgee {
+
+/**
+ * @brief how much of every record a variant reader decodes
+ *
+ * Shared (site) data are always decoded lazily by the Variant accessors, so the choice that matters is
+ * whether the per-sample (FORMAT) block is read at all. For files with many samples it dominates the
+ * decoding cost: a VCF line is mostly sample columns and a BCF record is mostly its individual block.
+ */
+enum class VariantUnpackLevel {
+  SITES_ONLY,  ///< the site columns, CHROM to INFO (i.e. all shared fields). Samples are dropped from the header, so the FORMAT block is never parsed (VCF) or kept (BCF) and records have no samples.
+  ALL          ///< the site columns and every sample (default)
+};
+
+}  // end of namespace
+
+#endif /* gamgee__variant_unpack_level__guard */
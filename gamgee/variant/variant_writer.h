@@ -27,17 +27,17 @@ class VariantWriter {
    * @param output_fname file to write to. The default is stdout (as defined by htslib)
    * @param binary whether the output should be in BCF (true) or VCF format (false)
    * @param compression_level optional zlib compression level. 0 for none, 1 for best speed, 9 for best compression
-   * @note the header is copied and managed internally
+   * @note a header must be added with add_header() before any record
    */
   explicit VariantWriter(const std::string& output_fname = "-", const bool binary = true, const int compression_level = Z_DEFAULT_COMPRESSION);
 
   /**
    * @brief Creates a new VariantWriter with the header extracted from a Variant record and using the specified output file name
-   * @param header a VariantHeader object to make a copy from
+   * @param header the header of the records to write. The writer shares it (VariantHeader copies share the htslib header) rather than copying it
    * @param output_fname file to write to. The default is stdout  (as defined by htslib)
    * @param binary whether the output should be in BCF (true) or VCF format (false)
    * @param compression_level optional zlib compression level. 0 for none, 1 for best speed, 9 for best compression
-   * @note the header is copied and managed internally
+   * @note use VariantHeader::clone() to write with a header that the caller keeps modifying independently
    */
   explicit VariantWriter(const VariantHeader& header, const std::string& output_fname = "-", const bool binary = true, const int compression_level = Z_DEFAULT_COMPRESSION);
 
@@ -63,14 +63,14 @@ class VariantWriter {
 
   /**
    * @brief Adds a header to the file stream.
-   * @param header the header
+   * @param header the header, shared with the writer (not copied)
    * @note the header is a requirement to add records
    */
   void add_header(const VariantHeader& header);
 
  private:
   std::unique_ptr<htsFile, utils::HtsFileDeleter> m_out_file;  ///< the file or stream to write out to ("-" means stdout)
-  VariantHeader m_header;               ///< holds a copy of the header throughout the production of the output (necessary for every record that gets added)
+  VariantHeader m_header;               ///< shares the header throughout the production of the output (necessary for every record that gets added)
 
   static htsFile* open_file(const std::string& output_fname, const std::string& binary);
   void write_header() const;
@@ -0,0 +1,49 @@
+#include "contig_interval.h"
+#include "exceptions.h"
+#include "sam/sam_reader.h"
+#include "variant/variant_reader.h"
+
+#include <boost/test/unit_test.hpp>
+
+#include <string>
+#include <vector>
+
+using namespace std;
+using namespace gamgee;
+
+BOOST_AUTO_TEST_CASE( contig_dictionary_from_names )
+{
+  const auto dictionary = ContigDictionary{vector<string>{"chr2", "chr1", "chr2", "chrX"}};
+  BOOST_CHECK_EQUAL(dictionary.size(), 3u);  // duplicates keep their first id
+  BOOST_CHECK((dictionary.names() == vector<string>{"chr2", "chr1", "chrX"}));
+  BOOST_CHECK_EQUAL(dictionary.id("chr1"), 1u);
+  BOOST_CHECK_EQUAL(dictionary.name(2), "chrX");
+  BOOST_CHECK(dictionary.contains("chrX"));
+  BOOST_CHECK(!dictionary.contains("chrY"));
+  BOOST_CHECK_THROW(dictionary.id("chrY"), ChromosomeNotFoundException);
+  BOOST_CHECK(ContigDictionary{}.empty());
+}
+
+BOOST_AUTO_TEST_CASE( contig_interval_conversions )
+{
+  const auto dictionary = ContigDictionary{vector<string>{"1", "2", "X"}};
+  const auto intervals = vector<Interval>{Interval{"2", 10, 20}, Interval{"2", 5, 5}, Interval{"X", 1, 1000}, Interval{"1", 100, 200}};
+  const auto compact = dictionary.to_contig_intervals(intervals);
+  BOOST_CHECK((compact == vector<ContigInterval>{ContigInterval{1, 10, 20}, ContigInterval{1, 5, 5}, ContigInterval{2, 1, 1000}, ContigInterval{0, 100, 200}}));
+  BOOST_CHECK(dictionary.to_intervals(compact) == intervals);
+  BOOST_CHECK(dictionary.to_interval(compact[3]) == intervals[3]);
+  BOOST_CHECK(dictionary.to_contig_interval(intervals[2]) == compact[2]);
+  BOOST_CHECK_EQUAL(compact[2].size(), 1000u);
+  BOOST_CHECK(compact[3] < compact[1]);  // dictionary order
+  BOOST_CHECK(compact[1] < compact[0]);
+  BOOST_CHECK(dictionary.to_intervals(compact, Interval::IntervalType::BED)[0].output_type() == Interval::IntervalType::BED);
+  BOOST_CHECK_THROW(dictionary.to_contig_intervals(vector<Interval>{Interval{"Y", 1, 1}}), ChromosomeNotFoundException);
+}
+
+BOOST_AUTO_TEST_CASE( contig_dictionary_from_headers )
+{
+  const auto sam_dictionary = ContigDictionary{SingleSamReader{"testdata/test_simple.bam"}.header()};
+  BOOST_CHECK((sam_dictionary.names() == vector<string>{"chr1"}));
+  const auto variant_dictionary = ContigDictionary{SingleVariantReader{"testdata/test_variants.vcf"}.header()};
+  BOOST_CHECK((variant_dictionary.names() == vector<string>{"1", "20", "22"}));
+}
@@ -0,0 +1,105 @@
+#include "fastq.h"
+#include "fastq_reader.h"
+#include "fastq_writer.h"
+
+#include "htslib/bgzf.h"
+
+#include <boost/test/unit_test.hpp>
+
+#include <string>
+#include <vector>
+#include <fstream>
+#include <sstream>
+#include <cstdio>
+
+using namespace std;
+using namespace gamgee;
+
+const auto FASTQ_WRITER_OUTPUT = string{"testdata/fastq_writer_test_output.fq"};
+
+string read_text_file(const string& filename) {
+  ifstream input {filename};
+  auto contents = stringstream{};
+  contents << input.rdbuf();
+  return contents.str();
+}
+
+string read_bgzf_file(const string& filename) {
+  auto contents = string{};
+  auto file = bgzf_open(filename.c_str(), "r");
+  BOOST_REQUIRE(file != nullptr);
+  char buffer[4096];
+  auto bytes_read = ssize_t{0};
+  while ((bytes_read = bgzf_read(file, buffer, sizeof(buffer))) > 0)
+    contents.append(buffer, bytes_read);
+  bgzf_close(file);
+  return contents;
+}
+
+string expected_output(const vector<Fastq>& records) {
+  auto output = stringstream{};
+  for (const auto& record : records)
+    output << record;
+  return output.str();
+}
+
+vector<Fastq> read_all_records(const string& filename) {
+  auto result = vector<Fastq>{};
+  for (const auto& record : FastqReader{filename})
+    result.push_back(record);
+  return result;
+}
+
+BOOST_AUTO_TEST_CASE( fastq_writer_plain_output )
+{
+  for (const auto& input : {"testdata/test_clean.fq", "testdata/complete_same_seq.fa"}) {
+    const auto records = read_all_records(input);
+    {
+      auto writer = FastqWriter{FASTQ_WRITER_OUTPUT};
+      for (const auto& record : records)
+        writer.add_record(record);
+    }
+    BOOST_CHECK_EQUAL(read_text_file(FASTQ_WRITER_OUTPUT), expected_output(records));
+    BOOST_CHECK(read_all_records(FASTQ_WRITER_OUTPUT) == records);
+  }
+  remove(FASTQ_WRITER_OUTPUT.c_str());
+}
+
+BOOST_AUTO_TEST_CASE( fastq_writer_batch_output )
+{
+  const auto records = read_all_records("testdata/test_clean.fq");
+  {
+    auto writer = FastqWriter{FASTQ_WRITER_OUTPUT, false, 1, 16}; // tiny buffer forces many flushes
+    writer.add_records(records);
+    writer.add_records(records);
+  }
+  BOOST_CHECK_EQUAL(read_text_file(FASTQ_WRITER_OUTPUT), expected_output(records) + expected_output(records));
+  remove(FASTQ_WRITER_OUTPUT.c_str());
+}
+
+BOOST_AUTO_TEST_CASE( fastq_writer_compressed_output )
+{
+  const auto records = read_all_records("testdata/test_clean.fq");
+  for (const auto threads : {1u, 4u}) {
+    {
+      auto writer = FastqWriter{FASTQ_WRITER_OUTPUT, true, threads};
+      writer.add_records(records);
+      writer.add_record(records.front());
+    }
+    BOOST_CHECK_EQUAL(read_bgzf_file(FASTQ_WRITER_OUTPUT), expected_output(records) + expected_output({records.front()}));
+  }
+  remove(FASTQ_WRITER_OUTPUT.c_str());
+}
+
+BOOST_AUTO_TEST_CASE( fastq_writer_move_flushes_pending_records )
+{
+  const auto records = read_all_records("testdata/test_clean.fq");
+  {
+    auto writer = FastqWriter{FASTQ_WRITER_OUTPUT};
+    writer.add_records(records);
+    auto moved = std::move(writer);
+    moved.add_record(records.front());
+  }
+  BOOST_CHECK_EQUAL(read_text_file(FASTQ_WRITER_OUTPUT), expected_output(records) + expected_output({records.front()}));
+  remove(FASTQ_WRITER_OUTPUT.c_str());
+}
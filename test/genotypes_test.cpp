@@ -2,6 +2,7 @@
 
 #include "variant/variant_reader.h"
 #include "variant/variant.h"
+#include "variant/variant_builder.h"
 #include "variant/genotype.h"
 
 #include <boost/dynamic_bitset.hpp>
@@ -264,3 +265,73 @@ BOOST_AUTO_TEST_CASE( encode_genotype ) {
   alleles = {0, bcf_int32_vector_end + 1};
   BOOST_CHECK_THROW(Genotype::encode_genotype(alleles), std::invalid_argument);
 }
+
+// the genotype matrix row of a record, built from its Genotype objects
+vector<int32_t> genotype_matrix_row(const Variant& record, const uint32_t ploidy) {
+  auto row = vector<int32_t>{};
+  for (const auto& genotype : record.genotypes()) {
+    for (auto allele_idx = 0u; allele_idx < ploidy; ++allele_idx) {
+      const auto allele = allele_idx < genotype.size() ? genotype[allele_idx] : bcf_int32_vector_end;
+      row.push_back(allele == bcf_int32_vector_end ? GENOTYPE_MATRIX_NO_ALLELE : (missing(allele) ? GENOTYPE_MATRIX_MISSING_ALLELE : allele));
+    }
+  }
+  return row;
+}
+
+template <class ALLELE_TYPE>
+void check_decode_genotypes(const Variant& record, const uint32_t ploidy) {
+  auto alleles = vector<ALLELE_TYPE>(record.n_samples() * ploidy, 42);
+  auto phased = vector<uint8_t>(record.n_samples(), 42);
+  record.decode_genotypes(ploidy, alleles.data(), phased.data());
+  const auto expected = genotype_matrix_row(record, ploidy);
+  BOOST_CHECK(equal(alleles.begin(), alleles.end(), expected.begin(), expected.end()));
+  BOOST_CHECK(all_of(phased.begin(), phased.end(), [](const uint8_t p) { return p == 0; }));  // none of the test files are phased
+}
+
+BOOST_AUTO_TEST_CASE( decode_genotypes ) {
+  for (const auto filename : {"testdata/test_variants.vcf", "testdata/test_variants.bcf", "testdata/test_variants_alternate_ploidy.vcf", "testdata/test_variants_mixed_ploidy.vcf"}) {
+    for (const auto& record : SingleVariantReader{filename}) {
+      check_decode_genotypes<int8_t>(record, 3);
+      check_decode_genotypes<int16_t>(record, 3);
+      check_decode_genotypes<int8_t>(record, 4);
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE( decode_genotypes_built_records ) {
+  auto header = SingleVariantReader{"testdata/test_variants_for_variantbuilder.vcf"}.header();
+  auto builder = VariantBuilder{header};
+  builder.set_chromosome(0).set_alignment_start(5).set_ref_allele("A").set_alt_alleles({"C", "T"});
+  auto alleles = vector<int8_t>(9);
+  auto phased = vector<uint8_t>(3);
+
+  builder.set_genotypes(vector<vector<int32_t>>{{0, 1, 2}, {}, {0, 1}}).build().decode_genotypes(3, alleles.data(), phased.data());
+  BOOST_CHECK((alleles == vector<int8_t>{0, 1, 2, GENOTYPE_MATRIX_MISSING_ALLELE, GENOTYPE_MATRIX_NO_ALLELE, GENOTYPE_MATRIX_NO_ALLELE, 0, 1, GENOTYPE_MATRIX_NO_ALLELE}));
+  BOOST_CHECK((phased == vector<uint8_t>{0, 0, 0}));
+
+  // no GT field: every allele is missing
+  builder.remove_individual_field("GT");
+  builder.build().decode_genotypes(3, alleles.data());
+  BOOST_CHECK(all_of(alleles.begin(), alleles.end(), [](const int8_t a) { return a == GENOTYPE_MATRIX_MISSING_ALLELE; }));
+
+  // the GT field doesn't fit a lower ploidy
+  builder.set_genotypes(vector<vector<int32_t>>{{0, 1}, {1, 1}, {0, 0}});
+  BOOST_CHECK_THROW(builder.build().decode_genotypes(1, alleles.data()), invalid_argument);
+}
+
+BOOST_AUTO_TEST_CASE( decode_genotypes_of_records ) {
+  auto records = vector<Variant>{};
+  for (const auto& record : SingleVariantReader{"testdata/test_variants.bcf"})
+    records.push_back(record);
+  const auto row_size = records.front().n_samples() * 2;
+  auto alleles = vector<int16_t>(records.size() * row_size);
+  auto phased = vector<uint8_t>(records.size() * records.front().n_samples());
+  Variant::decode_genotypes(records, 2, alleles.data(), phased.data());
+  for (auto i = 0u; i != records.size(); ++i) {
+    const auto expected = genotype_matrix_row(records[i], 2);
+    BOOST_CHECK(equal(alleles.begin() + i * row_size, alleles.begin() + (i + 1) * row_size, expected.begin(), expected.end()));
+  }
+
+  records.push_back(*(SingleVariantReader{"testdata/test_variants_missing_data.vcf"}.begin()));  // 11 samples
+  BOOST_CHECK_THROW(Variant::decode_genotypes(records, 2, alleles.data()), invalid_argument);
+}
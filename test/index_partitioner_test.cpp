@@ -0,0 +1,128 @@
+#include "index_partitioner.h"
+#include "interval_algebra.h"
+#include "interval_index.h"
+#include "sam/sam_reader.h"
+#include "variant/variant_reader.h"
+#include "variant/variant_writer.h"
+#include "variant/variant_builder.h"
+#include "variant/variant_header_builder.h"
+
+#include "htslib/vcf.h"
+
+#include <boost/test/unit_test.hpp>
+
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <stdexcept>
+
+using namespace std;
+using namespace gamgee;
+
+// checks that the shards don't overlap and together cover exactly the expected contigs
+void check_cover(const vector<vector<Interval>>& shards, const vector<Interval>& expected) {
+  auto all = vector<Interval>{};
+  auto total_size = uint64_t{0};
+  for (const auto& shard : shards) {
+    BOOST_CHECK(!shard.empty());
+    for (const auto& interval : shard) {
+      all.push_back(interval);
+      total_size += interval.size();
+    }
+  }
+  BOOST_CHECK(merge_intervals(all) == merge_intervals(expected));
+  auto expected_size = uint64_t{0};
+  for (const auto& interval : expected)
+    expected_size += interval.size();
+  BOOST_CHECK_EQUAL(total_size, expected_size);  // no overlaps
+}
+
+// checks that every record start is in exactly one shard
+void check_starts(const vector<vector<Interval>>& shards, const vector<pair<string, uint32_t>>& starts) {
+  auto owned = 0u;
+  for (const auto& shard : shards) {
+    const auto index = IntervalIndex{shard};
+    for (const auto& start : starts)
+      owned += index.contains(start.first, start.second);
+  }
+  BOOST_CHECK_EQUAL(owned, starts.size());
+}
+
+BOOST_AUTO_TEST_CASE( partition_sam_file_covers_the_genome )
+{
+  const auto genome = vector<Interval>{Interval{"chr1", 1, 100000}};
+  auto starts = vector<pair<string, uint32_t>>{};
+  for (const auto& record : SingleSamReader{"testdata/test_simple.bam"})
+    if (!record.unmapped())
+      starts.emplace_back("chr1", record.alignment_start());
+  for (const auto align : {false, true}) {
+    const auto single = partition_sam_file("testdata/test_simple.bam", 1, align);
+    BOOST_REQUIRE_EQUAL(single.size(), 1u);
+    BOOST_CHECK(single.front() == genome);
+    for (const auto n : {2u, 4u, 7u}) {
+      const auto shards = partition_sam_file("testdata/test_simple.bam", n, align);
+      BOOST_CHECK_LE(shards.size(), n);
+      BOOST_CHECK_GE(shards.size(), 2u);
+      check_cover(shards, genome);
+      check_starts(shards, starts);
+    }
+  }
+  BOOST_CHECK_THROW(partition_sam_file("testdata/test_simple.bam", 0), invalid_argument);
+  BOOST_CHECK_THROW(partition_sam_file("testdata/unindexed/test_unindexed.bam", 2), IndexLoadException);
+}
+
+BOOST_AUTO_TEST_CASE( partition_variant_file_covers_the_genome )
+{
+  const auto genome = vector<Interval>{Interval{"1", 1, 300000000}, Interval{"20", 1, 64000000}, Interval{"22", 1, 120000000}};
+  auto starts = vector<pair<string, uint32_t>>{};
+  for (const auto& record : SingleVariantReader{"testdata/test_variants.vcf"})
+    starts.emplace_back(genome[record.chromosome()].chr(), record.alignment_start());
+  for (const auto filename : {"testdata/var_idx/test_variants.bcf", "testdata/var_idx/test_variants_csi.vcf.gz", "testdata/var_idx/test_variants_tabix.vcf.gz"}) {
+    for (const auto n : {1u, 3u, 16u}) {
+      const auto shards = partition_variant_file(filename, n, n == 16);
+      BOOST_CHECK_EQUAL(shards.size(), n);
+      check_cover(shards, genome);
+      check_starts(shards, starts);
+    }
+  }
+  BOOST_CHECK_THROW(partition_variant_file("testdata/unindexed/test_unindexed.vcf", 2), IndexLoadException);
+}
+
+// a contig whose first tenth holds 10 times more records per base than the rest: equal-length shards would be badly unbalanced
+BOOST_AUTO_TEST_CASE( partition_variant_file_balances_uneven_density )
+{
+  const auto filename = string{"testdata/index_partitioner_uneven.bcf"};
+  const auto header = VariantHeaderBuilder{}.add_chromosome("1", "10000000").build();
+  {
+    auto writer = VariantWriter{header, filename};
+    auto builder = VariantBuilder{header};
+    const auto bases = string{"ACGT"};
+    for (auto position = 1u; position <= 10000000u; position += position <= 1000000u ? 10u : 100u)
+      writer.add_record(builder.set_chromosome(0).set_alignment_start(position).set_ref_allele(bases.substr(position % 4, 1)).build());
+  }
+  BOOST_REQUIRE_EQUAL(bcf_index_build(filename.c_str(), 14), 0);
+
+  auto starts = vector<pair<string, uint32_t>>{};
+  for (const auto& record : SingleVariantReader{filename})
+    starts.emplace_back("1", record.alignment_start());
+  for (const auto align : {false, true}) {
+    for (const auto n : {2u, 4u, 7u}) {
+      const auto shards = partition_variant_file(filename, n, align);
+      BOOST_REQUIRE_EQUAL(shards.size(), n);
+      check_cover(shards, vector<Interval>{Interval{"1", 1, 10000000}});
+      check_starts(shards, starts);
+      // the records are all about the same size, so balanced compressed bytes means balanced record counts
+      const auto expected = starts.size() / n;
+      for (const auto& shard : shards) {
+        const auto index = IntervalIndex{shard};
+        auto records = 0u;
+        for (const auto& start : starts)
+          records += index.contains(start.first, start.second);
+        BOOST_CHECK_LE(records, expected + expected / 5);
+        BOOST_CHECK_GE(records, expected - expected / 5);
+      }
+    }
+  }
+  remove(filename.c_str());
+  remove((filename + ".csi").c_str());
+}
@@ -37,6 +37,26 @@ BOOST_AUTO_TEST_CASE( indexed_single_readers_intervals )
 }
 
 
+BOOST_AUTO_TEST_CASE( indexed_single_readers_contig_intervals )
+{
+  const auto interval_list = vector<string>{"chr1:201-257", "chr1:30001-40000", "chr1:59601-70000", "chr1:94001-100000"};
+  // a dictionary that doesn't match the file header: ids are translated by name and chr2 is skipped
+  const auto dictionary = ContigDictionary{vector<string>{"chr2", "chr1"}};
+  const auto contig_intervals = vector<ContigInterval>{ContigInterval{1, 201, 257}, ContigInterval{0, 1, 100000},
+    ContigInterval{1, 30001, 40000}, ContigInterval{1, 59601, 70000}, ContigInterval{1, 94001, 100000}};
+  auto expected = vector<string>{};
+  for (const auto& sam : IndexedSingleSamReader{"testdata/test_simple.bam", interval_list})
+    expected.push_back(sam.name());
+  auto names = vector<string>{};
+  for (const auto& sam : IndexedSingleSamReader{"testdata/test_simple.bam", contig_intervals, dictionary})
+    names.push_back(sam.name());
+  BOOST_CHECK_EQUAL(names.size(), 15u);
+  BOOST_CHECK(names == expected);
+
+  auto reader = IndexedSingleSamReader{"testdata/test_simple.bam", vector<ContigInterval>{ContigInterval{0, 1, 100000}}, dictionary};
+  BOOST_CHECK(!(reader.begin() != reader.end()));
+}
+
 BOOST_AUTO_TEST_CASE( current_interval )
 {
   for (const auto& filename : {"testdata/test_simple.bam"}) {
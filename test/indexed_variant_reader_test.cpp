@@ -62,6 +62,86 @@ BOOST_AUTO_TEST_CASE( indexed_variant_reader_partial_test ) {
   }
 }
 
+BOOST_AUTO_TEST_CASE( indexed_variant_reader_contig_intervals_test ) {
+  // a dictionary that doesn't match the file header: ids are translated by name and 21 is skipped
+  const auto dictionary = ContigDictionary{vector<string>{"22", "21", "20", "1"}};
+  for (const auto filename : indexed_variant_bcf_inputs) {
+    auto positions = vector<uint32_t>{};
+    for (const auto& record : IndexedVariantReader<IndexedVariantIterator>{filename, vector<ContigInterval>{ContigInterval{2, 10001000, 10002000}, ContigInterval{1, 1, 1000000000}, ContigInterval{3, 1, 10000000}}, dictionary})
+      positions.push_back(record.alignment_start());
+    BOOST_CHECK((positions == vector<uint32_t>{10001000, 10002000, 10000000}));
+
+    auto n_records = 0u;
+    for (const auto& record : IndexedVariantReader<IndexedVariantIterator>{filename, vector<ContigInterval>{}, dictionary}) {
+      (void) record;
+      ++n_records;
+    }
+    BOOST_CHECK_EQUAL(n_records, 0u);
+  }
+}
+
+BOOST_AUTO_TEST_CASE( indexed_variant_reader_sites_only_test ) {
+  for (const auto filename : indexed_variant_bcf_inputs) {
+    auto positions = vector<uint32_t>{};
+    for (const auto& record : IndexedVariantReader<IndexedVariantIterator>{filename, indexed_variant_bp_full, VariantDecodingOptions{VariantUnpackLevel::SITES_ONLY}}) {
+      BOOST_CHECK_EQUAL(record.n_samples(), 0u);
+      positions.push_back(record.alignment_start());
+    }
+    BOOST_CHECK((positions == vector<uint32_t>{10000000, 10001000, 10002000, 10003000, 10004000}));
+  }
+}
+
+BOOST_AUTO_TEST_CASE( indexed_variant_reader_contig_intervals_projection_test ) {
+  // the compact interval constructors take the same decoding options as the string ones
+  const auto dictionary = ContigDictionary{vector<string>{"1", "20", "22"}};
+  const auto intervals = vector<ContigInterval>{ContigInterval{0, 1, 1000000000}, ContigInterval{1, 1, 1000000000}, ContigInterval{2, 1, 1000000000}};
+  for (const auto filename : indexed_variant_bcf_inputs) {
+    auto gqs = vector<vector<int32_t>>{};
+    for (const auto& record : IndexedVariantReader<IndexedVariantIterator>{filename, indexed_variant_chrom_full}) {
+      auto gq = vector<int32_t>{};
+      for (const auto& value : record.integer_individual_field("GQ"))
+        gq.push_back(value[0]);
+      gqs.push_back(gq);
+    }
+    auto projected_gqs = vector<vector<int32_t>>{};
+    const auto reader = IndexedVariantReader<IndexedVariantIterator>{filename, intervals, dictionary, VariantDecodingOptions{VariantUnpackLevel::ALL, {"GT", "GQ"}}};
+    for (const auto& record : reader) {
+      BOOST_CHECK_EQUAL(record.genotypes().size(), 3u);
+      BOOST_CHECK(record.integer_individual_field("PL").empty());      // dropped
+      auto gq = vector<int32_t>{};
+      for (const auto& value : record.integer_individual_field("GQ"))
+        gq.push_back(value[0]);
+      projected_gqs.push_back(gq);
+    }
+    BOOST_CHECK(projected_gqs == gqs);
+
+    auto predicate = VariantSitePredicate{reader.header()};
+    predicate.in_chromosomes({"20"});
+    auto positions = vector<uint32_t>{};
+    for (const auto& record : reader.filter_sites(predicate)) {
+      BOOST_CHECK(record.integer_individual_field("PL").empty());
+      positions.push_back(record.alignment_start());
+    }
+    BOOST_CHECK((positions == vector<uint32_t>{10001000, 10002000, 10003000}));
+
+    positions.clear();
+    for (const auto& record : IndexedVariantReader<IndexedVariantIterator>{filename, intervals, dictionary, VariantDecodingOptions{VariantUnpackLevel::SITES_ONLY}}) {
+      BOOST_CHECK_EQUAL(record.n_samples(), 0u);
+      positions.push_back(record.alignment_start());
+    }
+    BOOST_CHECK((positions == vector<uint32_t>{10000000, 10001000, 10002000, 10003000, 10004000, 10005000, 10006000}));
+  }
+  BOOST_CHECK_THROW((IndexedVariantReader<IndexedVariantIterator>{indexed_variant_bcf_inputs[0], intervals, dictionary, VariantDecodingOptions{VariantUnpackLevel::ALL, {"GT", "FOO"}}}), HeaderFieldNotFoundException);
+  // both options at once: the fields are still checked against the header before the samples are dropped
+  auto n_records = 0u;
+  for (const auto& record : IndexedVariantReader<IndexedVariantIterator>{indexed_variant_bcf_inputs[0], intervals, dictionary, VariantDecodingOptions{VariantUnpackLevel::SITES_ONLY, {"GT"}}}) {
+    BOOST_CHECK_EQUAL(record.n_samples(), 0u);
+    ++n_records;
+  }
+  BOOST_CHECK_EQUAL(n_records, 7u);
+  BOOST_CHECK_THROW((IndexedVariantReader<IndexedVariantIterator>{indexed_variant_bcf_inputs[0], intervals, dictionary, VariantDecodingOptions{VariantUnpackLevel::SITES_ONLY, {"FOO"}}}), HeaderFieldNotFoundException);
+}
+
 BOOST_AUTO_TEST_CASE( indexed_variant_reader_move_test ) {
   for (const auto filename : indexed_variant_bcf_inputs) {
     auto reader0 = IndexedVariantReader<IndexedVariantIterator>{filename, indexed_variant_chrom_full};
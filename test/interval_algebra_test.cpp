@@ -0,0 +1,120 @@
+#include "interval_algebra.h"
+#include "sam/sam_reader.h"
+#include "variant/variant_reader.h"
+
+#include <boost/test/unit_test.hpp>
+
+#include <string>
+#include <vector>
+#include <set>
+#include <random>
+#include <stdexcept>
+
+using namespace std;
+using namespace gamgee;
+
+using Loci = set<pair<string, uint32_t>>;
+
+Loci loci(const vector<Interval>& intervals) {
+  auto result = Loci{};
+  for (const auto& interval : intervals)
+    for (auto position = interval.start(); position <= interval.stop(); ++position)
+      result.emplace(interval.chr(), position);
+  return result;
+}
+
+// checks that the intervals are sorted in the given contig order and don't overlap or abut
+void check_merged(const vector<Interval>& intervals, const vector<string>& contig_order) {
+  for (auto i = 1u; i < intervals.size(); ++i) {
+    const auto& previous = intervals[i - 1];
+    const auto& current = intervals[i];
+    if (previous.chr() == current.chr())
+      BOOST_CHECK_LT(previous.stop() + 1, current.start());
+    else
+      BOOST_CHECK(find(contig_order.begin(), contig_order.end(), previous.chr()) < find(contig_order.begin(), contig_order.end(), current.chr()));
+  }
+}
+
+vector<Interval> random_intervals(mt19937& generator, const uint32_t n) {
+  const auto contigs = vector<string>{"2", "1", "10", "X"};
+  auto pick_contig = uniform_int_distribution<size_t>{0, contigs.size() - 1};
+  auto pick_start = uniform_int_distribution<uint32_t>{1, 300};
+  auto pick_length = uniform_int_distribution<uint32_t>{1, 40};
+  auto result = vector<Interval>{};
+  for (auto i = 0u; i != n; ++i) {
+    const auto start = pick_start(generator);
+    result.emplace_back(contigs[pick_contig(generator)], start, start + pick_length(generator) - 1);
+  }
+  return result;
+}
+
+BOOST_AUTO_TEST_CASE( interval_algebra_against_brute_force )
+{
+  auto generator = mt19937{3};
+  const auto order = vector<string>{"1", "2", "10", "X"};
+  for (auto trial = 0u; trial != 50; ++trial) {
+    const auto lhs = random_intervals(generator, 1 + trial);
+    const auto rhs = random_intervals(generator, 1 + trial * 2);
+    const auto lhs_loci = loci(lhs);
+    const auto rhs_loci = loci(rhs);
+
+    const auto sorted = sort_intervals(lhs, order);
+    BOOST_CHECK_EQUAL(sorted.size(), lhs.size());
+    BOOST_CHECK(loci(sorted) == lhs_loci);
+
+    const auto merged = merge_intervals(lhs, 0, order);
+    BOOST_CHECK(loci(merged) == lhs_loci);
+    check_merged(merged, order);
+
+    auto intersection = Loci{};
+    auto difference = Loci{};
+    for (const auto& locus : lhs_loci)
+      (rhs_loci.count(locus) ? intersection : difference).insert(locus);
+    const auto intersected = intersect_intervals(lhs, rhs, order);
+    BOOST_CHECK(loci(intersected) == intersection);
+    check_merged(intersected, order);
+    const auto subtracted = subtract_intervals(lhs, rhs, order);
+    BOOST_CHECK(loci(subtracted) == difference);
+    check_merged(subtracted, order);
+
+    const auto split = split_intervals(merged, 7);
+    BOOST_CHECK(loci(split) == lhs_loci);
+    for (const auto& piece : split)
+      BOOST_CHECK_LE(piece.size(), 7u);
+  }
+}
+
+BOOST_AUTO_TEST_CASE( interval_algebra_merge_with_padding )
+{
+  const auto intervals = vector<Interval>{Interval{"2", 50, 60}, Interval{"1", 5, 10}, Interval{"1", 30, 40}, Interval{"1", 20, 24}, Interval{"2", 80, 90}, Interval{"1", 20, 22}};
+  const auto unpadded = merge_intervals(intervals);
+  BOOST_CHECK((unpadded == vector<Interval>{Interval{"1", 5, 10}, Interval{"1", 20, 24}, Interval{"1", 30, 40}, Interval{"2", 50, 60}, Interval{"2", 80, 90}}));
+  const auto padded = merge_intervals(intervals, 5);
+  BOOST_CHECK((padded == vector<Interval>{Interval{"1", 1, 45}, Interval{"2", 45, 65}, Interval{"2", 75, 95}}));
+  const auto ordered = merge_intervals(intervals, 0, vector<string>{"2", "1"});
+  BOOST_CHECK(ordered.front() == (Interval{"2", 50, 60}));
+  BOOST_CHECK((merge_intervals(vector<Interval>{Interval{"1", 1, 10}, Interval{"1", 11, 20}}) == vector<Interval>{Interval{"1", 1, 20}}));  // abutting
+  BOOST_CHECK(merge_intervals(vector<Interval>{}).empty());
+}
+
+BOOST_AUTO_TEST_CASE( interval_algebra_split )
+{
+  const auto split = split_intervals(vector<Interval>{Interval{"1", 1, 10}, Interval{"2", 5, 5}}, 4);
+  BOOST_CHECK((split == vector<Interval>{Interval{"1", 1, 4}, Interval{"1", 5, 8}, Interval{"1", 9, 10}, Interval{"2", 5, 5}}));
+  BOOST_CHECK_THROW(split_intervals(split, 0), invalid_argument);
+}
+
+BOOST_AUTO_TEST_CASE( interval_algebra_complement )
+{
+  const auto sam_header = SingleSamReader{"testdata/test_simple.bam"}.header();  // chr1 of length 100000
+  BOOST_CHECK(contig_order(sam_header) == vector<string>{"chr1"});
+  const auto targets = vector<Interval>{Interval{"chr1", 1, 10}, Interval{"chr1", 500, 600}, Interval{"chr5", 1, 10}};
+  BOOST_CHECK((complement_intervals(targets, sam_header) == vector<Interval>{Interval{"chr1", 11, 499}, Interval{"chr1", 601, 100000}}));
+
+  const auto variant_header = SingleVariantReader{"testdata/test_variants.vcf"}.header();  // 1, 20 and 22
+  BOOST_CHECK((contig_order(variant_header) == vector<string>{"1", "20", "22"}));
+  BOOST_CHECK_EQUAL(variant_header.chromosome_length("20"), 64000000u);
+  BOOST_CHECK_EQUAL(variant_header.chromosome_length("foo"), 0u);
+  const auto complement = complement_intervals(vector<Interval>{Interval{"20", 100, 64000000}, Interval{"1", 1, 300000000}}, variant_header);
+  BOOST_CHECK((complement == vector<Interval>{Interval{"20", 1, 99}, Interval{"22", 1, 120000000}}));
+}
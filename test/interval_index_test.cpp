@@ -0,0 +1,131 @@
+#include "interval_index.h"
+
+#include <boost/test/unit_test.hpp>
+
+#include <string>
+#include <vector>
+#include <random>
+#include <algorithm>
+
+using namespace std;
+using namespace gamgee;
+
+vector<uint32_t> brute_force_overlaps(const vector<Interval>& intervals, const string& chr, const uint32_t start, const uint32_t stop) {
+  auto result = vector<uint32_t>{};
+  for (auto i = 0u; i != intervals.size(); ++i)
+    if (intervals[i].chr() == chr && intervals[i].start() <= stop && intervals[i].stop() >= start)
+      result.push_back(i);
+  return result;
+}
+
+vector<Interval> random_intervals(mt19937& generator, const uint32_t n, const uint32_t max_length) {
+  const auto contigs = vector<string>{"1", "2", "X"};
+  auto pick_contig = uniform_int_distribution<size_t>{0, contigs.size() - 1};
+  auto pick_start = uniform_int_distribution<uint32_t>{1, 10000};
+  auto pick_length = uniform_int_distribution<uint32_t>{1, max_length};
+  auto result = vector<Interval>{};
+  for (auto i = 0u; i != n; ++i) {
+    const auto start = pick_start(generator);
+    result.emplace_back(contigs[pick_contig(generator)], start, start + pick_length(generator) - 1);
+  }
+  return result;
+}
+
+vector<uint32_t> sorted(vector<uint32_t> ids) {
+  sort(ids.begin(), ids.end());
+  return ids;
+}
+
+BOOST_AUTO_TEST_CASE( interval_index_queries )
+{
+  auto generator = mt19937{7};
+  for (const auto max_length : {1u, 50u, 5000u}) {
+    const auto targets = random_intervals(generator, 500, max_length);
+    const auto index = IntervalIndex{targets};
+    BOOST_CHECK_EQUAL(index.size(), targets.size());
+    for (const auto& probe : random_intervals(generator, 2000, 300)) {
+      const auto truth = brute_force_overlaps(targets, probe.chr(), probe.start(), probe.stop());
+      const auto hits = index.find_overlaps(probe);
+      BOOST_CHECK(sorted(hits) == truth);
+      BOOST_CHECK(is_sorted(hits.begin(), hits.end(), [&](const uint32_t lhs, const uint32_t rhs) { return index.interval(lhs).start() < index.interval(rhs).start(); }));
+      BOOST_CHECK_EQUAL(index.overlaps(probe), !truth.empty());
+      BOOST_CHECK_EQUAL(index.contains(probe.chr(), probe.start()), !brute_force_overlaps(targets, probe.chr(), probe.start(), probe.start()).empty());
+    }
+    BOOST_CHECK(index.find_overlaps("Y", 1, 100000).empty());
+    BOOST_CHECK(!index.overlaps("Y", 1, 100000));
+  }
+}
+
+BOOST_AUTO_TEST_CASE( interval_index_cursor )
+{
+  auto generator = mt19937{11};
+  for (const auto max_length : {1u, 50u, 5000u}) {
+    const auto targets = random_intervals(generator, 500, max_length);
+    const auto index = IntervalIndex{targets};
+    auto probes = random_intervals(generator, 3000, 300);
+    probes.emplace_back("Y", 1, 10);
+    sort(probes.begin(), probes.end(), [](const Interval& lhs, const Interval& rhs) { return lhs.chr() < rhs.chr() || (lhs.chr() == rhs.chr() && lhs.start() < rhs.start()); });
+    auto sorted_cursor = index.cursor();
+    for (const auto& probe : probes) {
+      const auto truth = brute_force_overlaps(targets, probe.chr(), probe.start(), probe.stop());
+      BOOST_CHECK(sorted(sorted_cursor.find_overlaps(probe.chr(), probe.start(), probe.stop())) == truth);
+      BOOST_CHECK_EQUAL(sorted_cursor.overlaps(probe), !truth.empty());
+    }
+    shuffle(probes.begin(), probes.end(), generator);  // out of order probes are still answered correctly
+    auto unsorted_cursor = index.cursor();
+    for (const auto& probe : probes)
+      BOOST_CHECK(sorted(unsorted_cursor.find_overlaps(probe.chr(), probe.start(), probe.stop())) == brute_force_overlaps(targets, probe.chr(), probe.start(), probe.stop()));
+  }
+}
+
+BOOST_AUTO_TEST_CASE( interval_index_nested_and_empty )
+{
+  const auto targets = vector<Interval>{Interval{"1", 1, 1000}, Interval{"1", 10, 20}, Interval{"1", 30, 40}, Interval{"2", 5, 5}, Interval{"1", 10, 20}};
+  const auto index = IntervalIndex{targets};
+  BOOST_CHECK((index.find_overlaps("1", 15, 35) == vector<uint32_t>{0, 1, 4, 2}));
+  BOOST_CHECK((index.find_overlaps("1", 500, 600) == vector<uint32_t>{0}));
+  BOOST_CHECK((index.find_overlaps("2", 1, 5) == vector<uint32_t>{3}));
+  BOOST_CHECK(index.find_overlaps("2", 6, 10).empty());
+  const auto empty = IntervalIndex{vector<Interval>{}};
+  BOOST_CHECK(empty.empty());
+  BOOST_CHECK(!empty.overlaps("1", 1, 10));
+  BOOST_CHECK(!empty.cursor().overlaps("1", 1, 10));
+}
+
+BOOST_AUTO_TEST_CASE( interval_index_long_interval )
+{
+  // a whole chromosome target first, then many short ones: queries must not walk back to it
+  const auto n_short = 100000u;
+  auto targets = vector<Interval>{Interval{"1", 1, 100 * n_short}};
+  for (auto i = 0u; i != n_short; ++i)
+    targets.emplace_back("1", 100 * i + 50, 100 * i + 59);
+  const auto index = IntervalIndex{targets};
+  auto cursor = index.cursor();
+  auto generator = mt19937{13};
+  auto pick_start = uniform_int_distribution<uint32_t>{1, 100 * n_short};
+  auto pick_length = uniform_int_distribution<uint32_t>{1, 300};
+  auto probes = vector<Interval>{};
+  for (auto i = 0u; i != 2000; ++i) {
+    const auto start = pick_start(generator);
+    probes.emplace_back("1", start, start + pick_length(generator) - 1);
+  }
+  sort(probes.begin(), probes.end(), [](const Interval& lhs, const Interval& rhs) { return lhs.start() < rhs.start(); });
+  auto total_hits = 0u;
+  auto total_cursor_examined = 0u;
+  for (const auto& probe : probes) {
+    auto truth = vector<uint32_t>{0};  // short interval i (id i + 1) spans [100i + 50, 100i + 59]
+    for (auto i = probe.start() < 59 ? 0 : (probe.start() - 59 + 99) / 100; i < n_short && 100 * i + 50 <= probe.stop(); ++i)
+      truth.push_back(i + 1);
+    total_hits += truth.size();
+    auto hits = vector<uint32_t>{};
+    const auto examined = index.for_each_overlap(probe.chr(), probe.start(), probe.stop(), [&hits](const uint32_t id) { hits.push_back(id); });
+    BOOST_CHECK(sorted(hits) == truth);
+    BOOST_CHECK_LE(examined, truth.size() + 100);  // O(log n + overlaps), not O(n) as when walking back to the long interval
+    auto cursor_hits = vector<uint32_t>{};
+    const auto cursor_examined = cursor.for_each_overlap(probe.chr(), probe.start(), probe.stop(), [&cursor_hits](const uint32_t id) { cursor_hits.push_back(id); });
+    BOOST_CHECK(sorted(cursor_hits) == truth);
+    total_cursor_examined += cursor_examined;
+  }
+  // the sweep examines each interval once when it starts plus once per probe it is still active for
+  BOOST_CHECK_LE(total_cursor_examined, index.size() + 2 * total_hits);
+}
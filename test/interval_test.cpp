@@ -8,6 +8,9 @@
 #include <string>
 #include <fstream>
 #include <cmath>
+#include <sstream>
+
+#include <boost/lexical_cast.hpp>
 
 using namespace std;
 using namespace gamgee;
@@ -46,6 +49,23 @@ BOOST_AUTO_TEST_CASE( read_interval_files )
 }
 
 
+BOOST_AUTO_TEST_CASE( read_intervals_from_stream )
+{
+  auto input = istringstream{"@HD\tVN:1.0\n@SQ\tSN:1\tLN:100\n1\t10\t20\t+\ttarget-1\n\n  \nchrUn_gl000220:5-6\r\n2 7\nchrUn_gl000220\t30\t40"};
+  const auto intervals = read_intervals(input);
+  BOOST_REQUIRE_EQUAL(intervals.size(), 4u);
+  check_interval(intervals[0], Interval{"1", 10, 20});
+  check_interval(intervals[1], Interval{"chrUn_gl000220", 5, 6});
+  check_interval(intervals[2], Interval{"2", 7, 7});
+  check_interval(intervals[3], Interval{"chrUn_gl000220", 30, 40});
+  BOOST_CHECK(read_intervals("testdata/does_not_exist.intervals").empty());
+  for (const auto& bad_record : {"1:abc-10", "1:10-2x", "1\t99999999999\t100000000000"}) {
+    auto bad_input = istringstream{bad_record};
+    BOOST_CHECK_THROW(read_intervals(bad_input), boost::bad_lexical_cast);
+  }
+}
+
+
 void check_interval_conversion(const Interval& interval, const string& truth_file) {
   ostringstream test;
   ifstream truth_stream{truth_file}; 
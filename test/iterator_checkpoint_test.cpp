@@ -0,0 +1,83 @@
+#include "iterator_checkpoint.h"
+#include "exceptions.h"
+#include "sam/sam_reader.h"
+#include "sam/indexed_sam_reader.h"
+#include "variant/variant_reader.h"
+#include "variant/indexed_variant_reader.h"
+
+#include <boost/test/unit_test.hpp>
+
+#include <string>
+#include <vector>
+#include <stdexcept>
+
+using namespace std;
+using namespace gamgee;
+
+BOOST_AUTO_TEST_CASE( iterator_checkpoint_string_round_trip )
+{
+  const auto checkpoint = IteratorCheckpoint{(uint64_t{123456} << 16) | 789, 42};
+  BOOST_CHECK_EQUAL(checkpoint.str(), "42:" + to_string((uint64_t{123456} << 16) | 789));
+  BOOST_CHECK(IteratorCheckpoint{checkpoint.str()} == checkpoint);
+  BOOST_CHECK(IteratorCheckpoint{} != checkpoint);
+  for (const auto invalid : {"", "12", ":12", "12:", "a:12", "1:-2", "1:2:3", "1::2", "::", "4294967296:0", "0:18446744073709551616"})
+    BOOST_CHECK_THROW(IteratorCheckpoint{string{invalid}}, invalid_argument);
+  const auto largest = IteratorCheckpoint{"4294967295:18446744073709551615"};
+  BOOST_CHECK_EQUAL(largest.interval, UINT32_MAX);
+  BOOST_CHECK_EQUAL(largest.offset, UINT64_MAX);
+}
+
+// resuming from the checkpoint taken at every record must give the remaining records
+template <class READER_FACTORY, class KEY>
+void check_resume_everywhere(READER_FACTORY&& make_reader, KEY&& key) {
+  auto keys = vector<string>{};
+  auto checkpoints = vector<IteratorCheckpoint>{};
+  auto reader = make_reader();
+  for (auto iterator = reader.begin(); iterator != reader.end(); ++iterator) {
+    keys.push_back(key(*iterator));
+    checkpoints.push_back(iterator.checkpoint());
+  }
+  BOOST_REQUIRE(!keys.empty());
+  for (auto i = 0u; i != checkpoints.size(); ++i) {
+    auto resumed_reader = make_reader();
+    auto iterator = resumed_reader.begin();
+    iterator.resume(IteratorCheckpoint{checkpoints[i].str()});
+    auto remaining = vector<string>{};
+    for (; iterator != resumed_reader.end(); ++iterator)
+      remaining.push_back(key(*iterator));
+    BOOST_CHECK(remaining == vector<string>(keys.begin() + i + 1, keys.end()));
+  }
+}
+
+BOOST_AUTO_TEST_CASE( sam_iterator_checkpoints )
+{
+  const auto key = [](const Sam& record) { return record.name() + ":" + to_string(record.alignment_start()) + ":" + to_string(record.mate_alignment_start()); };
+  check_resume_everywhere([]{ return SingleSamReader{"testdata/test_simple.bam"}; }, key);
+  check_resume_everywhere([]{ return IndexedSingleSamReader{"testdata/test_simple.bam", vector<string>{"chr1:201-257", "chr1:30001-40000", "chr1:94001"}}; }, key);
+  check_resume_everywhere([]{ return IndexedSingleSamReader{"testdata/test_simple.bam", vector<string>{"."}}; }, key);
+
+  // seek(tell()) is a no-op on the record sequence
+  auto reader = SingleSamReader{"testdata/test_simple.bam"};
+  auto iterator = reader.begin();
+  const auto first = (*iterator).name();
+  const auto start = iterator.tell();
+  ++iterator;
+  const auto second = (*iterator).name();
+  ++iterator;
+  iterator.seek(start);
+  BOOST_CHECK_EQUAL((*iterator).name(), second);
+  BOOST_CHECK_NE(first, "");
+
+  auto text_reader = SingleSamReader{"testdata/test_simple.sam"};
+  BOOST_CHECK_THROW(text_reader.begin().tell(), FileSeekException);
+}
+
+BOOST_AUTO_TEST_CASE( variant_iterator_checkpoints )
+{
+  const auto key = [](const Variant& record) { return to_string(record.chromosome()) + ":" + to_string(record.alignment_start()) + ":" + record.ref(); };
+  check_resume_everywhere([]{ return SingleVariantReader{"testdata/var_idx/test_variants.bcf"}; }, key);
+  check_resume_everywhere([]{ return IndexedVariantReader<IndexedVariantIterator>{"testdata/var_idx/test_variants.bcf", vector<string>{"1", "20:10001000-10002000", "22"}}; }, key);
+
+  auto text_reader = SingleVariantReader{"testdata/test_variants.vcf"};
+  BOOST_CHECK_THROW(text_reader.begin().checkpoint(), FileSeekException);
+}
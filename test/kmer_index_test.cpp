@@ -0,0 +1,145 @@
+#include "kmer_index.h"
+#include "reference_map.h"
+#include "exceptions.h"
+#include "utils/utils.h"
+
+#include <boost/test/unit_test.hpp>
+
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <stdexcept>
+#include <cstdio>
+#include <fstream>
+#include <random>
+
+using namespace std;
+using namespace gamgee;
+
+// brute force search of a k-mer on both strands of every contig
+vector<KmerHit> find_kmer(const ReferenceMap& reference, const KmerIndex& index, const string& kmer) {
+  auto result = vector<KmerHit>{};
+  const auto reverse = utils::reverse_complement(kmer);
+  for (auto contig = 0u; contig != index.n_contigs(); ++contig) {
+    const auto& sequence = reference.at(index.contig_name(contig));
+    for (auto i = 0u; i + kmer.size() <= sequence.size(); ++i) {
+      if (sequence.compare(i, kmer.size(), kmer) == 0)
+        result.push_back(KmerHit{contig, i + 1, false});
+      if (sequence.compare(i, kmer.size(), reverse) == 0)
+        result.push_back(KmerHit{contig, i + 1, true});
+    }
+  }
+  return result;
+}
+
+void check_against_brute_force(const ReferenceMap& reference, const KmerIndex& index) {
+  auto kmers = vector<string>{};
+  for (const auto& contig : reference)
+    for (auto i = 0u; i + index.k() <= contig.second.size(); ++i)
+      kmers.push_back(contig.second.substr(i, index.k()));
+  kmers.push_back(string(index.k(), 'A'));
+  kmers.push_back(string(index.k(), 'G'));
+  for (const auto& kmer : kmers) {
+    auto hits = index.lookup(kmer);
+    BOOST_CHECK_EQUAL(index.count(kmer), hits.size());
+    if (kmer.find_first_not_of("ACGT") != string::npos) {
+      BOOST_CHECK(hits.empty());
+      continue;
+    }
+    const auto truth = find_kmer(reference, index, kmer);
+    BOOST_CHECK_EQUAL(hits.size(), truth.size());
+    for (const auto& hit : truth)
+      BOOST_CHECK(find(hits.begin(), hits.end(), hit) != hits.end());
+  }
+}
+
+BOOST_AUTO_TEST_CASE( kmer_index_lookup_test )
+{
+  const auto reference = ReferenceMap{"testdata/test_reference2.fa"};
+  for (const auto k : {1u, 2u, 3u, 5u, 8u, 12u, 31u, 32u}) {
+    for (const auto n_threads : {1u, 4u}) {
+      const auto index = KmerIndex::build(reference, k, n_threads);
+      BOOST_CHECK_EQUAL(index.k(), k);
+      BOOST_CHECK_EQUAL(index.n_contigs(), reference.size());
+      check_against_brute_force(reference, index);
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE( kmer_index_queries_test )
+{
+  const auto reference = ReferenceMap{"testdata/test_reference2.fa"};
+  const auto index = KmerIndex::build(reference, 6);
+  BOOST_CHECK_EQUAL(index.contig_name(0), "chr1");
+  BOOST_CHECK_EQUAL(index.contig_name(1), "chr2");
+  BOOST_CHECK(index.lookup("AGGGAT") == index.lookup("agggat"));       // case insensitive
+  BOOST_CHECK(index.lookup("AGGGA").empty());                          // wrong size
+  BOOST_CHECK(index.lookup("AGGGNT").empty());                         // not indexed
+  BOOST_CHECK_EQUAL(index.count("AGGGAT"), 2u);
+  BOOST_CHECK(index.lookup("AGGGAT")[0] == (KmerHit{0, 1, false}));
+  BOOST_CHECK(index.lookup("ATCCCT")[0] == (KmerHit{0, 1, true}));     // reverse complement of AGGGAT
+  BOOST_CHECK_THROW(KmerIndex::build(reference, 0), invalid_argument);
+  BOOST_CHECK_THROW(KmerIndex::build(reference, 33), invalid_argument);
+}
+
+BOOST_AUTO_TEST_CASE( kmer_index_save_and_map_test )
+{
+  const auto filename = string{"testdata/kmer_index_test.gki"};
+  const auto reference = ReferenceMap{"testdata/test_reference.fa"};
+  for (const auto k : {4u, 11u, 32u}) {
+    const auto built = KmerIndex::build(reference, k, 2);
+    built.save(filename);
+    const auto mapped = KmerIndex{filename};
+    BOOST_CHECK_EQUAL(mapped.k(), k);
+    BOOST_CHECK_EQUAL(mapped.size(), built.size());
+    BOOST_CHECK_EQUAL(mapped.n_contigs(), built.n_contigs());
+    for (auto contig = 0u; contig != built.n_contigs(); ++contig)
+      BOOST_CHECK_EQUAL(mapped.contig_name(contig), built.contig_name(contig));
+    check_against_brute_force(reference, mapped);
+    const auto copy = mapped;  // copies share the mapping
+    BOOST_CHECK_EQUAL(copy.size(), mapped.size());
+  }
+  remove(filename.c_str());
+  BOOST_CHECK_THROW(KmerIndex{"testdata/test_reference.fa"}, HeaderReadException);
+  BOOST_CHECK_THROW(KmerIndex{"testdata/does_not_exist.gki"}, FileOpenException);
+}
+
+BOOST_AUTO_TEST_CASE( kmer_index_packed_test )
+{
+  // contigs of lengths that are not multiples of the packing word, with runs of N, large enough to fill the prefix table
+  const auto fasta = string{"testdata/kmer_index_test.fa"};
+  auto generator = mt19937{7};
+  auto bases = uniform_int_distribution<int>{0, 3};
+  {
+    auto output = ofstream{fasta};
+    for (const auto length : {5003u, 33u, 12000u}) {
+      auto sequence = string{};
+      for (auto i = 0u; i != length; ++i)
+        sequence.push_back(i % 1000 < 10 ? 'N' : "ACGT"[bases(generator)]);
+      output << ">contig" << length << "\n" << sequence << "\n";
+    }
+  }
+  const auto reference = ReferenceMap{fasta};
+  const auto filename = string{"testdata/kmer_index_test.gki"};
+  for (const auto k : {7u, 21u, 32u}) {
+    const auto index = KmerIndex::build(reference, k, 2);
+    index.save(filename);
+    const auto mapped = KmerIndex{filename};
+    for (const auto& contig : reference) {
+      for (auto i = 0u; i + k <= contig.second.size(); i += 97) {
+        const auto kmer = contig.second.substr(i, k);
+        const auto hits = mapped.lookup(kmer);
+        BOOST_CHECK(hits == index.lookup(kmer));
+        if (kmer.find('N') != string::npos)
+          BOOST_CHECK(hits.empty());
+        else
+          BOOST_CHECK(hits == find_kmer(reference, mapped, kmer));   // same order: by contig, position and strand
+      }
+    }
+    // 4 bytes per k-mer, 2 bits per base and the prefix table
+    auto file = ifstream{filename, ios::binary | ios::ate};
+    BOOST_CHECK_LE(static_cast<uint64_t>(file.tellg()), 5 * 17036u + 1024u);
+  }
+  remove(filename.c_str());
+  remove(fasta.c_str());
+}
@@ -0,0 +1,67 @@
+#include "utils/loser_tree.h"
+
+#include <boost/test/unit_test.hpp>
+
+#include <algorithm>
+#include <random>
+#include <utility>
+#include <vector>
+
+using namespace std;
+using namespace gamgee::utils;
+
+// merges sorted inputs with a LoserTree, returning the (key, input) pairs in the order they come out
+vector<pair<uint64_t, uint32_t>> tree_merge(const vector<vector<uint64_t>>& inputs) {
+  auto positions = vector<size_t>(inputs.size(), 0);
+  auto keys = vector<uint64_t>{};
+  for (const auto& input : inputs)
+    keys.push_back(input.empty() ? LoserTree::EXHAUSTED : input[0]);
+  auto tree = LoserTree{keys};
+  BOOST_CHECK_EQUAL(tree.size(), inputs.size());
+  auto result = vector<pair<uint64_t, uint32_t>>{};
+  while (!tree.empty()) {
+    const auto input = tree.winner();
+    BOOST_REQUIRE_EQUAL(tree.winner_key(), inputs[input][positions[input]]);
+    result.emplace_back(tree.winner_key(), input);
+    const auto next = ++positions[input];
+    tree.replace_winner(next == inputs[input].size() ? LoserTree::EXHAUSTED : inputs[input][next]);
+  }
+  return result;
+}
+
+// the expected merge: by key, then by input for equal keys
+vector<pair<uint64_t, uint32_t>> sorted_merge(const vector<vector<uint64_t>>& inputs) {
+  auto result = vector<pair<uint64_t, uint32_t>>{};
+  for (auto input = 0u; input != inputs.size(); ++input) {
+    for (const auto key : inputs[input])
+      result.emplace_back(key, input);
+  }
+  stable_sort(result.begin(), result.end());
+  return result;
+}
+
+BOOST_AUTO_TEST_CASE( loser_tree_small_inputs )
+{
+  BOOST_CHECK(LoserTree{}.empty());
+  BOOST_CHECK(LoserTree{vector<uint64_t>{}}.empty());
+  BOOST_CHECK(tree_merge({{}}).empty());
+  BOOST_CHECK(tree_merge({{}, {}, {}}).empty());
+  BOOST_CHECK((tree_merge({{1, 2, 5}}) == vector<pair<uint64_t, uint32_t>>{{1, 0}, {2, 0}, {5, 0}}));
+  BOOST_CHECK((tree_merge({{2, 4}, {}, {1, 4, 4}}) == vector<pair<uint64_t, uint32_t>>{{1, 2}, {2, 0}, {4, 0}, {4, 2}, {4, 2}}));
+}
+
+BOOST_AUTO_TEST_CASE( loser_tree_random_inputs )
+{
+  auto generator = mt19937{42};
+  auto pick_step = uniform_int_distribution<uint64_t>{0, 3};   // repeated keys within and across inputs
+  for (const auto n_inputs : {2u, 3u, 7u, 8u, 33u, 100u}) {
+    auto inputs = vector<vector<uint64_t>>(n_inputs);
+    for (auto& input : inputs) {
+      auto key = uint64_t{0};
+      const auto size = generator() % 50;
+      for (auto i = 0u; i != size; ++i)
+        input.push_back(key += pick_step(generator));
+    }
+    BOOST_CHECK(tree_merge(inputs) == sorted_merge(inputs));
+  }
+}
@@ -2,9 +2,14 @@
 #include "variant/variant_header_builder.h"
 #include "variant/multiple_variant_reader.h"
 #include "variant/multiple_variant_iterator.h"
+#include "variant/hierarchical_variant_merge.h"
 #include "test_utils.h"
+#include "utils/hts_memory.h"
 
 #include <boost/test/unit_test.hpp>
+#include <fstream>
+#include <stdexcept>
+#include <tuple>
 #include <unordered_set>
 
 using namespace std;
@@ -62,6 +67,121 @@ BOOST_AUTO_TEST_CASE( multiple_variant_reader_difference_test ) {
   BOOST_CHECK_EQUAL(truth_index, 8u);
 }
 
+BOOST_AUTO_TEST_CASE( multiple_variant_reader_kept_records_test ) {
+  // the records of a vector are not copies: those moved out of it must survive the following vectors
+  auto kept = vector<vector<VariantIndexPair>>{};
+  const auto reader = MultipleVariantReader<MultipleVariantIterator>{{"testdata/test_variants.vcf", "testdata/test_variants_multiple_alt.vcf"}, false};
+  for (auto& vec : reader) {
+    kept.emplace_back();
+    for (auto& pair : vec)
+      kept.back().push_back(move(pair));
+  }
+  BOOST_REQUIRE_EQUAL(kept.size(), 8u);
+  for (auto truth_index = 0u; truth_index != kept.size(); ++truth_index) {
+    BOOST_CHECK_EQUAL(kept[truth_index].size(), multi_diff_truth_record_count[truth_index]);
+    for (const auto& pair : kept[truth_index]) {
+      BOOST_CHECK_EQUAL(pair.first.chromosome(), multi_diff_truth_chromosome[truth_index]);
+      BOOST_CHECK_EQUAL(pair.first.alignment_start(), multi_diff_truth_alignment_starts[truth_index]);
+      BOOST_CHECK_EQUAL(pair.first.ref(), multi_diff_truth_ref[truth_index]);
+      BOOST_CHECK_EQUAL(pair.first.id(), multi_diff_truth_id[truth_index]);
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE( multiple_variant_reader_decoder_threads_test ) {
+  // the inputs decoded ahead by 1 or 2 threads, then an iteration stopped early
+  for (const auto decoder_threads : {1u, 2u}) {
+    auto reader = MultipleVariantReader<MultipleVariantIterator>{{"testdata/test_variants.vcf", "testdata/test_variants_multiple_alt.vcf"}, false};
+    reader.set_decoder_threads(decoder_threads);
+    auto truth_index = 0u;
+    for (const auto& vec : reader) {
+      auto expected_file_indices = truth_file_indices_mult_alt[truth_index];
+      BOOST_CHECK_EQUAL(vec.size(), multi_diff_truth_record_count[truth_index]);
+      for (const auto& pair : vec) {
+        BOOST_CHECK_EQUAL(pair.first.alignment_start(), multi_diff_truth_alignment_starts[truth_index]);
+        BOOST_CHECK_EQUAL(pair.first.ref(), multi_diff_truth_ref[truth_index]);
+        BOOST_CHECK_EQUAL(pair.first.n_samples(), 3u);
+        auto find_result = expected_file_indices.find(pair.second);
+        BOOST_CHECK(find_result != expected_file_indices.end());
+        expected_file_indices.erase(find_result);
+      }
+      BOOST_CHECK(expected_file_indices.empty());
+      ++truth_index;
+    }
+    BOOST_CHECK_EQUAL(truth_index, 8u);
+
+    auto stopped_reader = MultipleVariantReader<MultipleVariantIterator>{{"testdata/test_variants.vcf", "testdata/test_variants_multiple_alt.vcf"}, false};
+    stopped_reader.set_decoder_threads(decoder_threads);
+    for (const auto& vec : stopped_reader) {
+      BOOST_CHECK_EQUAL(vec.size(), 4u);
+      break;    // the decoder threads are stopped with the iterator
+    }
+  }
+}
+
+// the input, position, reference allele and id of each record of each vector, in order
+vector<vector<tuple<uint32_t, uint32_t, uint32_t, string, string>>> merged_records(const MultipleVariantReader<MultipleVariantIterator>& reader) {
+  auto result = vector<vector<tuple<uint32_t, uint32_t, uint32_t, string, string>>>{};
+  for (const auto& vec : reader) {
+    result.emplace_back();
+    for (const auto& pair : vec)
+      result.back().emplace_back(pair.second, pair.first.chromosome(), pair.first.alignment_start(), pair.first.ref(), pair.first.id());
+  }
+  return result;
+}
+
+BOOST_AUTO_TEST_CASE( multiple_variant_reader_hierarchical_merge_test ) {
+  const auto filenames = vector<string>{"testdata/test_variants.vcf", "testdata/test_variants_multiple_alt.vcf", "testdata/test_variants.bcf",
+    "testdata/test_variants_multiple_alt.vcf", "testdata/test_variants.vcf"};
+  const auto flat = merged_records(MultipleVariantReader<MultipleVariantIterator>{filenames, false});
+  BOOST_CHECK_EQUAL(flat.size(), 8u);
+  for (const auto max_open_files : {2u, 3u, 5u}) {
+    for (const auto threads : {0u, 2u}) {
+      auto reader = MultipleVariantReader<MultipleVariantIterator>{filenames, false, max_open_files};
+      reader.set_decoder_threads(threads);
+      BOOST_CHECK(merged_records(reader) == flat);
+      BOOST_CHECK(merged_records(reader) == flat);  // every iteration merges the files again
+    }
+  }
+  BOOST_CHECK_THROW((MultipleVariantReader<MultipleVariantIterator>{filenames, false, 1u}), invalid_argument);
+  BOOST_CHECK_THROW((MultipleVariantReader<MultipleVariantIterator>{{"-", "testdata/test_variants.vcf", "testdata/test_variants.bcf"}, false, 2u}), invalid_argument);
+}
+
+BOOST_AUTO_TEST_CASE( multiple_variant_iterator_removes_streams_on_failure ) {
+  // a stream that can't be opened: the other streams of the merge are deleted all the same
+  const auto filenames = vector<string>{"testdata/test_variants.vcf", "testdata/test_variants_multiple_alt.vcf", "testdata/test_variants.vcf"};
+  auto headers = vector<shared_ptr<bcf_hdr_t>>{};
+  for (const auto& filename : filenames) {
+    const auto file = utils::make_shared_hts_file(bcf_open(filename.c_str(), "r"));
+    headers.push_back(utils::make_shared_variant_header(bcf_hdr_read(file.get())));
+  }
+  auto streams = merge_variant_files_to_streams(filenames, headers, 2, 1);
+  BOOST_REQUIRE_EQUAL(streams.size(), 2u);
+  streams.insert(streams.begin() + 1, "testdata/does_not_exist/stream");
+  BOOST_CHECK_THROW((MultipleVariantIterator{streams, headers}), FileOpenException);
+  BOOST_CHECK(!ifstream{streams[0]}.good());
+  BOOST_CHECK(!ifstream{streams[2]}.good());
+}
+
+BOOST_AUTO_TEST_CASE( multiple_variant_reader_decoder_threads_undeclared_test ) {
+  // parsing these records adds contig 21 and INFO UNDECLARED_INFO to the headers of the inputs
+  const auto filenames = vector<string>{"testdata/undeclared_fields.vcf", "testdata/undeclared_fields.vcf"};
+  const auto serial = merged_records(MultipleVariantReader<MultipleVariantIterator>{filenames, false});
+  BOOST_CHECK_EQUAL(serial.size(), 3u);
+  for (const auto decoder_threads : {1u, 2u}) {
+    auto reader = MultipleVariantReader<MultipleVariantIterator>{filenames, false};
+    reader.set_decoder_threads(decoder_threads);
+    auto chromosome_names = vector<string>{};
+    for (const auto& vec : reader) {
+      BOOST_CHECK_EQUAL(vec.size(), 2u);
+      for (const auto& pair : vec)
+        chromosome_names.push_back(pair.first.chromosome_name());
+    }
+    BOOST_CHECK(chromosome_names == (vector<string>{"20", "20", "20", "20", "21", "21"}));
+    BOOST_CHECK(merged_records(reader) == serial);
+  }
+}
+
 void multiple_variant_reader_sample_test(const vector<string> samples, const bool include, const uint desired_samples) {
   auto filenames = vector<string>{"testdata/test_variants.vcf", "testdata/test_variants.bcf"};
 
@@ -0,0 +1,147 @@
+#include "utils/nucleotide_kernels.h"
+
+#include <boost/test/unit_test.hpp>
+
+#include <string>
+#include <vector>
+#include <random>
+#include <algorithm>
+
+using namespace std;
+using namespace gamgee::utils;
+
+const auto ALL_KERNEL_LEVELS = vector<NucleotideKernelLevel>{NucleotideKernelLevel::SCALAR, NucleotideKernelLevel::SSE4, NucleotideKernelLevel::AVX2};
+
+// sequences of many lengths (to exercise the vector bodies and the scalar tails) with every byte value represented
+vector<string> kernel_test_sequences() {
+  auto generator = mt19937{42};
+  auto bases = string{"ACGTNacgtnRYKMSWBDHVUu=-.*"};
+  auto pick_base = uniform_int_distribution<size_t>{0, bases.size() - 1};
+  auto result = vector<string>{};
+  for (auto length = 0u; length <= 300; ++length) {
+    auto sequence = string(length, 'A');
+    for (auto& base : sequence)
+      base = bases[pick_base(generator)];
+    result.push_back(sequence);
+  }
+  auto all_bytes = string(512, '\0');
+  for (auto i = 0u; i != all_bytes.size(); ++i)
+    all_bytes[i] = static_cast<char>(i);
+  result.push_back(all_bytes);
+  return result;
+}
+
+template <class FUNCTION>
+void check_against_scalar(FUNCTION&& kernel_output) {
+  const auto sequences = kernel_test_sequences();
+  const auto original_level = nucleotide_kernel_level();
+  set_nucleotide_kernel_level(NucleotideKernelLevel::SCALAR);
+  auto truth = vector<decltype(kernel_output(sequences.front()))>{};
+  for (const auto& sequence : sequences)
+    truth.push_back(kernel_output(sequence));
+  for (const auto level : ALL_KERNEL_LEVELS) {
+    if (!nucleotide_kernel_level_supported(level))
+      continue;
+    set_nucleotide_kernel_level(level);
+    BOOST_CHECK(nucleotide_kernel_level() == level);
+    for (auto i = 0u; i != sequences.size(); ++i)
+      BOOST_CHECK(kernel_output(sequences[i]) == truth[i]);
+  }
+  set_nucleotide_kernel_level(original_level);
+}
+
+BOOST_AUTO_TEST_CASE( nucleotide_kernels_scalar_truth )
+{
+  const auto original_level = nucleotide_kernel_level();
+  set_nucleotide_kernel_level(NucleotideKernelLevel::SCALAR);
+  auto seq = string{"ACGTNacgtnRY-"};
+  auto out = string(seq.size(), ' ');
+  complement_bases(seq.data(), &out[0], seq.size());
+  BOOST_CHECK_EQUAL(out, "TGCANtgcanRY-");
+  reverse_complement_bases(seq.data(), &out[0], seq.size());
+  BOOST_CHECK_EQUAL(out, "-YRnacgtNACGT");
+  reverse_complement_bases(&seq[0], seq.size());
+  BOOST_CHECK_EQUAL(seq, "-YRnacgtNACGT");
+  auto packed = vector<uint8_t>(3);
+  pack_bases_4bit("ACGTN", 5, packed.data());
+  BOOST_CHECK_EQUAL(packed[0], 0x12);
+  BOOST_CHECK_EQUAL(packed[1], 0x48);
+  BOOST_CHECK_EQUAL(packed[2], 0xF0);
+  pack_bases_2bit("ACGTt", 5, packed.data());
+  BOOST_CHECK_EQUAL(packed[0], 0xE4);
+  BOOST_CHECK_EQUAL(packed[1], 0x03);
+  auto upper = string{"acgtNnxX"};
+  to_upper_bases(&upper[0], upper.size());
+  BOOST_CHECK_EQUAL(upper, "ACGTNNXX");
+  to_lower_bases(&upper[0], upper.size());
+  BOOST_CHECK_EQUAL(upper, "acgtnnxx");
+  BOOST_CHECK_EQUAL(count_n_bases("NnANCn", 6), 4u);
+  set_nucleotide_kernel_level(original_level);
+}
+
+BOOST_AUTO_TEST_CASE( nucleotide_kernels_complement )
+{
+  check_against_scalar([](const string& sequence) {
+    auto out = string(sequence.size(), ' ');
+    complement_bases(sequence.data(), &out[0], sequence.size());
+    auto in_place = sequence;
+    complement_bases(in_place.data(), &in_place[0], in_place.size());
+    BOOST_CHECK_EQUAL(in_place, out);
+    return out;
+  });
+}
+
+BOOST_AUTO_TEST_CASE( nucleotide_kernels_reverse_complement )
+{
+  check_against_scalar([](const string& sequence) {
+    auto out = string(sequence.size(), ' ');
+    reverse_complement_bases(sequence.data(), &out[0], sequence.size());
+    auto in_place = sequence;
+    reverse_complement_bases(&in_place[0], in_place.size());
+    BOOST_CHECK_EQUAL(in_place, out);
+    auto manual = string(sequence.size(), ' ');
+    complement_bases(sequence.data(), &manual[0], sequence.size());
+    reverse(manual.begin(), manual.end());
+    BOOST_CHECK_EQUAL(manual, out);
+    return out;
+  });
+}
+
+BOOST_AUTO_TEST_CASE( nucleotide_kernels_4bit_packing )
+{
+  check_against_scalar([](const string& sequence) {
+    auto packed = vector<uint8_t>((sequence.size() + 1) / 2);
+    pack_bases_4bit(sequence.data(), sequence.size(), packed.data());
+    auto unpacked = string(sequence.size(), ' ');
+    unpack_bases_4bit(packed.data(), sequence.size(), &unpacked[0]);
+    return make_pair(packed, unpacked);
+  });
+}
+
+BOOST_AUTO_TEST_CASE( nucleotide_kernels_2bit_packing )
+{
+  check_against_scalar([](const string& sequence) {
+    auto packed = vector<uint8_t>((sequence.size() + 3) / 4);
+    pack_bases_2bit(sequence.data(), sequence.size(), packed.data());
+    auto unpacked = string(sequence.size(), ' ');
+    unpack_bases_2bit(packed.data(), sequence.size(), &unpacked[0]);
+    return make_pair(packed, unpacked);
+  });
+  const auto acgt = string{"ACGTTGCAacgtGGGGCCCCAAAATTTTACGTAC"};
+  auto packed = vector<uint8_t>((acgt.size() + 3) / 4);
+  pack_bases_2bit(acgt.data(), acgt.size(), packed.data());
+  auto unpacked = string(acgt.size(), ' ');
+  unpack_bases_2bit(packed.data(), acgt.size(), &unpacked[0]);
+  BOOST_CHECK_EQUAL(unpacked, "ACGTTGCAACGTGGGGCCCCAAAATTTTACGTAC");
+}
+
+BOOST_AUTO_TEST_CASE( nucleotide_kernels_case_folding_and_n_counting )
+{
+  check_against_scalar([](const string& sequence) {
+    auto upper = sequence;
+    to_upper_bases(&upper[0], upper.size());
+    auto lower = sequence;
+    to_lower_bases(&lower[0], lower.size());
+    return make_tuple(upper, lower, count_n_bases(sequence.data(), sequence.size()));
+  });
+}
@@ -45,6 +45,88 @@ BOOST_AUTO_TEST_CASE( split_reference_blocks )
   BOOST_CHECK_EQUAL(truth_index, truth_contigs.size());
 }
 
+// the checks of split_reference_blocks, for readers set up in other ways
+void check_split_reference_blocks(const GVCFReader& reader) {
+  auto truth_index = 0u;
+  for (const auto& vec : reader) {
+    auto expected_file_indices = truth_file_indices_split[truth_index];
+    for (const auto& pair : vec) {
+      const auto& record = pair.first;
+      BOOST_CHECK_EQUAL(record.chromosome(), truth_contigs[truth_index]);
+      BOOST_CHECK_EQUAL(record.alignment_start(), truth_block_starts[truth_index]);
+      BOOST_CHECK_EQUAL(record.alignment_stop(), truth_block_stops[truth_index]);
+      BOOST_CHECK_EQUAL(record.ref(), truth_refs[truth_index]);
+
+      auto find_result = expected_file_indices.find(pair.second);
+      BOOST_CHECK(find_result != expected_file_indices.end());
+      expected_file_indices.erase(find_result);
+    }
+    BOOST_CHECK(expected_file_indices.empty());   // check that we've seen and erased all expected
+    ++truth_index;
+  }
+  BOOST_CHECK_EQUAL(truth_index, truth_contigs.size());
+}
+
+BOOST_AUTO_TEST_CASE( split_reference_blocks_decoder_threads )
+{
+  for (const auto decoder_threads : {2u, 5u}) {
+    auto reader = GVCFReader{test_files, false};
+    reader.set_decoder_threads(decoder_threads);
+    check_split_reference_blocks(reader);
+  }
+}
+
+BOOST_AUTO_TEST_CASE( split_reference_blocks_hierarchical_merge )
+{
+  // hierarchical merges of the 5 files: into 3 then 2 temporary files, or into 2
+  for (const auto max_open_files : {2u, 3u})
+    check_split_reference_blocks(GVCFReader{test_files, false, max_open_files});
+}
+
+BOOST_AUTO_TEST_CASE( split_reference_blocks_kept_copies )
+{
+  // split halves share their record with the pending half until the iterator advances: copies must not see the later splits
+  auto kept = vector<Variant>{};
+  for (const auto& vec : GVCFReader{test_files, false}) {
+    for (const auto& pair : vec)
+      kept.push_back(pair.first);
+  }
+  auto kept_index = 0u;
+  for (auto truth_index = 0u; truth_index != truth_contigs.size(); ++truth_index) {
+    for (auto i = 0u; i != truth_file_indices_split[truth_index].size(); ++i, ++kept_index) {
+      BOOST_REQUIRE(kept_index < kept.size());
+      BOOST_CHECK_EQUAL(kept[kept_index].alignment_start(), truth_block_starts[truth_index]);
+      BOOST_CHECK_EQUAL(kept[kept_index].alignment_stop(), truth_block_stops[truth_index]);
+      BOOST_CHECK_EQUAL(kept[kept_index].ref(), truth_refs[truth_index]);
+    }
+  }
+  BOOST_CHECK_EQUAL(kept_index, kept.size());
+}
+
+BOOST_AUTO_TEST_CASE( split_reference_blocks_kept_moved_records )
+{
+  // split halves moved out of their vector share their record with the pending half: later splits must not change them
+  for (const auto decoder_threads : {0u, 2u}) {
+    auto kept = vector<Variant>{};
+    auto reader = GVCFReader{test_files, false};
+    reader.set_decoder_threads(decoder_threads);
+    for (auto& vec : reader) {
+      for (auto& pair : vec)
+        kept.push_back(move(pair.first));
+    }
+    auto kept_index = 0u;
+    for (auto truth_index = 0u; truth_index != truth_contigs.size(); ++truth_index) {
+      for (auto i = 0u; i != truth_file_indices_split[truth_index].size(); ++i, ++kept_index) {
+        BOOST_REQUIRE(kept_index < kept.size());
+        BOOST_CHECK_EQUAL(kept[kept_index].alignment_start(), truth_block_starts[truth_index]);
+        BOOST_CHECK_EQUAL(kept[kept_index].alignment_stop(), truth_block_stops[truth_index]);
+        BOOST_CHECK_EQUAL(kept[kept_index].ref(), truth_refs[truth_index]);
+      }
+    }
+    BOOST_CHECK_EQUAL(kept_index, kept.size());
+  }
+}
+
 template<bool v1, bool v2>
 void test_lut_base()
 {
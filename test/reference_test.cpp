@@ -1,13 +1,18 @@
 #include "reference_map.h"
+#include "indexed_reference_map.h"
+#include "packed_reference.h"
 #include "reference_iterator.h"
 
 #include "utils/utils.h"
+#include "exceptions.h"
 
 #include <boost/test/unit_test.hpp>
 
 #include <vector>
 #include <string>
 #include <unordered_map>
+#include <fstream>
+#include <cstdio>
 
 using namespace std;
 using namespace gamgee;
@@ -89,3 +94,167 @@ BOOST_AUTO_TEST_CASE( reference_iterator_test ) {
   }
 }
 
+
+BOOST_AUTO_TEST_CASE( reference_iterator_random_access_test ) {
+  // indexed reference with tiny windows: out of order chromosomes and locations
+  for (const auto window_size : {1u, 5u, 16u, 1000u}) {
+    auto reference = ReferenceIterator{FILE1, window_size};
+    for (auto i = CHROMOSOMES1.size(); i-- != 0; ) {
+      for (auto counter = int(SEQ1.size()); counter >= 1; counter -= 3)
+        BOOST_CHECK_EQUAL(reference.ref_base(CHROMOSOMES1[i], counter), SEQ1[counter - 1]);
+      BOOST_CHECK_EQUAL(reference.ref_base(CHROMOSOMES1[(i * 7) % CHROMOSOMES1.size()], 2), SEQ1[1]);
+    }
+    BOOST_CHECK_THROW(reference.ref_base("chrP", 1), ChromosomeNotFoundException);
+    BOOST_CHECK_THROW(reference.ref_base("chrA", SEQ1.size() + 1), ChromosomeSizeException);
+    BOOST_CHECK_THROW(reference.ref_base("chrA", 0), ChromosomeSizeException);
+  }
+
+  // reference that can't be indexed (irregular line lengths) falls back to streaming
+  auto reference2 = ReferenceIterator{FILE2};
+  BOOST_CHECK_EQUAL(reference2.ref_base("chr2", 1), CHR2_SEQ[0]);
+  BOOST_CHECK_EQUAL(reference2.ref_base("chr1", 3), CHR1_SEQ[2]);
+  BOOST_CHECK_EQUAL(reference2.ref_base("chr2", CHR2_SEQ.size()), CHR2_SEQ.back());
+  BOOST_CHECK_THROW(reference2.ref_base("chrP", 1), ChromosomeNotFoundException);
+  BOOST_CHECK_EQUAL(reference2.ref_base("chr1", 1), CHR1_SEQ[0]);
+  BOOST_CHECK_THROW(reference2.ref_base("chr1", CHR1_SEQ.size() + 1), ChromosomeSizeException);
+}
+
+BOOST_AUTO_TEST_CASE( indexed_reference_map_get_sequence_test )
+{
+  // tiny windows and cache so that every request crosses windows and evicts old ones
+  for (const auto window_size : {1u, 4u, 7u, 43u, 100u}) {
+    const auto reference = IndexedReferenceMap{FILE1, window_size, 3};
+    BOOST_CHECK(reference.contigs() == CHROMOSOMES1);
+    BOOST_CHECK_EQUAL(reference.n_contigs(), CHROMOSOMES1.size());
+    for (const auto& chr : CHROMOSOMES1) {
+      BOOST_CHECK_EQUAL(reference.contig_length(chr), SEQ1.length());
+      for (auto start = 1u; start != SEQ1.length(); ++start) {
+        for (auto len = 1u; len <= SEQ1.length() - start; ++len) {
+          const auto interval = Interval{chr, start, start+len-1};
+          BOOST_CHECK_EQUAL(reference.get_sequence(interval), SEQ1.substr(start-1, len));
+          BOOST_CHECK_EQUAL(reference.get_sequence(interval, true), gamgee::utils::complement(SEQ1.substr(start-1, len)));
+        }
+        BOOST_CHECK_EQUAL(reference.ref_base(chr, start), SEQ1[start-1]);
+      }
+      BOOST_CHECK_LE(reference.n_cached_windows(), 3u);
+    }
+    BOOST_CHECK_EQUAL(reference.get_sequence(Interval{"chrB", 40, 100}), SEQ1.substr(39)); // truncated at the end of the contig
+  }
+}
+
+BOOST_AUTO_TEST_CASE( indexed_reference_map_errors_test )
+{
+  const auto reference = IndexedReferenceMap{FILE1};
+  BOOST_CHECK(reference.has_contig("chrA"));
+  BOOST_CHECK(!reference.has_contig("chrP"));
+  BOOST_CHECK_THROW(reference.get_sequence(Interval{"chrP", 1, 10}), ChromosomeNotFoundException);
+  BOOST_CHECK_THROW(reference.ref_base("chrA", SEQ1.length() + 1), ChromosomeSizeException);
+  BOOST_CHECK_THROW(reference.get_sequence(Interval{"chrA", uint32_t(SEQ1.length() + 2), uint32_t(SEQ1.length() + 3)}), ChromosomeSizeException);
+  BOOST_CHECK_THROW(IndexedReferenceMap{"testdata/does_not_exist.fa"}, IndexLoadException);
+}
+
+BOOST_AUTO_TEST_CASE( indexed_reference_map_builds_missing_index_test )
+{
+  const auto copy = string{"testdata/indexed_reference_map_test.fa"};
+  {
+    ifstream source {FILE1, ios::binary};
+    ofstream destination {copy, ios::binary};
+    destination << source.rdbuf();
+  }
+  remove((copy + ".fai").c_str());
+  {
+    const auto reference = IndexedReferenceMap{copy};
+    BOOST_CHECK(ifstream{copy + ".fai"}.good());
+    BOOST_CHECK(reference.contigs() == CHROMOSOMES1);
+    BOOST_CHECK_EQUAL(reference.get_sequence(Interval{"chrU", 1, uint32_t(SEQ1.length())}), SEQ1);
+  }
+  remove((copy + ".fai").c_str());
+  remove(copy.c_str());
+}
+
+BOOST_AUTO_TEST_CASE( indexed_reference_map_truncated_file_test )
+{
+  // the index lists every contig, but the file ends within chrB: reading past that point is a read error, not a missing contig
+  const auto copy = string{"testdata/indexed_reference_map_truncated.fa"};
+  {
+    ifstream source {FILE1, ios::binary};
+    ofstream destination {copy, ios::binary};
+    destination << source.rdbuf();
+  }
+  remove((copy + ".fai").c_str());
+  IndexedReferenceMap{copy};  // builds the index of the whole file
+  {
+    ifstream source {FILE1, ios::binary};
+    ofstream destination {copy, ios::binary | ios::trunc};
+    auto head = string(100, '\0');
+    source.read(&head[0], head.size());
+    destination.write(head.data(), head.size());
+  }
+  {
+    const auto reference = IndexedReferenceMap{copy};
+    BOOST_CHECK(reference.has_contig("chrU"));
+    BOOST_CHECK_EQUAL(reference.get_sequence(Interval{"chrA", 1, uint32_t(SEQ1.length())}), SEQ1);
+    BOOST_CHECK_THROW(reference.get_sequence(Interval{"chrU", 1, 10}), FileReadException);
+    BOOST_CHECK_THROW(reference.ref_base("chrB", 43), FileReadException);
+    BOOST_CHECK_THROW(reference.get_sequence(Interval{"chrP", 1, 10}), ChromosomeNotFoundException);
+  }
+  {
+    auto reference = ReferenceIterator{copy};
+    BOOST_CHECK_EQUAL(reference.ref_base("chrA", 1), SEQ1[0]);
+    BOOST_CHECK_THROW(reference.ref_base("chrU", 1), FileReadException);
+    BOOST_CHECK_THROW(reference.ref_base("chrP", 1), ChromosomeNotFoundException);
+  }
+  remove((copy + ".fai").c_str());
+  remove(copy.c_str());
+}
+
+BOOST_AUTO_TEST_CASE( packed_reference_matches_reference_map_test )
+{
+  const auto packed_file = string{"testdata/packed_reference_test.gpr"};
+  for (const auto& fasta : {FILE1, FILE2}) {
+    PackedReference::build(fasta, packed_file);
+    const auto reference = PackedReference{packed_file};
+    const auto truth = ReferenceMap{fasta};
+    BOOST_CHECK_EQUAL(reference.n_contigs(), truth.size());
+    for (const auto& chr : reference.contigs()) {
+      const auto& sequence = truth.at(chr);
+      BOOST_CHECK_EQUAL(reference.contig_length(chr), sequence.length());
+      for (auto start = 1u; start <= sequence.length(); ++start) {
+        for (auto len = 1u; len <= sequence.length() - start + 1; ++len) {
+          const auto interval = Interval{chr, start, start+len-1};
+          BOOST_CHECK_EQUAL(reference.get_sequence(interval), truth.get_sequence(interval));
+          BOOST_CHECK_EQUAL(reference.get_sequence(interval, true), truth.get_sequence(interval, true));
+        }
+        BOOST_CHECK_EQUAL(reference.ref_base(chr, start), sequence[start-1]);
+      }
+    }
+  }
+  remove(packed_file.c_str());
+}
+
+BOOST_AUTO_TEST_CASE( packed_reference_round_trip_test )
+{
+  const auto fasta = string{"testdata/packed_reference_test.fa"};
+  const auto packed_file = string{"testdata/packed_reference_test.gpr"};
+  const auto soft_masked = string{"acgtNNNNnnnnACGTRYKMacgtacgtSWBDHVACGTTGCAnNaCGTaaaaCCCCGGGGTTTTn"};
+  {
+    ofstream out {fasta};
+    out << ">masked\n" << soft_masked << "\n>single\nc\n";
+  }
+  PackedReference::build(fasta, packed_file);
+  const auto reference = PackedReference{packed_file};
+  BOOST_CHECK((reference.contigs() == vector<string>{"masked", "single"}));
+  BOOST_CHECK_EQUAL(reference.ref_base("single", 1), 'c');
+  BOOST_CHECK_EQUAL(reference.ref_base("single", 1, true), 'g');
+  for (auto start = 1u; start <= soft_masked.length(); ++start)
+    for (auto len = 1u; len <= soft_masked.length() - start + 1; ++len)
+      BOOST_CHECK_EQUAL(reference.get_sequence(Interval{"masked", start, start+len-1}), soft_masked.substr(start-1, len));
+  const auto copy = reference;  // copies share the mapping
+  BOOST_CHECK_EQUAL(copy.get_sequence(Interval{"masked", 1, uint32_t(soft_masked.length())}), soft_masked);
+  BOOST_CHECK_THROW(reference.get_sequence(Interval{"chrP", 1, 10}), ChromosomeNotFoundException);
+  BOOST_CHECK_THROW(reference.ref_base("single", 2), ChromosomeSizeException);
+  BOOST_CHECK_THROW(PackedReference{fasta}, HeaderReadException);  // not a packed reference
+  BOOST_CHECK_THROW(PackedReference{"testdata/does_not_exist.gpr"}, FileOpenException);
+  remove(packed_file.c_str());
+  remove(fasta.c_str());
+}
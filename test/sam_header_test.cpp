@@ -1,6 +1,7 @@
 #include <boost/test/unit_test.hpp>
 
 #include "sam/sam_reader.h"
+#include "missing.h"
 #include "test_utils.h"
 
 using namespace std;
@@ -14,6 +15,10 @@ BOOST_AUTO_TEST_CASE( sam_header ) {
   BOOST_CHECK_EQUAL(100000u, header.sequence_length(0));
   BOOST_CHECK_EQUAL(0u, header.sequence_length("foo"));
   BOOST_CHECK_EQUAL(1u, header.n_sequences());
+  BOOST_CHECK_EQUAL(0, header.sequence_index("chr1"));
+  BOOST_CHECK(missing(header.sequence_index("foo")));
+  const auto copy = header;  // shares the lookup table built above
+  BOOST_CHECK_EQUAL(100000u, copy.sequence_length("chr1"));
 }
 
 BOOST_AUTO_TEST_CASE( sam_header_read_groups ) {
@@ -104,6 +104,47 @@ BOOST_AUTO_TEST_CASE( synced_variant_reader_sparse_test ) {
   BOOST_CHECK_EQUAL(pos_truth_index, 6u);
 }
 
+BOOST_AUTO_TEST_CASE( synced_variant_reader_kept_records_test ) {
+  // records moved out of the vectors keep their buffer: the iterator must copy the next lines elsewhere
+  auto kept = vector<Variant>{};
+  for (auto& vec : SyncedVariantReader<SyncedVariantIterator>{synced_variant_sparse_inputs, synced_variant_chrom_full}) {
+    for (auto& record : vec) {
+      if (!missing(record))
+        kept.push_back(move(record));
+    }
+  }
+  auto kept_index = 0u;
+  for (auto pos_truth_index = 0u; pos_truth_index != synced_variant_sparse_truth_start.size(); ++pos_truth_index) {
+    for (const auto present : synced_variant_sparse_truth_present[pos_truth_index]) {
+      if (!present)
+        continue;
+      BOOST_REQUIRE(kept_index < kept.size());
+      BOOST_CHECK_EQUAL(kept[kept_index].chromosome_name(), synced_variant_sparse_truth_chrom[pos_truth_index]);
+      BOOST_CHECK_EQUAL(kept[kept_index].alignment_start(), synced_variant_sparse_truth_start[pos_truth_index]);
+      ++kept_index;
+    }
+  }
+  BOOST_CHECK_EQUAL(kept_index, kept.size());
+}
+
+BOOST_AUTO_TEST_CASE( synced_variant_reader_shared_header_tables_test ) {
+  // the headers of the records alias the synced readers, and still share one set of name tables per file
+  for (const auto input_files : {synced_variant_vcf_inputs, synced_variant_bcf_inputs}) {
+    auto samples = vector<const vector<string>*>{};
+    for (const auto& vec : SyncedVariantReader<SyncedVariantIterator>{input_files, synced_variant_chrom_full}) {
+      BOOST_REQUIRE_EQUAL(vec.size(), input_files.size());
+      for (auto i = 0u; i != vec.size(); ++i) {
+        const auto* tables = &vec[i].header().samples();
+        if (samples.size() == i)
+          samples.push_back(tables);
+        BOOST_CHECK_EQUAL(tables, samples[i]);
+        BOOST_CHECK_EQUAL(tables->size(), 3u);
+      }
+    }
+    BOOST_CHECK_EQUAL(samples.size(), input_files.size());
+  }
+}
+
 BOOST_AUTO_TEST_CASE( synced_variant_reader_move_test ) {
   for (const auto input_files : {synced_variant_vcf_inputs, synced_variant_bcf_inputs}) {
     auto reader0 = SyncedVariantReader<SyncedVariantIterator>{input_files, synced_variant_chrom_full};
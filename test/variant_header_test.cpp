@@ -1,5 +1,6 @@
 #include "test_utils.h"
 #include "variant/variant_header_builder.h"
+#include "variant/variant_reader.h"
 #include "missing.h"
 
 #include <set>
@@ -176,6 +177,69 @@ BOOST_AUTO_TEST_CASE( variant_header_builder_move ) {
   variant_header_builder_checks(builder2.build());
 }
 
+BOOST_AUTO_TEST_CASE( variant_header_copies_and_clones ) {
+  auto header = simple_builder().build();
+  const auto copies = check_copy_constructor(header);
+  variant_header_builder_checks(get<2>(copies));
+  const auto clone = header.clone();
+  BOOST_CHECK(clone == header);
+
+  // copies share the htslib header, so modified headers are derived from a clone by the builder
+  const auto modified = VariantHeaderBuilder{get<1>(copies)}.add_filter("BLAH", "anything", "deer=vanison").build();
+  BOOST_CHECK(modified.has_filter("BLAH"));
+  BOOST_CHECK(!header.has_filter("BLAH"));
+  BOOST_CHECK(!get<1>(copies).has_filter("BLAH"));
+
+  // the name tables are built once and shared by every VariantHeader on the htslib header
+  const auto& chromosomes = header.chromosomes();
+  const auto copy = header;
+  BOOST_CHECK_EQUAL(&copy.chromosomes(), &chromosomes);
+  BOOST_CHECK_EQUAL(&get<1>(copies).samples(), &header.samples());
+  BOOST_CHECK_EQUAL(copy.n_chromosomes(), chromosomes.size());
+  for (auto i = 0u; i != chromosomes.size(); ++i) {
+    BOOST_CHECK_EQUAL(copy.get_chromosome_name(i), chromosomes[i]);
+    BOOST_CHECK_EQUAL(copy.get_chromosome_name_c_str(i), chromosomes[i]);
+  }
+  BOOST_CHECK_EQUAL(copy.get_chromosome_name(chromosomes.size()), "");
+  BOOST_CHECK_EQUAL(copy.get_chromosome_name_c_str(-1), "");
+}
+
+BOOST_AUTO_TEST_CASE( variant_header_tables_follow_added_lines ) {
+  // htslib declares the undeclared contigs and fields it meets while parsing VCF text in the reader's header
+  auto reader = SingleVariantReader{"testdata/undeclared_fields.vcf"};
+  const auto header = reader.header();
+  for (const auto& sample : reader.header().samples())  // a temporary header: the vector is kept with the htslib header
+    BOOST_CHECK(header.has_sample(sample));
+  const auto& declared_chromosomes = header.chromosomes();
+  BOOST_CHECK((declared_chromosomes == vector<string>{"20"}));
+  BOOST_CHECK_EQUAL(header.n_shared_fields(), 1u);
+  auto names = vector<string>{};
+  for (const auto& record : reader) {
+    names.push_back(record.chromosome_name_c_str());
+    BOOST_CHECK_EQUAL(&record.header().samples(), &header.samples());  // the records' headers share the tables
+  }
+  BOOST_CHECK((names == vector<string>{"20", "20", "21"}));
+  BOOST_CHECK((header.chromosomes() == vector<string>{"20", "21"}));
+  BOOST_CHECK((declared_chromosomes == vector<string>{"20"}));  // the tables built before the new lines are still valid
+  BOOST_CHECK_EQUAL(header.n_chromosomes(), 2u);
+  BOOST_CHECK_EQUAL(header.n_shared_fields(), 2u);
+}
+
+BOOST_AUTO_TEST_CASE( variant_header_copies_follow_the_reader ) {
+  // a copy of the reader's header shares it and sees the lines htslib adds while reading, a clone doesn't
+  auto reader = SingleVariantReader{"testdata/undeclared_fields.vcf"};
+  const auto copy = reader.header();
+  const auto snapshot = reader.header().clone();
+  for (const auto& record : reader)
+    (void) record;
+  BOOST_CHECK((copy.chromosomes() == vector<string>{"20", "21"}));
+  BOOST_CHECK(copy.has_shared_field("UNDECLARED_INFO"));
+  BOOST_CHECK(copy == reader.header());
+  BOOST_CHECK((snapshot.chromosomes() == vector<string>{"20"}));
+  BOOST_CHECK(!snapshot.has_shared_field("UNDECLARED_INFO"));
+  BOOST_CHECK(snapshot != reader.header());
+}
+
 BOOST_AUTO_TEST_CASE( variant_header_builder_chained ) {
   auto builder = VariantHeaderBuilder{};
   builder
@@ -922,8 +922,28 @@ void single_variant_reader_sample_test(const string filename, const vector<strin
 BOOST_AUTO_TEST_CASE( single_variant_reader_sites_only )  
 {
   single_variant_reader_sample_test("testdata/test_variants.vcf", vector<string>{}, true, 0); // exclude all samples (sites-only)
-  // Fails: Issue #209
-  //single_variant_reader_sample_test("testdata/test_variants.bcf", vector<string>{}, true, 0); // exclude all samples (sites-only)
+  single_variant_reader_sample_test("testdata/test_variants.bcf", vector<string>{}, true, 0); // exclude all samples (sites-only)
+}
+
+BOOST_AUTO_TEST_CASE( single_variant_reader_sites_only_unpack_level )
+{
+  for (const auto& filename : vector<string>{"testdata/test_variants.vcf", "testdata/test_variants.bcf", "testdata/var_idx/test_variants_csi.vcf.gz"}) {
+    auto all = vector<pair<uint32_t, string>>{};
+    for (const auto& record : SingleVariantReader{filename, VariantUnpackLevel::ALL}) {
+      BOOST_CHECK_EQUAL(record.n_samples(), 3u);
+      all.emplace_back(record.alignment_start(), record.ref());
+    }
+    auto sites = vector<pair<uint32_t, string>>{};
+    auto reader = SingleVariantReader{filename, VariantUnpackLevel::SITES_ONLY};
+    BOOST_CHECK_EQUAL(reader.header().n_samples(), 0u);
+    for (const auto& record : reader) {
+      BOOST_CHECK_EQUAL(record.n_samples(), 0u);
+      BOOST_CHECK(record.genotypes().empty());
+      BOOST_CHECK_EQUAL(record.n_alleles(), record.alt().size() + 1);
+      sites.emplace_back(record.alignment_start(), record.ref());
+    }
+    BOOST_CHECK(sites == all);
+  }
 }
 
 BOOST_AUTO_TEST_CASE( single_variant_reader_include_all_samples ) 
@@ -986,6 +1006,51 @@ BOOST_AUTO_TEST_CASE( single_variant_reader_missing_data )
   }
 }
 
+BOOST_AUTO_TEST_CASE( single_variant_reader_individual_field_projection )
+{
+  for (const auto& filename : vector<string>{"testdata/test_variants.vcf", "testdata/test_variants.bcf"}) {
+    auto gqs = vector<vector<int32_t>>{};
+    auto sizes = vector<size_t>{};
+    for (const auto& record : SingleVariantReader{filename}) {
+      auto gq = vector<int32_t>{};
+      for (const auto& value : record.integer_individual_field("GQ"))
+        gq.push_back(value[0]);
+      gqs.push_back(gq);
+      sizes.push_back(record.integer_individual_field("PL").size());
+    }
+    auto projected_gqs = vector<vector<int32_t>>{};
+    for (const auto& record : SingleVariantReader{filename, {}, false, {"GT", "GQ"}}) {
+      BOOST_CHECK_EQUAL(record.n_samples(), 3u);
+      BOOST_CHECK_EQUAL(record.genotypes().size(), 3u);
+      BOOST_CHECK(record.integer_individual_field("PL").empty());      // dropped
+      BOOST_CHECK(record.string_individual_field("AS").empty());
+      auto gq = vector<int32_t>{};
+      for (const auto& value : record.integer_individual_field("GQ"))
+        gq.push_back(value[0]);
+      projected_gqs.push_back(gq);
+    }
+    BOOST_CHECK(projected_gqs == gqs);
+    BOOST_CHECK_EQUAL(sizes.front(), 3u);
+
+    // projection and sample subsetting together
+    for (const auto& record : SingleVariantReader{filename, {"NA12878"}, true, {"GQ"}}) {
+      BOOST_CHECK_EQUAL(record.n_samples(), 1u);
+      BOOST_CHECK(record.genotypes().empty());
+      BOOST_CHECK_EQUAL(record.integer_individual_field("GQ").size(), 1u);
+    }
+  }
+  BOOST_CHECK_THROW((SingleVariantReader{"testdata/test_variants.vcf", {}, false, {"GT", "FOO"}}), HeaderFieldNotFoundException);
+  BOOST_CHECK_THROW((SingleVariantReader{"testdata/test_variants.vcf", {}, false, {"AN"}}), HeaderFieldNotFoundException);  // a shared field
+
+  auto n_records = 0u;
+  for (const auto& record : IndexedVariantReader<IndexedVariantIterator>{"testdata/var_idx/test_variants.bcf", vector<string>{"20"}, VariantDecodingOptions{VariantUnpackLevel::ALL, {"PL"}}}) {
+    BOOST_CHECK(record.genotypes().empty());
+    BOOST_CHECK_EQUAL(record.integer_individual_field("PL").size(), 3u);
+    ++n_records;
+  }
+  BOOST_CHECK_EQUAL(n_records, 3u);
+}
+
 BOOST_AUTO_TEST_CASE( single_variant_reader_vector )
 {
   for (const auto& record : SingleVariantReader{vector<string>{"testdata/test_variants.vcf"}})
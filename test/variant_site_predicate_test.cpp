@@ -0,0 +1,112 @@
+#include "variant/variant_reader.h"
+#include "variant/indexed_variant_reader.h"
+#include "variant/variant_site_predicate.h"
+#include "exceptions.h"
+
+#include <boost/test/unit_test.hpp>
+
+#include <functional>
+#include <stdexcept>
+
+using namespace std;
+using namespace gamgee;
+
+const auto site_predicate_inputs = vector<string>{"testdata/test_variants.vcf", "testdata/test_variants.bcf", "testdata/var_idx/test_variants_csi.vcf.gz"};
+
+// positions of the records of each test file passing the predicate built by add_conditions
+vector<uint32_t> passing_positions(const string& filename, const function<void(VariantSitePredicate&)>& add_conditions) {
+  auto reader = SingleVariantReader{filename};
+  auto predicate = VariantSitePredicate{reader.header()};
+  add_conditions(predicate);
+  auto positions = vector<uint32_t>{};
+  for (const auto& record : reader.filter_sites(predicate)) {
+    BOOST_CHECK_EQUAL(record.n_samples(), 3u);       // passing records are fully decoded
+    BOOST_CHECK_EQUAL(record.genotypes().size(), 3u);
+    positions.push_back(record.alignment_start());
+  }
+  return positions;
+}
+
+void check_passing(const function<void(VariantSitePredicate&)>& add_conditions, const vector<uint32_t>& expected) {
+  for (const auto& filename : site_predicate_inputs)
+    BOOST_CHECK(passing_positions(filename, add_conditions) == expected);
+}
+
+BOOST_AUTO_TEST_CASE( variant_site_predicate_location )
+{
+  check_passing([](VariantSitePredicate&){}, {10000000, 10001000, 10002000, 10003000, 10004000, 10005000, 10006000});
+  check_passing([](VariantSitePredicate& p){ p.in_chromosomes({"20", "foo"}); }, {10001000, 10002000, 10003000});
+  check_passing([](VariantSitePredicate& p){ p.in_chromosomes({"foo"}); }, {});
+  // the deletion at 20:10002000 spans 10002000-10002006 and the one at 22:10004000 spans 10004000-10004002
+  check_passing([](VariantSitePredicate& p){ p.in_intervals({Interval{"22", 10004002, 10004002}, Interval{"20", 10001500, 10002000}, Interval{"20", 10001900, 10001999}}); }, {10002000, 10004000});
+}
+
+BOOST_AUTO_TEST_CASE( variant_site_predicate_qual_and_filters )
+{
+  check_passing([](VariantSitePredicate& p){ p.min_qual(10); }, {10000000});
+  check_passing([](VariantSitePredicate& p){ p.passing_filters(); }, {10000000, 10001000, 10005000, 10006000});
+  check_passing([](VariantSitePredicate& p){ p.excluding_filters({"LOW_QUAL", "MISSED"}); }, {10000000, 10001000, 10003000, 10005000, 10006000});
+}
+
+BOOST_AUTO_TEST_CASE( variant_site_predicate_alleles )
+{
+  check_passing([](VariantSitePredicate& p){ p.n_alleles_between(3, 3); }, {10004000, 10005000, 10006000});
+  check_passing([](VariantSitePredicate& p){ p.n_alleles_between(1, 2); }, {10000000, 10001000, 10002000, 10003000});
+  check_passing([](VariantSitePredicate& p){ p.with_allele_types({AlleleType::SNP}); }, {10000000, 10001000});
+  check_passing([](VariantSitePredicate& p){ p.with_allele_types({AlleleType::INSERTION}); }, {10003000, 10004000, 10005000, 10006000});
+}
+
+// sites only, with symbolic, breakend and spanning deletion alleles, and records never filtered (FILTER is .)
+BOOST_AUTO_TEST_CASE( variant_site_predicate_symbolic_alleles_and_missing_filters )
+{
+  const auto positions = [](const function<void(VariantSitePredicate&)>& add_conditions) {
+    auto reader = SingleVariantReader{"testdata/site_predicate_alleles.vcf"};
+    auto predicate = VariantSitePredicate{reader.header()};
+    add_conditions(predicate);
+    auto result = vector<uint32_t>{};
+    for (const auto& record : reader.filter_sites(predicate))
+      result.push_back(record.alignment_start());
+    return result;
+  };
+  // by length <NON_REF>, <DEL> and the breakend would be insertions and * a SNP: only sequence alleles count
+  BOOST_CHECK((positions([](VariantSitePredicate& p){ p.with_allele_types({AlleleType::SNP}); }) == vector<uint32_t>{100}));
+  BOOST_CHECK((positions([](VariantSitePredicate& p){ p.with_allele_types({AlleleType::INSERTION}); }) == vector<uint32_t>{400}));
+  BOOST_CHECK(positions([](VariantSitePredicate& p){ p.with_allele_types({AlleleType::DELETION}); }).empty());
+  BOOST_CHECK(positions([](VariantSitePredicate& p){ p.in_intervals({Interval{"1", 200, 300}, Interval{"1", 500, 600}}).with_allele_types({AlleleType::SNP, AlleleType::INSERTION, AlleleType::DELETION}); }).empty());
+  // a missing FILTER passes unless asked otherwise
+  BOOST_CHECK((positions([](VariantSitePredicate& p){ p.passing_filters(); }) == vector<uint32_t>{100, 200, 300, 500, 600}));
+  BOOST_CHECK((positions([](VariantSitePredicate& p){ p.passing_filters(false); }) == vector<uint32_t>{100, 300, 600}));
+}
+
+BOOST_AUTO_TEST_CASE( variant_site_predicate_shared_fields )
+{
+  check_passing([](VariantSitePredicate& p){ p.with_shared_field("VALIDATED"); }, {10000000, 10002000});
+  check_passing([](VariantSitePredicate& p){ p.shared_field_at_least("VLINT", 20); }, {10006000});
+  check_passing([](VariantSitePredicate& p){ p.shared_field_at_most("VLFLOAT", 5); }, {});
+  check_passing([](VariantSitePredicate& p){ p.shared_field_at_least("AN", 6).shared_field_at_most("AF", 0.5); }, {10000000, 10001000, 10002000, 10003000, 10004000, 10005000, 10006000});
+  check_passing([](VariantSitePredicate& p){ p.in_chromosomes({"22"}).passing_filters().with_shared_field("VLINT"); }, {10006000});
+}
+
+BOOST_AUTO_TEST_CASE( variant_site_predicate_unknown_fields )
+{
+  auto predicate = VariantSitePredicate{SingleVariantReader{"testdata/test_variants.vcf"}.header()};
+  BOOST_CHECK(predicate.accepts_all());
+  BOOST_CHECK_THROW(predicate.excluding_filters({"FOO"}), HeaderFieldNotFoundException);
+  BOOST_CHECK_THROW(predicate.with_shared_field("GQ"), HeaderFieldNotFoundException);  // an individual field
+  BOOST_CHECK_THROW(predicate.shared_field_at_least("DESC", 1), invalid_argument);
+  BOOST_CHECK_THROW(predicate.shared_field_at_least("VALIDATED", 1), invalid_argument);
+  BOOST_CHECK(predicate.accepts_all());
+}
+
+BOOST_AUTO_TEST_CASE( variant_site_predicate_indexed )
+{
+  const auto reader = IndexedVariantReader<IndexedVariantIterator>{"testdata/var_idx/test_variants.bcf", vector<string>{"20", "22"}};
+  auto predicate = VariantSitePredicate{reader.header()};
+  predicate.passing_filters();
+  auto positions = vector<uint32_t>{};
+  for (const auto& record : reader.filter_sites(predicate)) {
+    BOOST_CHECK_EQUAL(record.n_samples(), 3u);
+    positions.push_back(record.alignment_start());
+  }
+  BOOST_CHECK((positions == vector<uint32_t>{10001000, 10005000, 10006000}));
+}
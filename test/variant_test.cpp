@@ -2,6 +2,7 @@
 #include "variant/variant_reader.h"
 #include "variant/variant.h"
 #include "variant/variant_builder.h"
+#include "variant/variant_header_builder.h"
 #include "missing.h"
 #include "utils/variant_utils.h"
 
@@ -128,3 +129,55 @@ BOOST_AUTO_TEST_CASE( test_field_lengths ) {
   BOOST_CHECK_EQUAL(header.field_length("VLINT", BCF_HL_FMT), 0xfffffu);
 }
 
+
+BOOST_AUTO_TEST_CASE( field_handles ) {
+  const auto reader = SingleVariantReader{"testdata/test_variants.vcf"};
+  const auto header = reader.header();
+  const auto an = header.shared_field_handle<int32_t>("AN");
+  const auto af = header.shared_field_handle<float>("AF");
+  const auto desc = header.shared_field_handle<string>("DESC");
+  const auto gq = header.individual_field_handle<int32_t>("GQ");
+  const auto format_af = header.individual_field_handle<float>("AF");
+  const auto as = header.individual_field_handle<string>("AS");
+  const auto absent = header.shared_field_handle<int32_t>("NON_EXISTING");
+  BOOST_CHECK(!gq.missing());
+  BOOST_CHECK_EQUAL(gq.index(), header.field_index("GQ"));
+  BOOST_CHECK(absent.missing());
+  BOOST_CHECK_THROW(header.shared_field_handle<float>("AN"), std::runtime_error);
+  BOOST_CHECK_THROW(header.individual_field_handle<int32_t>("AS"), std::runtime_error);
+
+  const auto check_handles = [&](const Variant& record) {
+    BOOST_CHECK(record.shared_field(an) == record.integer_shared_field("AN"));
+    BOOST_CHECK(record.shared_field(af) == record.float_shared_field("AF"));
+    BOOST_CHECK(record.shared_field(desc) == record.string_shared_field("DESC"));
+    BOOST_CHECK(record.individual_field(gq) == record.integer_individual_field("GQ"));
+    BOOST_CHECK(record.individual_field(format_af) == record.float_individual_field("AF"));
+    BOOST_CHECK(record.individual_field(as) == record.string_individual_field("AS"));
+    BOOST_CHECK(missing(record.shared_field(absent)));
+    BOOST_CHECK(missing(record.individual_field(IndividualFieldHandle<int32_t>{})));
+  };
+
+  // records of the handles' header (the handles' indices are used as is)
+  auto n_records = 0u;
+  for (const auto& record : reader) {
+    BOOST_CHECK_EQUAL(&record.header().samples(), &header.samples());  // same htslib header
+    check_handles(record);
+    ++n_records;
+  }
+  BOOST_CHECK_EQUAL(n_records, 7u);
+
+  // records read with another header, where the tags are looked up again
+  for (const auto& filename : {"testdata/test_variants.vcf", "testdata/test_variants.bcf"}) {
+    for (const auto& record : SingleVariantReader{filename}) {
+      BOOST_CHECK_NE(&record.header().samples(), &header.samples());
+      check_handles(record);
+    }
+  }
+
+  // a field the handle's header doesn't declare is still found in the header of the records
+  const auto builder_header = VariantHeaderBuilder{}.add_individual_field("DP", "1", "Integer").build();
+  const auto other_gq = builder_header.individual_field_handle<int32_t>("GQ");
+  BOOST_CHECK(other_gq.missing());
+  for (const auto& record : SingleVariantReader{"testdata/test_variants.vcf"})
+    BOOST_CHECK(record.individual_field(other_gq) == record.integer_individual_field("GQ"));
+}